@@ -7,6 +7,7 @@
 #include <boost/bind.hpp>
 #include <fc/thread/future.hpp>
 #include <fc/io/iostream.hpp>
+#include <fc/exception/exception.hpp>
 
 namespace fc { 
 /**
@@ -39,9 +40,28 @@ namespace asio {
           std::shared_ptr<const char> _buffer;
         };
 
+        class read_write_handler_with_chain
+        {
+        public:
+          read_write_handler_with_chain(const promise<size_t>::ptr& p,
+                                        const std::shared_ptr<const const_buffer_chain>& chain);
+          void operator()(const boost::system::error_code& ec, size_t bytes_transferred);
+        private:
+          promise<size_t>::ptr _completion_promise;
+          std::shared_ptr<const const_buffer_chain> _chain;
+        };
+
         void error_handler( const promise<void>::ptr& p, 
                             const boost::system::error_code& ec );
 
+        /** @return an eof_exception for eof, else an exception with the message of @p ec */
+        fc::exception_ptr error_to_exception( const boost::system::error_code& ec );
+
+        inline bool would_block( const boost::system::error_code& ec )
+        {
+          return ec == boost::asio::error::would_block || ec == boost::asio::error::try_again;
+        }
+
         template<typename C>
         struct non_blocking { 
           bool operator()( C& c ) { return c.non_blocking(); } 
@@ -97,6 +117,24 @@ namespace asio {
       return completion_promise;//->wait();
     }
 
+    /**
+     *  Reads what the stream already has, without a promise or a trip through the io service.
+     *  @pre s.non_blocking() == true
+     *  @return false if the read would block, the caller then waits for read_some()
+     *  @throw eof_exception or exception, as the future of read_some() would
+     */
+    template<typename AsyncReadStream, typename MutableBufferSequence>
+    bool try_read_some( AsyncReadStream& s, const MutableBufferSequence& buf, size_t& bytes_read )
+    {
+      boost::system::error_code ec;
+      bytes_read = s.read_some( buf, ec );
+      if( detail::would_block( ec ) )
+        return false;
+      if( ec )
+        detail::error_to_exception( ec )->dynamic_rethrow_exception();
+      return true;
+    }
+
     template<typename AsyncReadStream>
     future<size_t> read_some(AsyncReadStream& s, char* buffer, size_t length, size_t offset = 0)
     {
@@ -166,6 +204,23 @@ namespace asio {
         return p; //->wait();
     }
 
+    /**
+     *  Writes what fits in the send buffer of the stream, as try_read_some() reads.
+     *  @pre s.non_blocking() == true
+     *  @return false if the write would block, the caller then waits for write_some()
+     */
+    template<typename AsyncWriteStream, typename ConstBufferSequence>
+    bool try_write_some( AsyncWriteStream& s, const ConstBufferSequence& buf, size_t& bytes_written )
+    {
+      boost::system::error_code ec;
+      bytes_written = s.write_some( buf, ec );
+      if( detail::would_block( ec ) )
+        return false;
+      if( ec )
+        detail::error_to_exception( ec )->dynamic_rethrow_exception();
+      return true;
+    }
+
     template<typename AsyncWriteStream>
     future<size_t> write_some( AsyncWriteStream& s, const char* buffer, 
                                size_t length, size_t offset = 0) {
@@ -182,6 +237,25 @@ namespace asio {
         return p; //->wait();
     }
 
+    /**
+     *  @return the asio buffers for at most @p length bytes of @p chain, starting @p offset
+     *  bytes into it, no more than asio passes to one gather write
+     */
+    std::vector<boost::asio::const_buffer> chain_buffers( const const_buffer_chain& chain, size_t length, size_t offset );
+
+    /**
+     *  @brief wraps boost::asio::async_write_some with the slices of @p chain as one buffer sequence
+     *  @return the number of bytes written
+     */
+    template<typename AsyncWriteStream>
+    future<size_t> write_some( AsyncWriteStream& s, const const_buffer_chain& chain,
+                               size_t length, size_t offset ) {
+        promise<size_t>::ptr p(new promise<size_t>("fc::asio::write_some"));
+        s.async_write_some( chain_buffers( chain, length, offset ),
+                            detail::read_write_handler_with_chain(p, std::make_shared<const const_buffer_chain>(chain)) );
+        return p;
+    }
+
     /**
     *  @pre s.non_blocking() == true
     *  @brief wraps boost::asio::async_write_some
@@ -206,6 +280,13 @@ namespace asio {
                          detail::read_write_handler_with_buffer(completion_promise, buffer));
     }
 
+    template<typename AsyncWriteStream>
+    void async_write_some(AsyncWriteStream& s, const const_buffer_chain& chain,
+                          size_t length, size_t offset, promise<size_t>::ptr completion_promise) {
+      s.async_write_some(chain_buffers( chain, length, offset ),
+                         detail::read_write_handler_with_chain(completion_promise, std::make_shared<const const_buffer_chain>(chain)));
+    }
+
     namespace tcp {
         typedef boost::asio::ip::tcp::endpoint endpoint;
         typedef boost::asio::ip::tcp::resolver::iterator resolver_iterator;
@@ -283,6 +364,11 @@ namespace asio {
           {
              return fc::asio::write_some(*_stream, buf, len, offset).wait();
           }
+
+          virtual size_t     writesome( const const_buffer_chain& chain, size_t offset )
+          {
+             return fc::asio::write_some(*_stream, chain, total_size(chain) - offset, offset).wait();
+          }
     
           virtual void       close(){ _stream->close(); }
           virtual void       flush() {}
@@ -3,8 +3,17 @@
 #include <vector>
 
 namespace fc {
+    template<typename T, size_t N> class array;
+
     std::string to_base58( const char* d, size_t s );
     std::string to_base58( const std::vector<char>& data );
     std::vector<char> from_base58( const std::string& base58_str );
     size_t from_base58( const std::string& base58_str, char* out_data, size_t out_data_len );
+
+    /** decodes into @p out without allocating, @return the number of bytes decoded */
+    template<size_t N>
+    size_t from_base58( const std::string& base58_str, array<char,N>& out )
+    {
+       return from_base58( base58_str, out.data, N );
+    }
 }
@@ -0,0 +1,31 @@
+#pragma once
+#include <fc/string.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace fc
+{
+   /** one message for the hash_many functions, the caller keeps the data alive */
+   struct digest_input
+   {
+      digest_input() {}
+      digest_input( const char* data, uint32_t size ) : data( data ), size( size ) {}
+      digest_input( const std::string& s ) : data( s.data() ), size( s.size() ) {}
+
+      const char* data = nullptr;
+      uint32_t    size = 0;
+   };
+
+   /**
+    *  Names of the ways hash_many can run on this cpu, fastest first: "sha-ni", "avx2" and
+    *  "sse4.1" hash several messages at once, "generic" hashes them one after the other.
+    */
+   std::vector<string> digest_batch_implementations();
+
+   /**
+    *  Makes hash_many use nothing faster than the named implementation, or the fastest one
+    *  again for an empty name.  Meant for tests and benchmarks.
+    */
+   void set_digest_batch_implementation( const string& name );
+
+} // fc
@@ -7,7 +7,10 @@
 #include <fc/array.hpp>
 #include <fc/io/raw_fwd.hpp>
 
+#include <utility>
+
 namespace fc {
+  class thread_pool;
 
   namespace ecc {
     namespace detail
@@ -227,6 +230,33 @@ namespace fc {
                                           const range_proof_type& proof );
      range_proof_info range_get_info( const range_proof_type& proof );
 
+     /** a compact signature and the digest it signs */
+     typedef std::pair<compact_signature,fc::sha256> signature_and_digest;
+
+     /**
+      *  Recovers the key behind every signature as public_key( sig, digest, check_canonical )
+      *  does and returns them in order, or throws what that constructor throws for the first
+      *  signature that fails.  Keys recovered before come from a cache.  The others are
+      *  recovered by the threads of @p pool while the calling task waits, or in place when
+      *  there is no pool or only a few of them.
+      */
+     std::vector<public_key> recover_batch( const std::vector<signature_and_digest>& sigs,
+                                            bool check_canonical = true, fc::thread_pool* pool = nullptr );
+
+     struct recovery_cache_stats
+     {
+         uint64_t hits     = 0;
+         uint64_t misses   = 0;
+         size_t   size     = 0;
+         size_t   capacity = 0;
+     };
+
+     /**
+      *  Sets how many keys the cache of recover_batch keeps, dropping the least recently
+      *  used ones beyond that; 0 turns it off.  It starts with room for 32768 keys.
+      */
+     void set_recovery_cache_size( size_t entries );
+     recovery_cache_stats get_recovery_cache_stats();
 
 
   } // namespace ecc
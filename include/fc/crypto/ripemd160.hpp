@@ -2,6 +2,7 @@
 
 #include <fc/fwd.hpp>
 #include <fc/io/raw_fwd.hpp>
+#include <fc/crypto/digest_batch.hpp>
 #include <fc/reflect/typename.hpp>
 
 namespace fc{
@@ -25,6 +26,10 @@ class ripemd160
     static ripemd160 hash( const char* d, uint32_t dlen );
     static ripemd160 hash( const string& );
 
+    /** sets out[i] to hash( in[i] ) for count messages, several of them at once where the cpu allows it */
+    static void hash_many( const digest_input* in, size_t count, ripemd160* out );
+    static std::vector<ripemd160> hash_many( const std::vector<digest_input>& in );
+
     template<typename T>
     static ripemd160 hash( const T& t ) 
     { 
@@ -80,6 +85,10 @@ class ripemd160
 
   template<> struct get_typename<uint160_t>    { static const char* name()  { return "uint160_t";  } };
 
+  namespace raw {
+    template<> struct fixed_pack_size<ripemd160> : detail::fixed_pack_size_of< sizeof(ripemd160) > {};
+  }
+
 } // namespace fc
 
 namespace std
@@ -74,6 +74,10 @@ class sha224
   void to_variant( const sha224& bi, variant& v, uint32_t max_depth );
   void from_variant( const variant& v, sha224& bi, uint32_t max_depth );
 
+  namespace raw {
+    template<> struct fixed_pack_size<sha224> : detail::fixed_pack_size_of< sizeof(sha224) > {};
+  }
+
 } // fc
 namespace std
 {
@@ -3,6 +3,7 @@
 #include <fc/string.hpp>
 #include <fc/platform_independence.hpp>
 #include <fc/io/raw_fwd.hpp>
+#include <fc/crypto/digest_batch.hpp>
 
 namespace fc
 {
@@ -24,6 +25,20 @@ class sha256
     static sha256 hash( const string& );
     static sha256 hash( const sha256& );
 
+    /**
+     *  Sets out[i] to hash( in[i] ) for count messages, hashing several of them at once
+     *  where the cpu allows it.
+     */
+    static void hash_many( const digest_input* in, size_t count, sha256* out );
+    static std::vector<sha256> hash_many( const std::vector<digest_input>& in );
+
+    /**
+     *  The root of the merkle tree over leaves, in which a node is the hash of its two
+     *  children one after the other and a node without sibling moves up unchanged.
+     *  The root of no leaves is sha256().
+     */
+    static sha256 merkle_root( const std::vector<sha256>& leaves );
+
     template<typename T>
     static sha256 hash( const T& t ) 
     { 
@@ -106,6 +121,10 @@ class sha256
 
   uint64_t hash64(const char* buf, size_t len);    
 
+  namespace raw {
+    template<> struct fixed_pack_size<sha256> : detail::fixed_pack_size_of< sizeof(sha256) > {};
+  }
+
 } // fc
 namespace std
 {
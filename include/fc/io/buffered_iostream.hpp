@@ -63,10 +63,18 @@ namespace fc
          */
         virtual size_t  writesome( const char* buf, size_t len );
         virtual size_t  writesome( const std::shared_ptr<const char>& buf, size_t len, size_t offset );
+        /**
+         *  Small chains are copied to the buffer, larger ones are passed on to the
+         *  underlying stream after what is buffered.
+         */
+        virtual size_t  writesome( const const_buffer_chain& chain, size_t offset );
 
         virtual void close();
         virtual void flush();
       private:
+        /** writes what is buffered to the underlying stream, without flushing it */
+        void write_buffered();
+
         std::unique_ptr<detail::buffered_ostream_impl> my;
    };
    typedef std::shared_ptr<buffered_ostream> buffered_ostream_ptr;
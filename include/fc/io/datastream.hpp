@@ -2,6 +2,8 @@
 #include <fc/utility.hpp>
 #include <string.h>
 #include <stdint.h>
+#include <utility>
+#include <vector>
 
 namespace fc {
 
@@ -89,6 +91,40 @@ class datastream<size_t> {
      size_t _size;
 };
 
+/**
+ *  Writes into a buffer that grows as needed, so a value can be packed in a single pass
+ *  without first running it through a datastream<size_t> to find its size.
+ */
+template<>
+class datastream<std::vector<char>> {
+   public:
+     datastream( size_t capacity = 0 ):_pos(0){ _buffer.resize( capacity ); }
+     inline bool     skip( size_t s )                 { grow( s ); _pos += s; return true; }
+     inline bool     write( const char* d, size_t s ) { grow( s ); memcpy( _buffer.data() + _pos, d, s ); _pos += s; return true; }
+     inline bool     put(char c)                      { grow( 1 ); _buffer[_pos++] = c; return true; }
+     inline bool     valid()const                     { return true;                  }
+     inline bool     seekp(size_t p)                  { _pos = p; grow( 0 ); return true; }
+     inline size_t   tellp()const                     { return _pos;                  }
+     inline size_t   remaining()const                 { return _buffer.size() - _pos; }
+
+     /** @return everything written so far, leaving this stream empty */
+     std::vector<char> release()
+     {
+        _buffer.resize( _pos );
+        _pos = 0;
+        return std::move( _buffer );
+     }
+  private:
+     void grow( size_t s )
+     {
+        if( _pos + s > _buffer.size() )
+           _buffer.resize( _pos + s > 2 * _buffer.size() ? _pos + s : 2 * _buffer.size() );
+     }
+
+     std::vector<char> _buffer;
+     size_t            _pos;
+};
+
 template<typename ST>
 inline datastream<ST>& operator<<(datastream<ST>& ds, const int32_t& d) {
   ds.write( (const char*)&d, sizeof(d) );
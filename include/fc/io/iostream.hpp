@@ -2,9 +2,28 @@
 #include <fc/utility.hpp>
 #include <fc/string.hpp>
 #include <memory>
+#include <vector>
 
 namespace fc {
 
+  /**
+   *  Part of a shared buffer, several of them make up a message which is written
+   *  with one gather write, without copying them together first.
+   */
+  struct const_buffer_slice
+  {
+     const_buffer_slice( std::shared_ptr<const char> data, size_t size, size_t offset = 0 )
+     :data( std::move(data) ), size( size ), offset( offset ){}
+
+     std::shared_ptr<const char> data;
+     size_t                      size;
+     size_t                      offset;
+  };
+  typedef std::vector<const_buffer_slice> const_buffer_chain;
+
+  /** @return the sum of the sizes of the slices of @p chain */
+  size_t total_size( const const_buffer_chain& chain );
+
   /**
    *  Provides a fc::thread friendly cooperatively multi-tasked stream that
    *  will block 'cooperatively' instead of hard blocking.
@@ -45,6 +64,12 @@ namespace fc {
        virtual ~ostream(){};
        virtual size_t     writesome( const char* buf, size_t len ) = 0;
        virtual size_t     writesome( const std::shared_ptr<const char>& buf, size_t len, size_t offset ) = 0;
+       /**
+        *  Writes some of @p chain, starting @p offset bytes into it.  Streams which can gather
+        *  several buffers in one write override this, by default only the slice at @p offset
+        *  is written.
+        */
+       virtual size_t     writesome( const const_buffer_chain& chain, size_t offset );
        virtual void       close() = 0;
        virtual void       flush() = 0;
 
@@ -55,6 +80,7 @@ namespace fc {
         **/
        ostream&   write( const char* buf, size_t len );
        ostream&   write( const std::shared_ptr<const char>& buf, size_t len, size_t offset = 0 );
+       ostream&   write( const const_buffer_chain& chain );
   };
 
   typedef std::shared_ptr<ostream> ostream_ptr;
@@ -1,6 +1,7 @@
 #pragma once
 #include <fc/variant.hpp>
 #include <fc/filesystem.hpp>
+#include <memory>
 
 #define DEFAULT_MAX_RECURSION_DEPTH 200
 
@@ -8,6 +9,7 @@ namespace fc
 {
    class ostream;
    class buffered_istream;
+   namespace detail { class json_reader_impl; }
 
    /**
     *  Provides interface for json serialization.
@@ -25,7 +27,14 @@ namespace fc
             relaxed_parser        = 2,
             legacy_parser_with_string_doubles = 3,
 #endif
-            broken_nul_parser     = 4
+            broken_nul_parser     = 4,
+            /**
+             *  Standard JSON only, decoded from a contiguous buffer with a SIMD structural
+             *  index.  Gives the same variants as strict_parser; unlike it, also accepts
+             *  numbers with a fraction, as doubles.  from_stream() reads the whole rest of
+             *  the stream first.
+             */
+            simd_parser           = 5
          };
          enum output_formatting
          {
@@ -35,6 +44,9 @@ namespace fc
 #endif
          };
 
+         class writer;
+         class reader;
+
          static ostream& to_stream( ostream& out, const fc::string& );
          static ostream& to_stream( ostream& out, const variant& v, output_formatting format = stringify_large_ints_and_doubles, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
          static ostream& to_stream( ostream& out, const variants& v, output_formatting format = stringify_large_ints_and_doubles, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
@@ -58,6 +70,23 @@ namespace fc
          static void     save_to_file( const variant& v, const fc::path& fi, bool pretty = true, output_formatting format = stringify_large_ints_and_doubles, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
          static variant  from_file( const fc::path& p, parse_type ptype = legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
 
+         /**
+          *  Appends @p v to @p w as the same JSON as <code>to_string( variant( v ) )</code>,
+          *  without building the variant: reflected structs, containers, optional, safe and
+          *  static_variant are written directly.  Defined in fc/io/json_pack.hpp.
+          */
+         template<typename T>
+         static void     pack( writer& w, const T& v, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
+
+         /**
+          *  Reads @p v from a JSON document like <code>from_string( json ).as<T>()</code>
+          *  would, without building a variant tree first.  Defined in fc/io/json_pack.hpp.
+          */
+         template<typename T>
+         static void     unpack( reader& r, T& v, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
+         template<typename T>
+         static void     unpack( const std::string& json, T& v, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
+
          template<typename T>
          static T from_file( const fc::path& p, parse_type ptype = legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH )
          {
@@ -83,6 +112,98 @@ namespace fc
          } 
    };
 
+   /**
+    *  @brief appends JSON text to a contiguous buffer
+    *
+    *  json::to_string() and json::to_stream() are built on it.  A writer that is clear()ed
+    *  and reused for every message keeps its buffer, so it stops allocating once the
+    *  buffer has grown to the size of the largest message.
+    */
+   class json::writer
+   {
+      public:
+         explicit writer( output_formatting format = stringify_large_ints_and_doubles, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
+
+         writer& write( const variant& v );
+         writer& write( const variants& a );
+         writer& write( const variant_object& o );
+         /** appends @p str as a quoted and escaped JSON string */
+         writer& write_string( const char* str, size_t size );
+         writer& write_string( const std::string& str ) { return write_string( str.data(), str.size() ); }
+
+         /** @{ scalars, formatted like the variants holding them */
+         writer& write_null();
+         writer& write_bool( bool b );
+         writer& write_int64( int64_t i );
+         writer& write_uint64( uint64_t u );
+         writer& write_double( double d );
+         /** @} */
+
+         /** appends one character of JSON syntax as it is */
+         writer& write_raw( char c ) { _buffer += c; return *this; }
+         /** appends @p name as an object key, followed by ':' */
+         writer& write_key( const char* name );
+
+         const char*        data()const { return _buffer.data(); }
+         size_t             size()const { return _buffer.size(); }
+         const std::string& str()const  { return _buffer;        }
+
+         /** empties the buffer but keeps its capacity */
+         void        clear() { _buffer.clear(); }
+         /** @return the buffer, leaving the writer empty */
+         std::string release();
+
+      private:
+         void write( const variant& v, uint32_t max_depth );
+         void write( const variants& a, uint32_t max_depth );
+         void write( const variant_object& o, uint32_t max_depth );
+         void write_number( const char* begin, const char* end, bool quoted );
+
+         std::string        _buffer;
+         output_formatting  _format;
+         uint32_t           _max_depth;
+   };
+
+   /**
+    *  @brief reads the values of a JSON document one at a time
+    *
+    *  Works on the structural index of json::simd_parser and accepts the same grammar.
+    *  json::unpack() uses it to fill objects without building a variant tree first.  The
+    *  document has to outlive the reader.
+    */
+   class json::reader
+   {
+      public:
+         reader( const char* data, size_t size );
+         ~reader();
+
+         /** @return the first character of the next value or separator, without consuming it */
+         char        peek()const;
+         /** @return true if nothing but whitespace is left */
+         bool        at_end()const;
+
+         /** reads the next value, whatever it is */
+         variant     read_variant( uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
+         std::string read_string();
+         /** @return true and consumes the next value if it is null */
+         bool        read_null();
+
+         /** consumes '{', @return false if the object is empty, with its '}' consumed too */
+         bool        begin_object();
+         /** reads the key of an object member and the ':' after it */
+         std::string read_key();
+         /** consumes the ',' before the next member and @return true, or the '}' and @return false */
+         bool        next_member();
+
+         /** consumes '[', @return false if the array is empty, with its ']' consumed too */
+         bool        begin_array();
+         /** consumes the ',' before the next element and @return true, or the ']' and @return false */
+         bool        next_element();
+
+      private:
+         std::unique_ptr<detail::json_reader_impl> my;
+   };
+
 } // fc
 
 #undef DEFAULT_MAX_RECURSION_DEPTH
@@ -0,0 +1,498 @@
+#pragma once
+#include <fc/io/json.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/container/flat.hpp>
+#include <fc/optional.hpp>
+#include <fc/safe.hpp>
+#include <fc/static_variant.hpp>
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ *  json::pack() and json::unpack() for C++ types, without going through a variant tree.
+ *
+ *  Reflected structs and enums, optional, safe, static_variant, pairs and the usual
+ *  containers are handled here; every other type is converted through its variant, so the
+ *  JSON text is always the same as <code>json::to_string( variant( v ) )</code>.
+ */
+
+namespace fc {
+
+   namespace detail { namespace json_io {
+
+      template<typename T> void pack_value( json::writer& w, const T& v, uint32_t max_depth );
+      inline void pack_value( json::writer& w, const std::string& v, uint32_t max_depth );
+      inline void pack_value( json::writer& w, const variant& v, uint32_t max_depth );
+      inline void pack_value( json::writer& w, const std::vector<char>& v, uint32_t max_depth );
+      template<typename T> void pack_value( json::writer& w, const optional<T>& v, uint32_t max_depth );
+      template<typename T> void pack_value( json::writer& w, const safe<T>& v, uint32_t max_depth );
+      template<typename T> void pack_value( json::writer& w, const std::vector<T>& v, uint32_t max_depth );
+      template<typename T> void pack_value( json::writer& w, const std::deque<T>& v, uint32_t max_depth );
+      template<typename T> void pack_value( json::writer& w, const std::set<T>& v, uint32_t max_depth );
+      template<typename T> void pack_value( json::writer& w, const flat_set<T>& v, uint32_t max_depth );
+      template<typename K, typename T, typename C> void pack_value( json::writer& w, const std::map<K,T,C>& v, uint32_t max_depth );
+      template<typename K, typename... T> void pack_value( json::writer& w, const flat_map<K,T...>& v, uint32_t max_depth );
+      template<typename A, typename B> void pack_value( json::writer& w, const std::pair<A,B>& v, uint32_t max_depth );
+      template<typename... T> void pack_value( json::writer& w, const static_variant<T...>& v, uint32_t max_depth );
+
+      template<typename T> void unpack_value( json::reader& r, T& v, uint32_t max_depth );
+      inline void unpack_value( json::reader& r, std::string& v, uint32_t max_depth );
+      inline void unpack_value( json::reader& r, std::vector<char>& v, uint32_t max_depth );
+      template<typename T> void unpack_value( json::reader& r, optional<T>& v, uint32_t max_depth );
+      template<typename T> void unpack_value( json::reader& r, safe<T>& v, uint32_t max_depth );
+      template<typename T> void unpack_value( json::reader& r, std::vector<T>& v, uint32_t max_depth );
+      template<typename T> void unpack_value( json::reader& r, std::set<T>& v, uint32_t max_depth );
+      template<typename T> void unpack_value( json::reader& r, flat_set<T>& v, uint32_t max_depth );
+      template<typename K, typename T, typename C> void unpack_value( json::reader& r, std::map<K,T,C>& v, uint32_t max_depth );
+      template<typename K, typename T, typename... A> void unpack_value( json::reader& r, flat_map<K,T,A...>& v, uint32_t max_depth );
+      template<typename A, typename B> void unpack_value( json::reader& r, std::pair<A,B>& v, uint32_t max_depth );
+      template<typename... T> void unpack_value( json::reader& r, static_variant<T...>& v, uint32_t max_depth );
+
+      /** true if a call of to_variant() or from_variant() for T resolves to an overload other than the templates in fc/reflect/variant.hpp */
+      template<typename T, typename = void>
+      struct has_own_to_variant : std::false_type {};
+      template<typename T>
+      struct has_own_to_variant<T, decltype( to_variant( std::declval<const conversion_probe<T>&>(), std::declval<variant&>(), uint32_t() ) )>
+         : std::true_type {};
+      template<typename T, typename = void>
+      struct has_own_from_variant : std::false_type {};
+      template<typename T>
+      struct has_own_from_variant<T, decltype( from_variant( std::declval<const variant&>(), std::declval<conversion_probe<T>&>(), uint32_t() ) )>
+         : std::true_type {};
+
+      /**
+       *  True if T converts to and from variants through the templates in
+       *  fc/reflect/variant.hpp, i.e. it is reflected and has no conversions of its own.
+       *  An explicit specialization of those templates cannot be told apart from them, so
+       *  types with their own conversions should overload to_variant()/from_variant() instead.
+       */
+      template<typename T, bool ClassOrEnum = std::is_class<T>::value || std::is_enum<T>::value>
+      struct uses_reflection : std::false_type {};
+      template<typename T>
+      struct uses_reflection<T, true> : std::integral_constant<bool,
+            fc::reflector<T>::is_defined::value && !has_own_to_variant<T>::value && !has_own_from_variant<T>::value > {};
+
+      enum class value_kind { boolean, signed_int, unsigned_int, floating, reflected_enum, reflected_struct, other };
+
+      template<typename T>
+      struct kind_of
+      {
+         static const value_kind value =
+              std::is_same<T, bool>::value ? value_kind::boolean
+            : std::is_same<T, char>::value || std::is_same<T, wchar_t>::value ? value_kind::other
+            : std::is_integral<T>::value ? ( std::is_signed<T>::value ? value_kind::signed_int : value_kind::unsigned_int )
+            : std::is_floating_point<T>::value ? value_kind::floating
+            : !uses_reflection<T>::value ? value_kind::other
+            : fc::reflector<T>::is_enum::value ? value_kind::reflected_enum
+            : value_kind::reflected_struct;
+      };
+
+      template<value_kind Kind> struct packer;
+
+      template<> struct packer<value_kind::boolean>
+      {
+         static void pack( json::writer& w, bool v, uint32_t ) { w.write_bool( v ); }
+      };
+      template<> struct packer<value_kind::signed_int>
+      {
+         template<typename T>
+         static void pack( json::writer& w, T v, uint32_t ) { w.write_int64( v ); }
+      };
+      template<> struct packer<value_kind::unsigned_int>
+      {
+         template<typename T>
+         static void pack( json::writer& w, T v, uint32_t ) { w.write_uint64( v ); }
+      };
+      template<> struct packer<value_kind::floating>
+      {
+         template<typename T>
+         static void pack( json::writer& w, T v, uint32_t ) { w.write_double( v ); }
+      };
+      template<> struct packer<value_kind::reflected_enum>
+      {
+         template<typename T>
+         static void pack( json::writer& w, const T& v, uint32_t ) { w.write_string( fc::reflector<T>::to_fc_string( v ) ); }
+      };
+      template<> struct packer<value_kind::other>
+      {
+         template<typename T>
+         static void pack( json::writer& w, const T& v, uint32_t max_depth ) { w.write( variant( v, max_depth ) ); }
+      };
+
+      /** writes the members of a reflected struct, leaving out optional members without a value */
+      template<typename T>
+      class pack_member_visitor
+      {
+         public:
+            pack_member_visitor( json::writer& w, const T& v, uint32_t max_depth )
+            :_w(w), _val(v), _max_depth(max_depth), _first(true) {}
+
+            template<typename Member, class Class, Member (Class::*member)>
+            void operator()( const char* name )const
+            {
+               add( name, _val.*member );
+            }
+
+         private:
+            template<typename M>
+            void add( const char* name, const optional<M>& v )const
+            {
+               if( v.valid() )
+                  add( name, *v );
+            }
+            template<typename M>
+            void add( const char* name, const M& v )const
+            {
+               if( !_first )
+                  _w.write_raw( ',' );
+               _first = false;
+               _w.write_key( name );
+               pack_value( _w, v, _max_depth );
+            }
+
+            json::writer&  _w;
+            const T&       _val;
+            const uint32_t _max_depth;
+            mutable bool   _first;
+      };
+
+      template<> struct packer<value_kind::reflected_struct>
+      {
+         template<typename T>
+         static void pack( json::writer& w, const T& v, uint32_t max_depth )
+         {
+            FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+            w.write_raw( '{' );
+            fc::reflector<T>::visit( pack_member_visitor<T>( w, v, max_depth - 1 ) );
+            w.write_raw( '}' );
+         }
+      };
+
+      template<typename Range>
+      void pack_range( json::writer& w, const Range& range, uint32_t max_depth )
+      {
+         FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+         w.write_raw( '[' );
+         bool first = true;
+         for( const auto& item : range )
+         {
+            if( !first )
+               w.write_raw( ',' );
+            first = false;
+            pack_value( w, item, max_depth - 1 );
+         }
+         w.write_raw( ']' );
+      }
+
+      template<typename T>
+      void pack_value( json::writer& w, const T& v, uint32_t max_depth )
+      {
+         packer<kind_of<T>::value>::pack( w, v, max_depth );
+      }
+      inline void pack_value( json::writer& w, const std::string& v, uint32_t )
+      {
+         w.write_string( v );
+      }
+      inline void pack_value( json::writer& w, const variant& v, uint32_t )
+      {
+         w.write( v );
+      }
+      inline void pack_value( json::writer& w, const std::vector<char>& v, uint32_t max_depth )
+      {
+         w.write( variant( v, max_depth ) );
+      }
+      template<typename T>
+      void pack_value( json::writer& w, const optional<T>& v, uint32_t max_depth )
+      {
+         FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+         if( v.valid() )
+            pack_value( w, *v, max_depth - 1 );
+         else
+            w.write_null();
+      }
+      template<typename T>
+      void pack_value( json::writer& w, const safe<T>& v, uint32_t max_depth )
+      {
+         pack_value( w, v.value, max_depth );
+      }
+      template<typename T>
+      void pack_value( json::writer& w, const std::vector<T>& v, uint32_t max_depth )
+      {
+         pack_range( w, v, max_depth );
+      }
+      template<typename T>
+      void pack_value( json::writer& w, const std::deque<T>& v, uint32_t max_depth )
+      {
+         pack_range( w, v, max_depth );
+      }
+      template<typename T>
+      void pack_value( json::writer& w, const std::set<T>& v, uint32_t max_depth )
+      {
+         pack_range( w, v, max_depth );
+      }
+      template<typename T>
+      void pack_value( json::writer& w, const flat_set<T>& v, uint32_t max_depth )
+      {
+         pack_range( w, v, max_depth );
+      }
+      template<typename K, typename T, typename C>
+      void pack_value( json::writer& w, const std::map<K,T,C>& v, uint32_t max_depth )
+      {
+         pack_range( w, v, max_depth );
+      }
+      template<typename K, typename... T>
+      void pack_value( json::writer& w, const flat_map<K,T...>& v, uint32_t max_depth )
+      {
+         pack_range( w, v, max_depth );
+      }
+      template<typename A, typename B>
+      void pack_value( json::writer& w, const std::pair<A,B>& v, uint32_t max_depth )
+      {
+         FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+         w.write_raw( '[' );
+         pack_value( w, v.first, max_depth - 1 );
+         w.write_raw( ',' );
+         pack_value( w, v.second, max_depth - 1 );
+         w.write_raw( ']' );
+      }
+
+      struct pack_static_variant_visitor
+      {
+         typedef void result_type;
+         json::writer& w;
+         uint32_t      max_depth;
+         template<typename T> void operator()( const T& v )const { pack_value( w, v, max_depth ); }
+      };
+
+      template<typename... T>
+      void pack_value( json::writer& w, const static_variant<T...>& v, uint32_t max_depth )
+      {
+         FC_ASSERT( max_depth > 0 );
+         w.write_raw( '[' );
+         w.write_int64( v.which() );
+         w.write_raw( ',' );
+         v.visit( pack_static_variant_visitor{ w, max_depth - 1 } );
+         w.write_raw( ']' );
+      }
+
+      template<value_kind Kind> struct unpacker
+      {
+         template<typename T>
+         static void unpack( json::reader& r, T& v, uint32_t max_depth ) { from_variant( r.read_variant( max_depth ), v, max_depth ); }
+      };
+
+      template<> struct unpacker<value_kind::reflected_enum>
+      {
+         template<typename T>
+         static void unpack( json::reader& r, T& v, uint32_t max_depth )
+         {
+            if( r.peek() == '"' )
+               v = fc::reflector<T>::from_string( r.read_string().c_str() );
+            else
+               v = fc::reflector<T>::from_int( r.read_variant( max_depth ).as_int64() );
+         }
+      };
+
+      /** reads the value of the member named key, if there is one */
+      template<typename T>
+      class unpack_member_visitor
+      {
+         public:
+            unpack_member_visitor( json::reader& r, T& v, const std::string& key, uint32_t max_depth )
+            :_r(r), _val(v), _key(key), _max_depth(max_depth), found(false) {}
+
+            template<typename Member, class Class, Member (Class::*member)>
+            void operator()( const char* name )const
+            {
+               if( !found && _key == name )
+               {
+                  found = true;
+                  unpack_value( _r, _val.*member, _max_depth );
+               }
+            }
+
+         private:
+            json::reader&       _r;
+            T&                  _val;
+            const std::string&  _key;
+            const uint32_t      _max_depth;
+         public:
+            mutable bool        found;
+      };
+
+      /** members missing from the JSON object keep their value, unknown keys are skipped */
+      template<> struct unpacker<value_kind::reflected_struct>
+      {
+         template<typename T>
+         static void unpack( json::reader& r, T& v, uint32_t max_depth )
+         {
+            FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+            if( !r.begin_object() )
+               return;
+            do
+            {
+               const std::string key = r.read_key();
+               unpack_member_visitor<T> visitor( r, v, key, max_depth - 1 );
+               fc::reflector<T>::visit( visitor );
+               if( !visitor.found )
+                  r.read_variant( max_depth - 1 );
+            } while( r.next_member() );
+         }
+      };
+
+      template<typename Container>
+      void unpack_into( json::reader& r, Container& c, uint32_t max_depth )
+      {
+         FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+         c.clear();
+         if( !r.begin_array() )
+            return;
+         do
+         {
+            typename Container::value_type item;
+            unpack_value( r, item, max_depth - 1 );
+            c.insert( c.end(), std::move( item ) );
+         } while( r.next_element() );
+      }
+
+      /** same as unpack_into(), for maps whose value_type has a const key */
+      template<typename Map>
+      void unpack_map( json::reader& r, Map& m, uint32_t max_depth )
+      {
+         FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+         m.clear();
+         if( !r.begin_array() )
+            return;
+         do
+         {
+            std::pair<typename Map::key_type, typename Map::mapped_type> item;
+            unpack_value( r, item, max_depth - 1 );
+            m.insert( std::move( item ) );
+         } while( r.next_element() );
+      }
+
+      template<typename T>
+      void unpack_value( json::reader& r, T& v, uint32_t max_depth )
+      {
+         unpacker<kind_of<T>::value>::unpack( r, v, max_depth );
+      }
+      inline void unpack_value( json::reader& r, std::string& v, uint32_t max_depth )
+      {
+         if( r.peek() == '"' )
+            v = r.read_string();
+         else
+            v = r.read_variant( max_depth ).as_string();
+      }
+      inline void unpack_value( json::reader& r, std::vector<char>& v, uint32_t max_depth )
+      {
+         from_variant( r.read_variant( max_depth ), v, max_depth );
+      }
+      template<typename T>
+      void unpack_value( json::reader& r, optional<T>& v, uint32_t max_depth )
+      {
+         if( r.read_null() )
+            v = optional<T>();
+         else
+         {
+            FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+            v = T();
+            unpack_value( r, *v, max_depth - 1 );
+         }
+      }
+      template<typename T>
+      void unpack_value( json::reader& r, safe<T>& v, uint32_t max_depth )
+      {
+         unpack_value( r, v.value, max_depth );
+      }
+      template<typename T>
+      void unpack_value( json::reader& r, std::vector<T>& v, uint32_t max_depth )
+      {
+         unpack_into( r, v, max_depth );
+      }
+      template<typename T>
+      void unpack_value( json::reader& r, std::set<T>& v, uint32_t max_depth )
+      {
+         unpack_into( r, v, max_depth );
+      }
+      template<typename T>
+      void unpack_value( json::reader& r, flat_set<T>& v, uint32_t max_depth )
+      {
+         unpack_into( r, v, max_depth );
+      }
+      template<typename K, typename T, typename C>
+      void unpack_value( json::reader& r, std::map<K,T,C>& v, uint32_t max_depth )
+      {
+         unpack_map( r, v, max_depth );
+      }
+      template<typename K, typename T, typename... A>
+      void unpack_value( json::reader& r, flat_map<K,T,A...>& v, uint32_t max_depth )
+      {
+         unpack_map( r, v, max_depth );
+      }
+
+      /** like from_variant(), a missing second element leaves it alone and extra ones are ignored */
+      template<typename A, typename B>
+      void unpack_value( json::reader& r, std::pair<A,B>& v, uint32_t max_depth )
+      {
+         FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
+         if( !r.begin_array() )
+            return;
+         unpack_value( r, v.first, max_depth - 1 );
+         if( !r.next_element() )
+            return;
+         unpack_value( r, v.second, max_depth - 1 );
+         while( r.next_element() )
+            r.read_variant( max_depth - 1 );
+      }
+
+      struct unpack_static_variant_visitor
+      {
+         typedef void result_type;
+         json::reader& r;
+         uint32_t      max_depth;
+         template<typename T> void operator()( T& v )const { unpack_value( r, v, max_depth ); }
+      };
+
+      template<typename... T>
+      void unpack_value( json::reader& r, static_variant<T...>& v, uint32_t max_depth )
+      {
+         FC_ASSERT( max_depth > 0 );
+         if( !r.begin_array() )
+            return;
+         const uint64_t which = r.read_variant( max_depth - 1 ).as_uint64();
+         if( !r.next_element() )
+            return;
+         v.set_which( which );
+         v.visit( unpack_static_variant_visitor{ r, max_depth - 1 } );
+         while( r.next_element() )
+            r.read_variant( max_depth - 1 );
+      }
+
+   } } // detail::json_io
+
+   template<typename T>
+   void json::pack( writer& w, const T& v, uint32_t max_depth )
+   {
+      detail::json_io::pack_value( w, v, max_depth );
+   }
+
+   template<typename T>
+   void json::unpack( reader& r, T& v, uint32_t max_depth )
+   {
+      detail::json_io::unpack_value( r, v, max_depth );
+   }
+
+   template<typename T>
+   void json::unpack( const std::string& json, T& v, uint32_t max_depth )
+   {
+      reader r( json.data(), json.size() );
+      detail::json_io::unpack_value( r, v, max_depth );
+   }
+
+} // namespace fc
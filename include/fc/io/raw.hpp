@@ -14,6 +14,7 @@
 #include <fc/io/raw_fwd.hpp>
 #include <algorithm>
 #include <map>
+#include <type_traits>
 #include <deque>
 
 namespace fc {
@@ -178,18 +179,64 @@ namespace fc {
       }while( val );
     }
 
+    namespace detail {
+      /**
+       *  Decodes a varint of up to 5 bytes straight out of the buffer, without a bounds
+       *  check per byte.  @return false, having consumed nothing, if fewer than 5 bytes
+       *  remain or the varint is longer; the caller then reads it a byte at a time.
+       */
+      inline bool read_varint32( datastream<const char*>& s, uint32_t& value )
+      {
+        if( s.remaining() < 5 )
+          return false;
+        const uint8_t* p = reinterpret_cast<const uint8_t*>( s.pos() );
+        uint32_t b = p[0];
+        uint32_t v = b & 0x7f;
+        if( b < 0x80 ) { s.skip( 1 ); value = v; return true; }
+        b = p[1]; v |= (b & 0x7f) << 7;
+        if( b < 0x80 ) { s.skip( 2 ); value = v; return true; }
+        b = p[2]; v |= (b & 0x7f) << 14;
+        if( b < 0x80 ) { s.skip( 3 ); value = v; return true; }
+        b = p[3]; v |= (b & 0x7f) << 21;
+        if( b < 0x80 ) { s.skip( 4 ); value = v; return true; }
+        b = p[4]; v |= b << 28;
+        if( b < 0x80 ) { s.skip( 5 ); value = v; return true; }
+        return false;
+      }
+      template<typename Stream>
+      inline bool read_varint32( Stream&, uint32_t& ) { return false; }
+
+      /** throws before anything is allocated if a length prefix runs past the end of the buffer */
+      inline void check_remaining( datastream<const char*>& s, size_t size )
+      {
+        if( size > s.remaining() )
+          fc::detail::throw_datastream_range_error( "read", s.tellp() + s.remaining(), int64_t(size - s.remaining()) );
+      }
+      template<typename Stream>
+      inline void check_remaining( Stream&, size_t ) {}
+    }
+
     template<typename Stream> inline void unpack( Stream& s, signed_int& vi, uint32_t _max_depth ) {
       uint32_t v = 0; char b = 0; int by = 0;
-      do {
-        s.get(b);
-        v |= uint32_t(uint8_t(b) & 0x7f) << by;
-        by += 7;
-      } while( uint8_t(b) & 0x80 );
+      if( !detail::read_varint32( s, v ) )
+      {
+        do {
+          s.get(b);
+          v |= uint32_t(uint8_t(b) & 0x7f) << by;
+          by += 7;
+        } while( uint8_t(b) & 0x80 );
+      }
       vi.value = ((v>>1) ^ (v>>31)) + (v&0x01);
       vi.value = v&0x01 ? vi.value : -vi.value;
       vi.value = -vi.value;
     }
     template<typename Stream> inline void unpack( Stream& s, unsigned_int& vi, uint32_t _max_depth ) {
+      uint32_t fast;
+      if( detail::read_varint32( s, fast ) )
+      {
+         vi.value = fast;
+         return;
+      }
       uint64_t v = 0; char b = 0; uint8_t by = 0;
       do {
           s.get(b);
@@ -281,11 +328,26 @@ namespace fc {
        FC_ASSERT( _max_depth > 0 );
        unsigned_int size; fc::raw::unpack( s, size, _max_depth - 1 );
        FC_ASSERT( size.value < MAX_ARRAY_ALLOC_SIZE );
+       detail::check_remaining( s, size.value );
        value.resize(size.value);
        if( value.size() )
           s.read( value.data(), value.size() );
     }
 
+    template<typename Stream> inline void pack( Stream& s, const blob_view& value, uint32_t _max_depth ) {
+       FC_ASSERT( _max_depth > 0 );
+       fc::raw::pack( s, unsigned_int((uint32_t)value.size()), _max_depth - 1 );
+       if( value.size() )
+          s.write( value.data(), (uint32_t)value.size() );
+    }
+    inline void unpack( datastream<const char*>& s, blob_view& value, uint32_t _max_depth ) {
+       FC_ASSERT( _max_depth > 0 );
+       unsigned_int size; fc::raw::unpack( s, size, _max_depth - 1 );
+       detail::check_remaining( s, size.value );
+       value = blob_view( s.pos(), size.value );
+       s.skip( size.value );
+    }
+
     // fc::string
     template<typename Stream> inline void pack( Stream& s, const fc::string& v, uint32_t _max_depth )  {
        FC_ASSERT( _max_depth > 0 );
@@ -295,10 +357,26 @@ namespace fc {
 
     template<typename Stream> inline void unpack( Stream& s, fc::string& v, uint32_t _max_depth )  {
        FC_ASSERT( _max_depth > 0 );
-       std::vector<char> tmp; fc::raw::unpack( s, tmp, _max_depth - 1 );
-       if( tmp.size() )
-          v = fc::string( tmp.data(), tmp.data()+tmp.size() );
-       else v = fc::string();
+       unsigned_int size; fc::raw::unpack( s, size, _max_depth - 1 );
+       FC_ASSERT( size.value < MAX_ARRAY_ALLOC_SIZE );
+       detail::check_remaining( s, size.value );
+       v.resize( size.value );
+       if( size.value )
+          s.read( &v[0], size.value );
+    }
+
+    template<typename Stream> inline void pack( Stream& s, const string_view& v, uint32_t _max_depth )  {
+       FC_ASSERT( _max_depth > 0 );
+       fc::raw::pack( s, unsigned_int((uint32_t)v.size()), _max_depth - 1 );
+       if( v.size() ) s.write( v.data(), v.size() );
+    }
+
+    inline void unpack( datastream<const char*>& s, string_view& v, uint32_t _max_depth )  {
+       FC_ASSERT( _max_depth > 0 );
+       unsigned_int size; fc::raw::unpack( s, size, _max_depth - 1 );
+       detail::check_remaining( s, size.value );
+       v = string_view( s.pos(), size.value );
+       s.skip( size.value );
     }
 
     // bool
@@ -316,6 +394,99 @@ namespace fc {
        v=(b!=0);
     }
 
+    template<typename T>
+    struct fixed_pack_size< T, typename std::enable_if< std::is_arithmetic<T>::value >::type >
+       : detail::fixed_pack_size_of< sizeof(T) > {};
+
+    template<typename T>
+    struct fixed_pack_size< T, typename std::enable_if< std::is_enum<T>::value
+                                                        && !fc::reflector<T>::is_defined::value >::type >
+       : detail::fixed_pack_size_of< sizeof(T) > {};
+
+    template<typename T, size_t N>
+    struct fixed_pack_size< fc::array<T,N> > : detail::fixed_pack_size_of< N * sizeof(T) > {};
+
+    template<> struct fixed_pack_size< fc::time_point_sec >
+       : detail::fixed_pack_size_of< sizeof(uint32_t), sizeof(fc::time_point_sec) == sizeof(uint32_t) > {};
+    template<> struct fixed_pack_size< fc::time_point >
+       : detail::fixed_pack_size_of< sizeof(uint64_t), sizeof(fc::time_point) == sizeof(uint64_t) > {};
+    template<> struct fixed_pack_size< fc::microseconds >
+       : detail::fixed_pack_size_of< sizeof(uint64_t), sizeof(fc::microseconds) == sizeof(uint64_t) > {};
+
+    namespace detail {
+      template<typename T> struct always_void { typedef void type; };
+
+      template<typename List> struct fixed_pack_size_of_all;
+      template<> struct fixed_pack_size_of_all< fc::type_list<> > : fixed_pack_size_of<0> {};
+      template<typename T, typename... Rest>
+      struct fixed_pack_size_of_all< fc::type_list<T,Rest...> >
+      {
+         typedef fixed_pack_size_of_all< fc::type_list<Rest...> > rest;
+         static const bool   is_fixed = fixed_pack_size<T>::is_fixed && rest::is_fixed;
+         static const size_t size     = is_fixed ? fixed_pack_size<T>::size + rest::size : 0;
+      };
+    }
+
+    /** a reflected class is only bitwise if its layout matches, see detail::packs_as_copy() */
+    template<typename T>
+    struct fixed_pack_size< T, typename detail::always_void< typename fc::reflector<T>::member_types >::type >
+    {
+       typedef detail::fixed_pack_size_of_all< typename fc::reflector<T>::base_types >   bases;
+       typedef detail::fixed_pack_size_of_all< typename fc::reflector<T>::member_types > members;
+       static const bool   is_fixed = bases::is_fixed && members::is_fixed;
+       static const bool   bitwise  = false;
+       static const size_t size     = is_fixed ? bases::size + members::size : 0;
+    };
+
+    namespace detail {
+      template<typename T> inline bool packs_as_copy( const T& v );
+
+      /** checks that each member of a fixed size class sits right where it is packed */
+      template<typename Class>
+      struct layout_check_visitor {
+        layout_check_visitor( const Class& _c ) : c(_c), offset(0), matches(true) {}
+
+        template<typename T, typename C, T(C::*p)>
+        void operator()( const char* name )const {
+          const T& member = c.*p;
+          matches = matches && size_t( (const char*)&member - (const char*)&c ) == offset
+                            && packs_as_copy( member );
+          offset += fixed_pack_size<T>::size;
+        }
+
+        const Class&   c;
+        mutable size_t offset;
+        mutable bool   matches;
+      };
+
+      template<typename T, typename Enable = void>
+      struct copy_packing {
+        static bool check( const T& ) { return fixed_pack_size<T>::is_fixed && fixed_pack_size<T>::bitwise; }
+      };
+
+      template<typename T>
+      struct copy_packing< T, typename std::enable_if< fixed_pack_size<T>::is_fixed && !fixed_pack_size<T>::bitwise >::type > {
+        static bool check( const T& v ) {
+          // layout is a property of the type, so the first value checked decides for all
+          static const bool matches = layout_matches( v );
+          return matches;
+        }
+        static bool layout_matches( const T& v ) {
+          layout_check_visitor<T> visitor( v );
+          fc::reflector<T>::visit( visitor );
+          return visitor.matches && visitor.offset == fixed_pack_size<T>::size;
+        }
+      };
+
+      /**
+       *  @return true if packing @p v writes exactly its first fixed_pack_size<T>::size bytes:
+       *  T has a fixed size and, for reflected classes, its members are laid out in the
+       *  order they are reflected, without padding, and pack bitwise themselves.
+       */
+      template<typename T>
+      inline bool packs_as_copy( const T& v ) { return copy_packing<T>::check( v ); }
+    }
+
     namespace detail {
 
       template<typename Stream, typename Class>
@@ -379,7 +550,10 @@ namespace fc {
         template<typename Stream, typename T>
         static inline void pack( Stream& s, const T& v, uint32_t _max_depth ) {
           FC_ASSERT( _max_depth > 0 );
-          fc::reflector<T>::visit( pack_object_visitor<Stream,T>( v, s, _max_depth - 1 ) );
+          if( packs_as_copy( v ) )
+            s.write( (const char*)&v, fixed_pack_size<T>::size );
+          else
+            fc::reflector<T>::visit( pack_object_visitor<Stream,T>( v, s, _max_depth - 1 ) );
         }
         template<typename Stream, typename T>
         static inline void unpack( Stream& s, T& v, uint32_t _max_depth ) {
@@ -629,42 +803,49 @@ namespace fc {
        fc::raw::detail::if_reflected< typename fc::reflector<T>::is_defined >::unpack( s, v, _max_depth - 1 );
     } FC_RETHROW_EXCEPTIONS( warn, "error unpacking ${type}", ("type",fc::get_typename<T>::name() ) ) }
 
+    namespace detail {
+      template<typename T>
+      inline size_t pack_size( const T& v, fc::true_type /* fixed */ ) { return fixed_pack_size<T>::size; }
+
+      template<typename T>
+      inline size_t pack_size( const T& v, fc::false_type )
+      {
+         datastream<size_t> ps;
+         fc::raw::pack( ps, v );
+         return ps.tellp();
+      }
+
+      /** what to reserve for packing a T in one pass: exact for fixed size types */
+      template<typename T>
+      inline size_t pack_capacity_hint()
+      {
+         return fixed_pack_size<T>::is_fixed ? fixed_pack_size<T>::size : 128;
+      }
+    }
+
     template<typename T>
     inline size_t pack_size( const T& v )
     {
-       datastream<size_t> ps;
-       fc::raw::pack( ps, v );
-       return ps.tellp();
+       typedef typename std::conditional< fixed_pack_size<T>::is_fixed, fc::true_type, fc::false_type >::type is_fixed;
+       return detail::pack_size( v, is_fixed() );
     }
 
     template<typename T>
     inline std::vector<char> pack( const T& v, uint32_t _max_depth ) {
        FC_ASSERT( _max_depth > 0 );
        --_max_depth;
-       datastream<size_t> ps;
-       fc::raw::pack( ps, v, _max_depth );
-       std::vector<char> vec(ps.tellp());
-
-       if( vec.size() ) {
-          datastream<char*>  ds( vec.data(), size_t(vec.size()) );
-          fc::raw::pack( ds, v, _max_depth );
-       }
-       return vec;
+       datastream<std::vector<char>> ds( detail::pack_capacity_hint<T>() );
+       fc::raw::pack( ds, v, _max_depth );
+       return ds.release();
     }
 
     template<typename T, typename... Next>
     inline std::vector<char> pack(  const T& v, Next... next, uint32_t _max_depth ) {
        FC_ASSERT( _max_depth > 0 );
        --_max_depth;
-       datastream<size_t> ps;
-       fc::raw::pack( ps, v, next..., _max_depth );
-       std::vector<char> vec(ps.tellp());
-
-       if( vec.size() ) {
-          datastream<char*>  ds( vec.data(), size_t(vec.size()) );
-          fc::raw::pack( ds, v, next..., _max_depth );
-       }
-       return vec;
+       datastream<std::vector<char>> ds( detail::pack_capacity_hint<T>() );
+       fc::raw::pack( ds, v, next..., _max_depth );
+       return ds.release();
     }
 
 
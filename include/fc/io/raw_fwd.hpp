@@ -3,6 +3,7 @@
 #include <fc/container/flat_fwd.hpp>
 #include <fc/container/deque_fwd.hpp>
 #include <fc/io/varint.hpp>
+#include <fc/io/raw_view.hpp>
 #include <fc/array.hpp>
 #include <fc/safe.hpp>
 #include <deque>
@@ -27,11 +28,38 @@ namespace fc {
 
    namespace ecc { class public_key; class private_key; }
    template<typename Storage> class fixed_string;
+   template<typename T> class datastream;
 
    namespace raw {
     template<typename T>
     inline size_t pack_size(  const T& v );
 
+    /**
+     *  Whether every value of T packs to the same number of bytes, and how many; size is a
+     *  constant expression.  bitwise says the packed bytes are the value's own bytes.
+     *
+     *  Holds for arithmetic types, enums without reflection, fc::array, the fc time types
+     *  and reflected classes whose bases and members all do.  Types with a pack() of their
+     *  own that always writes the same number of bytes may specialize it.
+     */
+    template<typename T, typename Enable = void>
+    struct fixed_pack_size
+    {
+       static const bool   is_fixed = false;
+       static const bool   bitwise  = false;
+       static const size_t size     = 0;
+    };
+
+    namespace detail {
+       template<size_t Size, bool Bitwise = true>
+       struct fixed_pack_size_of
+       {
+          static const bool   is_fixed = true;
+          static const bool   bitwise  = Bitwise;
+          static const size_t size     = Size;
+       };
+    }
+
     template<typename Stream, typename Storage> inline void pack( Stream& s, const fc::fixed_string<Storage>& u, uint32_t _max_depth=FC_PACK_MAX_DEPTH );
     template<typename Stream, typename Storage> inline void unpack( Stream& s, fc::fixed_string<Storage>& u, uint32_t _max_depth=FC_PACK_MAX_DEPTH );
 
@@ -112,6 +140,11 @@ namespace fc {
     template<typename Stream> inline void pack( Stream& s, const std::vector<char>& value, uint32_t _max_depth=FC_PACK_MAX_DEPTH );
     template<typename Stream> inline void unpack( Stream& s, std::vector<char>& value, uint32_t _max_depth=FC_PACK_MAX_DEPTH );
 
+    template<typename Stream> inline void pack( Stream& s, const blob_view& v, uint32_t _max_depth=FC_PACK_MAX_DEPTH );
+    inline void unpack( datastream<const char*>& s, blob_view& v, uint32_t _max_depth=FC_PACK_MAX_DEPTH );
+    template<typename Stream> inline void pack( Stream& s, const string_view& v, uint32_t _max_depth=FC_PACK_MAX_DEPTH );
+    inline void unpack( datastream<const char*>& s, string_view& v, uint32_t _max_depth=FC_PACK_MAX_DEPTH );
+
     template<typename Stream, typename T, size_t N> inline void pack( Stream& s, const fc::array<T,N>& v, uint32_t _max_depth=FC_PACK_MAX_DEPTH );
     template<typename Stream, typename T, size_t N> inline void unpack( Stream& s, fc::array<T,N>& v, uint32_t _max_depth=FC_PACK_MAX_DEPTH);
 
@@ -0,0 +1,49 @@
+#pragma once
+#include <boost/utility/string_view.hpp>
+#include <string.h>
+#include <vector>
+
+namespace fc { namespace raw {
+
+   /**
+    *  Strings unpacked from a datastream<const char*> as a view into the buffer being
+    *  unpacked instead of a copy.  It packs exactly like fc::string.
+    */
+   typedef boost::string_view string_view;
+
+   /**
+    *  @brief a borrowed run of bytes
+    *
+    *  Packs exactly like std::vector<char>.  Unpacking one from a datastream<const char*>
+    *  points it into the buffer being unpacked without copying, so it is only valid as
+    *  long as that buffer is.
+    */
+   class blob_view
+   {
+      public:
+         blob_view() : _data(nullptr), _size(0) {}
+         blob_view( const char* data, size_t size ) : _data(data), _size(size) {}
+         blob_view( const std::vector<char>& v ) : _data(v.data()), _size(v.size()) {}
+
+         const char* data()const  { return _data;         }
+         size_t      size()const  { return _size;         }
+         bool        empty()const { return _size == 0;    }
+         const char* begin()const { return _data;         }
+         const char* end()const   { return _data + _size; }
+
+         const char& operator[]( size_t i )const { return _data[i]; }
+
+         std::vector<char> to_vector()const { return std::vector<char>( begin(), end() ); }
+
+         friend bool operator==( const blob_view& a, const blob_view& b )
+         {
+            return a._size == b._size && ( a._size == 0 || memcmp( a._data, b._data, a._size ) == 0 );
+         }
+         friend bool operator!=( const blob_view& a, const blob_view& b ) { return !( a == b ); }
+
+      private:
+         const char* _data;
+         size_t      _size;
+   };
+
+} } // namespace fc::raw
@@ -9,6 +9,9 @@ namespace fc {
 
 class file_appender : public appender {
     public:
+         /** what a logging thread does when its queue of the async mode is full */
+         struct overflow { enum type { block, drop }; };
+
          struct config {
             config( const fc::path& p = "log.txt" );
 
@@ -20,11 +23,30 @@ class file_appender : public appender {
             microseconds                       rotation_limit;
             bool                               rotation_compression = false;
             uint32_t                           max_object_depth;
+            /**
+             *  Queues lines on a lock-free ring per logging thread, a writer thread writes
+             *  them every async_flush_interval in one write and flushes if @ref flush is set.
+             */
+            bool                               async = false;
+            uint32_t                           async_queue_size = 1024;
+            microseconds                       async_flush_interval = milliseconds( 100 );
+            overflow::type                     async_overflow = overflow::block;
+         };
+
+         /** counters of the async mode */
+         struct async_stats {
+            uint64_t written = 0; ///< lines written to the file
+            uint64_t dropped = 0; ///< lines dropped because a queue was full
+            uint64_t waits = 0;   ///< times a logging thread waited for room in its queue
+            uint64_t writes = 0;  ///< batches written
          };
+
          file_appender( const variant& args );
          ~file_appender();
          virtual void log( const log_message& m )override;
 
+         async_stats get_async_stats()const;
+
       private:
          class impl;
          fc::shared_ptr<impl> my;
@@ -32,5 +54,8 @@ class file_appender : public appender {
 } // namespace fc
 
 #include <fc/reflect/reflect.hpp>
+FC_REFLECT_ENUM( fc::file_appender::overflow::type, (block)(drop) )
 FC_REFLECT( fc::file_appender::config,
-            (format)(filename)(flush)(rotate)(rotation_interval)(rotation_limit)(rotation_compression)(max_object_depth) )
+            (format)(filename)(flush)(rotate)(rotation_interval)(rotation_limit)(rotation_compression)(max_object_depth)
+            (async)(async_queue_size)(async_flush_interval)(async_overflow) )
+FC_REFLECT( fc::file_appender::async_stats, (written)(dropped)(waits)(writes) )
@@ -8,6 +8,7 @@
 #include <fc/variant_object.hpp>
 #include <fc/shared_ptr.hpp>
 #include <memory>
+#include <type_traits>
 
 #include <boost/preprocessor/seq/for_each.hpp>
 #include <boost/preprocessor/stringize.hpp>
@@ -23,6 +24,7 @@ namespace fc
    { 
        class log_context_impl; 
        class log_message_impl; 
+       template<typename T, typename Enable = void> struct log_arg;
    }
 
    /**
@@ -59,6 +61,9 @@ namespace fc
     *  @brief provides information about where and when a log message was generated.
     *  @ingroup AthenaSerializable
     *
+    *  @note the file and method names given to the constructor are not copied, they must
+    *  outlive the context, as the literals passed by FC_LOG_CONTEXT do.
+    *
     *  @see FC_LOG_CONTEXT
     */
    class log_context 
@@ -109,6 +114,11 @@ namespace fc
     *  }
     *  @endcode
     *
+    *  Messages built by FC_LOG_MESSAGE keep their arguments as given: numbers and
+    *  strings are copied into a buffer allocated with the message, other types are
+    *  converted to variants.  The text is only formatted by get_message(), which the
+    *  appenders call, and the arguments are only turned into an object by get_data().
+    *
     *  @see FC_LOG_MESSAGE
     */
    class log_message
@@ -119,21 +129,115 @@ namespace fc
           *  @param ctx - generally provided using the FC_LOG_CONTEXT(LEVEL) macro 
           */
          log_message( log_context ctx, std::string format, variant_object args = variant_object() );
+         /**
+          *  Starts a message whose arguments are added with operator(), the format is copied.
+          */
+         log_message( log_context ctx, const char* format );
          ~log_message();
 
          log_message( const variant& v, uint32_t max_depth );
          variant        to_variant(uint32_t max_depth)const;
-                              
-         string         get_message()const;
+
+         /** adds the argument @p name, only while the message is being built */
+         template<typename T>
+         log_message& operator()( boost::string_view name, const T& value ) &
+         {
+            detail::log_arg<T>::add( *this, name, value );
+            return *this;
+         }
+         template<typename T>
+         log_message&& operator()( boost::string_view name, const T& value ) &&
+         {
+            detail::log_arg<T>::add( *this, name, value );
+            return std::move(*this);
+         }
+
+         /** the format with ${keys} replaced by the arguments, objects and arrays as JSON */
+         string         get_message( uint32_t max_object_depth = 200 )const;
                               
          log_context    get_context()const;
          string         get_format()const;
          variant_object get_data()const;
 
       private:
+         template<typename T, typename Enable> friend struct detail::log_arg;
+
+         void add_int( boost::string_view name, int64_t value );
+         void add_uint( boost::string_view name, uint64_t value );
+         void add_double( boost::string_view name, double value );
+         void add_bool( boost::string_view name, bool value );
+         void add_string( boost::string_view name, boost::string_view value );
+         void add_variant( boost::string_view name, variant value );
+
          std::shared_ptr<detail::log_message_impl> my;
    };
 
+   namespace detail
+   {
+      template<typename T>
+      struct is_log_char : std::integral_constant<bool, sizeof(T) == 1 || std::is_same<T,bool>::value ||
+                                                        std::is_same<T,wchar_t>::value || std::is_same<T,char16_t>::value ||
+                                                        std::is_same<T,char32_t>::value> {};
+
+      /** how a value of type T is kept by a log_message, anything not special cased as a variant */
+      template<typename T, typename Enable>
+      struct log_arg
+      {
+         static void add( log_message& m, boost::string_view name, const T& value )
+         {
+            m.add_variant( name, fc::variant( value, FC_MAX_LOG_OBJECT_DEPTH ) );
+         }
+      };
+
+      template<typename T>
+      struct log_arg<T, typename std::enable_if<std::is_integral<T>::value && !is_log_char<T>::value && std::is_signed<T>::value>::type>
+      {
+         static void add( log_message& m, boost::string_view name, T value ) { m.add_int( name, value ); }
+      };
+
+      template<typename T>
+      struct log_arg<T, typename std::enable_if<std::is_integral<T>::value && !is_log_char<T>::value && std::is_unsigned<T>::value>::type>
+      {
+         static void add( log_message& m, boost::string_view name, T value ) { m.add_uint( name, value ); }
+      };
+
+      template<typename T>
+      struct log_arg<T, typename std::enable_if<std::is_same<T,double>::value || std::is_same<T,float>::value>::type>
+      {
+         static void add( log_message& m, boost::string_view name, T value ) { m.add_double( name, value ); }
+      };
+
+      template<>
+      struct log_arg<bool>
+      {
+         static void add( log_message& m, boost::string_view name, bool value ) { m.add_bool( name, value ); }
+      };
+
+      template<>
+      struct log_arg<std::string>
+      {
+         static void add( log_message& m, boost::string_view name, const std::string& value ) { m.add_string( name, value ); }
+      };
+
+      template<>
+      struct log_arg<const char*>
+      {
+         static void add( log_message& m, boost::string_view name, const char* value )
+         {
+            if( value )
+               m.add_string( name, value );
+            else
+               m.add_variant( name, variant() );
+         }
+      };
+
+      template<>
+      struct log_arg<char*> : log_arg<const char*> {};
+
+      template<size_t N>
+      struct log_arg<char[N]> : log_arg<const char*> {};
+   }
+
    void    to_variant( const log_message& l, variant& v, uint32_t max_depth );
    void    from_variant( const variant& l, log_message& c, uint32_t max_depth );
 
@@ -166,14 +270,14 @@ FC_REFLECT_TYPENAME( fc::log_message );
  * @param FORMAT A const char* string containing zero or more references to keys as "${key}"
  * @param ...  A set of key/value pairs denoted as ("key",val)("key2",val2)...
  */
-#define FC_LOG_MESSAGE_GENERATE_PARAMETER_NAME(VALUE) BOOST_PP_LPAREN() BOOST_PP_STRINGIZE(VALUE), fc::variant(VALUE, FC_MAX_LOG_OBJECT_DEPTH) BOOST_PP_RPAREN()
-#define FC_LOG_MESSAGE_DONT_GENERATE_PARAMETER_NAME(NAME, VALUE) BOOST_PP_LPAREN() NAME, fc::variant(VALUE, FC_MAX_LOG_OBJECT_DEPTH) BOOST_PP_RPAREN()
+#define FC_LOG_MESSAGE_GENERATE_PARAMETER_NAME(VALUE) BOOST_PP_LPAREN() BOOST_PP_STRINGIZE(VALUE), VALUE BOOST_PP_RPAREN()
+#define FC_LOG_MESSAGE_DONT_GENERATE_PARAMETER_NAME(NAME, VALUE) BOOST_PP_LPAREN() NAME, VALUE BOOST_PP_RPAREN()
 #define FC_LOG_MESSAGE_GENERATE_PARAMETER_NAMES_IF_NEEDED(r, data, PARAMETER_AND_MAYBE_NAME) BOOST_PP_IF(BOOST_PP_EQUAL(BOOST_PP_VARIADIC_SIZE PARAMETER_AND_MAYBE_NAME,1),FC_LOG_MESSAGE_GENERATE_PARAMETER_NAME,FC_LOG_MESSAGE_DONT_GENERATE_PARAMETER_NAME)PARAMETER_AND_MAYBE_NAME
 
 #define FC_LOG_MESSAGE_STRING_ONLY(LOG_LEVEL, FORMAT) \
-   fc::log_message(FC_LOG_CONTEXT(LOG_LEVEL), FORMAT, fc::variant_object())
+   fc::log_message(FC_LOG_CONTEXT(LOG_LEVEL), FORMAT)
 #define FC_LOG_MESSAGE_WITH_SUBSTITUTIONS(LOG_LEVEL, FORMAT, ...) \
-   fc::log_message(FC_LOG_CONTEXT(LOG_LEVEL), FORMAT, fc::mutable_variant_object() BOOST_PP_SEQ_FOR_EACH(FC_LOG_MESSAGE_GENERATE_PARAMETER_NAMES_IF_NEEDED, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__)))
+   fc::log_message(FC_LOG_CONTEXT(LOG_LEVEL), FORMAT) BOOST_PP_SEQ_FOR_EACH(FC_LOG_MESSAGE_GENERATE_PARAMETER_NAMES_IF_NEEDED, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__))
 
 #define FC_LOG_MESSAGE(LOG_LEVEL, ...) \
    BOOST_PP_EXPAND(BOOST_PP_IF(BOOST_PP_EQUAL(BOOST_PP_VARIADIC_SIZE(__VA_ARGS__),1),FC_LOG_MESSAGE_STRING_ONLY,FC_LOG_MESSAGE_WITH_SUBSTITUTIONS)(LOG_LEVEL,__VA_ARGS__))
@@ -1,6 +1,7 @@
 #pragma once
 #include <fc/vector.hpp>
 #include <fc/string.hpp>
+#include <fc/time.hpp>
 #include <memory>
 
 namespace fc { 
@@ -44,6 +45,7 @@ namespace fc {
         fc::string              method;
         fc::string              domain;
         fc::string              path;
+        fc::string              version; ///< e.g. HTTP/1.1
         std::vector<header>     headers;
         std::vector<char>       body;
      };
@@ -67,6 +69,11 @@ namespace fc {
          fc::tcp_socket& get_socket()const;
      
          http::request    read_request()const;
+         /**
+          *  Waits up to @p timeout for the next request on a kept-alive connection.
+          *  @return false if the peer closed the connection, or it timed out and was closed
+          */
+         bool             wait_for_request( const fc::microseconds& timeout )const;
 
          class impl;
        private:
@@ -11,6 +11,8 @@ namespace fc { namespace http {
    *  connections and then calls a user provided callback
    *  function for every http request.
    *
+   *  Connections are kept alive unless the client asks otherwise, and pipelined requests
+   *  are answered in the order they arrived.
    */
   class server 
   {
@@ -48,6 +50,11 @@ namespace fc { namespace http {
       void listen( const fc::ip::endpoint& p );
       fc::ip::endpoint get_local_endpoint() const;
 
+      /** closes kept-alive connections that do not send a request for @p timeout, 60s by default */
+      void set_idle_timeout( const fc::microseconds& timeout );
+      /** connections beyond @p max_connections wait in the listen backlog, 0 (the default) for no limit */
+      void set_max_connections( uint32_t max_connections );
+
       /**
        *  Set the callback to be called for every http request made.
        */
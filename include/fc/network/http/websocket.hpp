@@ -2,6 +2,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include <fc/any.hpp>
 #include <fc/network/ip.hpp>
 #include <fc/signals.hpp>
@@ -19,6 +20,8 @@ namespace fc { namespace http {
       public:
          virtual ~websocket_connection(){}
          virtual void send_message( const std::string& message ) = 0;
+         /** sends @p message in a binary frame, connections without binary frames send it as text */
+         virtual void send_binary_message( const std::string& message ) { send_message( message ); }
          virtual void close( int64_t code, const std::string& reason  ){};
          void on_message( const std::string& message ) { _on_message(message); }
          string on_http( const std::string& message ) { return _on_http(message); }
@@ -30,6 +33,8 @@ namespace fc { namespace http {
          fc::any& get_session_data() { return _session_data; }
 
          virtual std::string get_request_header(const std::string& key) = 0;
+         /** @return the subprotocol agreed on in the handshake, empty if there is none */
+         virtual std::string get_subprotocol()const { return std::string(); }
 
          fc::signal<void()> closed;
       private:
@@ -44,10 +49,19 @@ namespace fc { namespace http {
    class websocket_server
    {
       public:
+         /** handles every connection on the calling thread */
          websocket_server();
+         /**
+          *  Spreads connections over a pool of @p thread_count threads.  Each connection
+          *  stays on one of them, which runs its on_connection handler, its messages in
+          *  the order they arrived and its closed signal.
+          */
+         explicit websocket_server( uint32_t thread_count );
          ~websocket_server();
 
          void on_connection( const on_connection_handler& handler);
+         /** accepts @p name when a client asks for it, the first supported one a client names wins */
+         void add_subprotocol( const std::string& name );
          void listen( uint16_t port );
          void listen( const fc::ip::endpoint& ep );
          uint16_t get_listening_port();
@@ -67,6 +81,7 @@ namespace fc { namespace http {
          ~websocket_tls_server();
 
          void on_connection( const on_connection_handler& handler);
+         void add_subprotocol( const std::string& name );
          void listen( uint16_t port );
          void listen( const fc::ip::endpoint& ep );
          void start_accept();
@@ -82,8 +97,11 @@ namespace fc { namespace http {
          websocket_client( const std::string& ca_filename = "_default" );
          ~websocket_client();
 
-         websocket_connection_ptr connect( const std::string& uri );
-         websocket_connection_ptr secure_connect( const std::string& uri );
+         /** @param subprotocols offered to the server in order of preference */
+         websocket_connection_ptr connect( const std::string& uri,
+                                           const std::vector<std::string>& subprotocols = std::vector<std::string>() );
+         websocket_connection_ptr secure_connect( const std::string& uri,
+                                                  const std::vector<std::string>& subprotocols = std::vector<std::string>() );
       private:
          std::unique_ptr<detail::websocket_client_impl> my;
          std::unique_ptr<detail::websocket_tls_client_impl> smy;
@@ -94,7 +112,8 @@ namespace fc { namespace http {
          websocket_tls_client( const std::string& ca_filename = "_default" );
          ~websocket_tls_client();
 
-         websocket_connection_ptr connect( const std::string& uri );
+         websocket_connection_ptr connect( const std::string& uri,
+                                           const std::vector<std::string>& subprotocols = std::vector<std::string>() );
       private:
          std::unique_ptr<detail::websocket_tls_client_impl> my;
    };
@@ -23,6 +23,22 @@ namespace fc {
       fc::ip::endpoint remote_endpoint() const;
       fc::ip::endpoint local_endpoint() const;
 
+      /**
+       *  Reads and writes first try the non-blocking socket directly from the calling task,
+       *  and only wait for the io service thread when that would block.  Off by default.
+       */
+      void set_speculative_io( bool enable = true );
+
+      /** counts of the reads and writes, and of those done without waiting */
+      struct io_stats
+      {
+         uint64_t reads = 0;
+         uint64_t immediate_reads = 0;
+         uint64_t writes = 0;
+         uint64_t immediate_writes = 0;
+      };
+      io_stats get_io_stats()const;
+
       using istream::get;
       void get( char& c )
       {
@@ -41,6 +57,8 @@ namespace fc {
       /// @{
       virtual size_t   writesome( const char* buffer, size_t len );
       virtual size_t   writesome(const std::shared_ptr<const char>& buffer, size_t len, size_t offset);
+      /** writes as many of the slices as the socket takes in one gather write */
+      virtual size_t   writesome(const const_buffer_chain& chain, size_t offset);
       virtual void     flush();
       virtual void     close();
       /// @}
@@ -52,9 +70,9 @@ namespace fc {
       friend class tcp_server;
       class impl;
       #ifdef _WIN64
-      fc::fwd<impl,0x81> my;
+      fc::fwd<impl,0xa9> my;
       #else
-      fc::fwd<impl,0x54> my;
+      fc::fwd<impl,0x7c> my;
       #endif
   };
   typedef std::shared_ptr<tcp_socket> tcp_socket_ptr;
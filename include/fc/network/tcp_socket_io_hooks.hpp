@@ -1,5 +1,7 @@
 #include <boost/asio.hpp>
+#include <fc/io/iostream.hpp>
 #include <memory>
+#include <vector>
 
 namespace fc
 {
@@ -11,5 +13,24 @@ namespace fc
     virtual size_t readsome(boost::asio::ip::tcp::socket& socket, const std::shared_ptr<char>& buffer, size_t length, size_t offset) = 0;
     virtual size_t writesome(boost::asio::ip::tcp::socket& socket, const char* buffer, size_t length) = 0;
     virtual size_t writesome(boost::asio::ip::tcp::socket& socket, const std::shared_ptr<const char>& buffer, size_t length, size_t offset) = 0;
+    /** copies the chain from @p offset into one buffer, override it to write the slices in place */
+    virtual size_t writesome(boost::asio::ip::tcp::socket& socket, const const_buffer_chain& chain, size_t offset)
+    {
+      std::vector<char> gathered;
+      for (const auto& slice : chain)
+      {
+        if (offset >= slice.size)
+        {
+          offset -= slice.size;
+          continue;
+        }
+        const char* begin = slice.data.get() + slice.offset + offset;
+        gathered.insert(gathered.end(), begin, begin + slice.size - offset);
+        offset = 0;
+      }
+      if (gathered.empty())
+        return 0;
+      return writesome(socket, gathered.data(), gathered.size());
+    }
   };
 } // namesapce fc
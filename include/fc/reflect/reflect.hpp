@@ -27,7 +27,8 @@ namespace fc {
  *  @tparam T - the type that will be visited.
  *
  *  The @ref FC_REFLECT(TYPE,MEMBERS) or FC_STATIC_REFLECT_DERIVED(TYPE,BASES,MEMBERS) macro is used to specialize this
- *  class for your type.
+ *  class for your type.  For classes it also defines base_types and member_types, the
+ *  fc::type_list of the bases and members in the order they are visited.
  */
 template<typename T>
 struct reflector{
@@ -63,6 +64,13 @@ struct reflector{
     #endif // DOXYGEN
 };
 
+/** a list of types, such as reflector<T>::base_types and reflector<T>::member_types */
+template<typename... Types> struct type_list {};
+
+namespace detail {
+   template<typename First, typename... Rest> struct drop_first { typedef type_list<Rest...> type; };
+}
+
 void throw_bad_enum_cast( int64_t i, const char* e );
 void throw_bad_enum_cast( const char* k, const char* e );
 } // namespace fc
@@ -94,6 +102,12 @@ void throw_bad_enum_cast( const char* k, const char* e );
 #define FC_REFLECT_MEMBER_COUNT( r, OP, elem ) \
   OP 1
 
+#define FC_REFLECT_BASE_TYPE( r, data, elem ) \
+  , elem
+
+#define FC_REFLECT_MEMBER_TYPE( r, data, elem ) \
+  , decltype(((type*)nullptr)->elem)
+
 #define FC_REFLECT_DERIVED_IMPL_INLINE( TYPE, INHERITS, MEMBERS ) \
 template<typename Visitor>\
 static inline void visit( const Visitor& v ) { \
@@ -210,6 +224,8 @@ template<> struct reflector<TYPE> {\
       local_member_count = 0  BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_MEMBER_COUNT, +, MEMBERS ),\
       total_member_count = local_member_count BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_BASE_MEMBER_COUNT, +, INHERITS )\
     }; \
+    typedef fc::detail::drop_first<void BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_BASE_TYPE, _, INHERITS )>::type base_types; \
+    typedef fc::detail::drop_first<void BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_MEMBER_TYPE, _, MEMBERS )>::type member_types; \
     FC_REFLECT_DERIVED_IMPL_INLINE( TYPE, INHERITS, MEMBERS ) \
 }; }
 #define FC_REFLECT_DERIVED_TEMPLATE( TEMPLATE_ARGS, TYPE, INHERITS, MEMBERS ) \
@@ -223,6 +239,8 @@ template<BOOST_PP_SEQ_ENUM(TEMPLATE_ARGS)> struct reflector<TYPE> {\
       local_member_count = 0  BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_MEMBER_COUNT, +, MEMBERS ),\
       total_member_count = local_member_count BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_BASE_MEMBER_COUNT, +, INHERITS )\
     }; \
+    typedef typename fc::detail::drop_first<void BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_BASE_TYPE, _, INHERITS )>::type base_types; \
+    typedef typename fc::detail::drop_first<void BOOST_PP_SEQ_FOR_EACH( FC_REFLECT_MEMBER_TYPE, _, MEMBERS )>::type member_types; \
     FC_REFLECT_DERIVED_IMPL_INLINE( TYPE, INHERITS, MEMBERS ) \
 }; }
 
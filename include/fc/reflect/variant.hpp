@@ -2,12 +2,34 @@
 #include <fc/reflect/reflect.hpp>
 #include <fc/variant_object.hpp>
 
+#include <type_traits>
+
 namespace fc
 {
+   namespace detail {
+      /**
+       *  Stands in for a T when json::pack() looks for conversions of T's own: the templates
+       *  below refuse it, so a call with it only resolves if T has other overloads.
+       */
+      template<typename T, bool Derive = std::is_class<T>::value && !std::is_final<T>::value>
+      struct conversion_probe : T {};
+      template<typename T>
+      struct conversion_probe<T,false>
+      {
+         operator const T&()const;
+         operator T&();
+      };
+
+      template<typename T> struct is_conversion_probe : std::false_type {};
+      template<typename T, bool D> struct is_conversion_probe< conversion_probe<T,D> > : std::true_type {};
+   }
+
    template<typename T>
-   void to_variant( const T& o, variant& v, uint32_t max_depth );
+   typename std::enable_if< !detail::is_conversion_probe<T>::value >::type
+   to_variant( const T& o, variant& v, uint32_t max_depth );
    template<typename T>
-   void from_variant( const variant& v, T& o, uint32_t max_depth );
+   typename std::enable_if< !detail::is_conversion_probe<T>::value >::type
+   from_variant( const variant& v, T& o, uint32_t max_depth );
 
 
    template<typename T>
@@ -101,13 +123,15 @@ namespace fc
 
 
    template<typename T>
-   void to_variant( const T& o, variant& v, uint32_t max_depth )
+   typename std::enable_if< !detail::is_conversion_probe<T>::value >::type
+   to_variant( const T& o, variant& v, uint32_t max_depth )
    {
       if_enum<typename fc::reflector<T>::is_enum>::to_variant( o, v, max_depth );
    }
 
    template<typename T>
-   void from_variant( const variant& v, T& o, uint32_t max_depth )
+   typename std::enable_if< !detail::is_conversion_probe<T>::value >::type
+   from_variant( const variant& v, T& o, uint32_t max_depth )
    {
       if_enum<typename fc::reflector<T>::is_enum>::from_variant( v, o, max_depth );
    }
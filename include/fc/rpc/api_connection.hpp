@@ -228,12 +228,25 @@ namespace fc {
          virtual variant send_call( api_id_type api_id, string method_name, variants args = variants() ) = 0;
          virtual variant send_callback( uint64_t callback_id, variants args = variants() ) = 0;
          virtual void    send_notice( uint64_t callback_id, variants args = variants() ) = 0;
+         /**
+          *  calls the method with index @p method_id in the remote api, for connections which
+          *  can name methods by index; the others send_call() it by name
+          */
+         virtual variant send_method_call( api_id_type api_id, uint32_t method_id, string method_name, variants args )
+         {
+            return send_call( api_id, std::move(method_name), std::move(args) );
+         }
 
          variant receive_call( api_id_type api_id, const string& method_name, const variants& args = variants() )const
          {
             FC_ASSERT( _local_apis.size() > api_id );
             return _local_apis[api_id]->call( method_name, args );
          }
+         variant receive_method_call( api_id_type api_id, uint32_t method_id, const variants& args = variants() )const
+         {
+            FC_ASSERT( _local_apis.size() > api_id );
+            return _local_apis[api_id]->call( method_id, args );
+         }
          variant receive_callback( uint64_t callback_id,  const variants& args = variants() )const
          {
             FC_ASSERT( _local_callbacks.size() > callback_id );
@@ -326,13 +339,15 @@ namespace fc {
                return con->register_callback( v ); 
             }
 
+            // methods are visited in declaration order, as generic_api numbers them
             template<typename Result, typename... Args>
             void operator()( const char* name, std::function<Result(Args...)>& memb )const 
             {
                 auto con   = _connection;
                 auto api_id = _api_id;
-                memb = [con,api_id,name]( Args... args ) {
-                    auto var_result = con->send_call( api_id, name, { convert_callbacks(con,args)...} );
+                auto method_id = _next_method_id++;
+                memb = [con,api_id,method_id,name]( Args... args ) {
+                    auto var_result = con->send_method_call( api_id, method_id, name, { convert_callbacks(con,args)...} );
                     return from_variant( var_result, (Result*)nullptr, con, con->_max_conversion_depth );
                 };
             }
@@ -341,10 +356,13 @@ namespace fc {
             {
                 auto con   = _connection;
                 auto api_id = _api_id;
-                memb = [con,api_id,name]( Args... args ) {
-                   con->send_call( api_id, name, { convert_callbacks(con,args)...} );
+                auto method_id = _next_method_id++;
+                memb = [con,api_id,method_id,name]( Args... args ) {
+                   con->send_method_call( api_id, method_id, name, { convert_callbacks(con,args)...} );
                 };
             }
+
+            mutable uint32_t _next_method_id = 0;
          };
    };
 
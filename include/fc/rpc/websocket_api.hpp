@@ -2,11 +2,44 @@
 #include <fc/rpc/api_connection.hpp>
 #include <fc/rpc/state.hpp>
 #include <fc/network/http/websocket.hpp>
+#include <fc/thread/mutex.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/varint.hpp>
 #include <fc/reflect/variant.hpp>
+#include <fc/static_variant.hpp>
 
 namespace fc { namespace rpc {
 
+   /**
+    *  Websocket subprotocol in which requests and responses are binary frames packed with
+    *  fc::raw, calls name their method by its index in the api instead of its name.
+    */
+   const char* const websocket_binary_subprotocol = "fc-rpc-binary";
+
+   struct binary_request
+   {
+      enum kind_type : uint8_t { call = 0, callback = 1, notice = 2 };
+
+      optional<uint64_t>  id;
+      uint8_t             kind;
+      fc::unsigned_int    target; ///< the api of calls, the callback of callbacks and notices
+      fc::unsigned_int    method; ///< index of the called method in its api
+      variants            params;
+   };
+
+   struct binary_response
+   {
+      uint64_t                id = 0;
+      optional<fc::variant>   result;
+      optional<error_object>  error;
+   };
+
+   typedef fc::static_variant<binary_request, binary_response> binary_message;
+
+   /**
+    *  Speaks JSON-RPC, or the binary protocol if websocket_binary_subprotocol was agreed on
+    *  in the handshake of @p c.
+    */
    class websocket_api_connection : public api_connection
    {
       public:
@@ -23,14 +56,39 @@ namespace fc { namespace rpc {
          virtual void send_notice(
             uint64_t callback_id,
             variants args = variants() ) override;
+         virtual variant send_method_call(
+            api_id_type api_id,
+            uint32_t method_id,
+            string method_name,
+            variants args ) override;
+
+         /**
+          *  Limits how many calls of a JSON-RPC batch run concurrently on this connection,
+          *  the remaining calls start as earlier ones complete.
+          */
+         void set_max_batch_in_flight( uint32_t count );
 
       protected:
          std::string on_message(
             const std::string& message,
             bool send_message = true );
 
+         /** @return the reply to a single request, null for notices and responses */
+         variant handle_message( const variant& message );
+         /** @return the replies to a batch in request order, empty if none were requested */
+         variants handle_batch( const variants& messages );
+
+         std::string on_binary_message( const std::string& message, bool send_message );
+         variant send_binary_request( binary_request request );
+
          std::shared_ptr<fc::http::websocket_connection>  _connection;
          fc::rpc::state                   _rpc_state;
+         bool                             _binary = false;
+         uint32_t                         _max_batch_in_flight = 16;
+         fc::mutex                        _batch_mutex;
    };
 
 } } // namespace fc::rpc
+
+FC_REFLECT( fc::rpc::binary_request, (id)(kind)(target)(method)(params) )
+FC_REFLECT( fc::rpc::binary_response, (id)(result)(error) )
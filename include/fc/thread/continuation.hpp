@@ -0,0 +1,195 @@
+#pragma once
+#include <fc/thread/thread.hpp>
+#include <boost/atomic.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+#include <memory>
+#include <vector>
+
+namespace fc {
+
+  namespace detail {
+     /** calls f(args...) and completes p with its result or with what it threw */
+     template<typename R>
+     struct continuation_runner {
+        template<typename Functor, typename... Args>
+        static void run( promise<R>& p, Functor& f, Args&... args ) { p.set_value( f( args... ) ); }
+     };
+     template<>
+     struct continuation_runner<void> {
+        template<typename Functor, typename... Args>
+        static void run( promise<void>& p, Functor& f, Args&... args ) { f( args... ); p.set_value(); }
+     };
+
+     template<typename R, typename Functor, typename... Args>
+     void run_continuation( promise<R>& p, Functor& f, Args&... args )
+     {
+        try
+        {
+           continuation_runner<R>::run( p, f, args... );
+        }
+        catch( const exception& e )
+        {
+           p.set_exception( e.dynamic_copy_exception() );
+        }
+        catch( ... )
+        {
+           p.set_exception( std::make_shared<unhandled_exception>( FC_LOG_MESSAGE( warn, "unhandled exception: ${diagnostic}", ("diagnostic",boost::current_exception_diagnostic_information()) ) ) );
+        }
+     }
+
+     /** calls handler(exception_ptr) once @p f is ready, whatever its value type */
+     template<typename T, typename Handler>
+     void on_ready( future<T> f, const Handler& handler )
+     {
+        f.on_complete( [handler]( const T&, const exception_ptr& e ) { handler( e ); } );
+     }
+     template<typename Handler>
+     void on_ready( future<void> f, const Handler& handler )
+     {
+        f.on_complete( [handler]( const exception_ptr& e ) { handler( e ); } );
+     }
+
+     /** shared by the handlers of one when_all() or when_any() call */
+     template<typename R>
+     struct combined_state
+     {
+        combined_state( size_t count, const char* desc )
+        :remaining( count ), settled( false ), result( new promise<R>( desc ) ) {}
+
+        /** @return true for exactly one caller, which then completes result */
+        bool settle() { return !settled.exchange( true ); }
+
+        boost::atomic<size_t>      remaining;
+        boost::atomic<bool>        settled;
+        typename promise<R>::ptr   result;
+     };
+  }
+
+  template<typename T>
+  template<typename Functor>
+  auto future<T>::then( Functor&& f, const char* desc ) const
+     -> future<decltype(f(std::declval<const T&>()))>
+  {
+     typedef decltype(f(std::declval<const T&>())) Result;
+     typedef typename fc::deduce<Functor>::type FunctorType;
+     typename promise<Result>::ptr result( new promise<Result>( desc ) );
+     fc::thread* target = &fc::thread::current();
+     FunctorType func( fc::forward<Functor>(f) );
+     m_prom->on_complete( [result,target,func,desc]( const T& value, const exception_ptr& e ) {
+        if( e )
+        {
+           result->set_exception( e );
+           return;
+        }
+        T arg( value );
+        target->async( [result,func,arg]() mutable { detail::run_continuation( *result, func, arg ); }, desc );
+     } );
+     return future<Result>( result );
+  }
+
+  template<typename Functor>
+  auto future<void>::then( Functor&& f, const char* desc ) const
+     -> future<decltype(f())>
+  {
+     typedef decltype(f()) Result;
+     typedef typename fc::deduce<Functor>::type FunctorType;
+     typename promise<Result>::ptr result( new promise<Result>( desc ) );
+     fc::thread* target = &fc::thread::current();
+     FunctorType func( fc::forward<Functor>(f) );
+     m_prom->on_complete( [result,target,func,desc]( const exception_ptr& e ) {
+        if( e )
+        {
+           result->set_exception( e );
+           return;
+        }
+        target->async( [result,func]() mutable { detail::run_continuation( *result, func ); }, desc );
+     } );
+     return future<Result>( result );
+  }
+
+  /**
+   *  @return a future for the values of all @p futures, in the same order, that is ready
+   *  once all of them are.  If any of them fails, it fails with the first exception.
+   *
+   *  Nothing waits on a fiber in the meantime; the last future to complete sets the result.
+   */
+  template<typename T>
+  future<std::vector<T>> when_all( const std::vector<future<T>>& futures, const char* desc FC_TASK_NAME_DEFAULT_ARG )
+  {
+     struct state : detail::combined_state<std::vector<T>>
+     {
+        state( size_t count, const char* desc )
+        :detail::combined_state<std::vector<T>>( count, desc ), values( count ) {}
+        std::vector<optional<T>> values;
+     };
+     std::shared_ptr<state> s = std::make_shared<state>( futures.size(), desc );
+     if( futures.empty() )
+        s->result->set_value( std::vector<T>() );
+
+     for( size_t i = 0; i < futures.size(); ++i )
+     {
+        future<T>( futures[i] ).on_complete( [s,i]( const T& value, const exception_ptr& e ) {
+           if( e )
+           {
+              if( s->settle() )
+                 s->result->set_exception( e );
+              return;
+           }
+           s->values[i] = value;
+           if( s->remaining.fetch_sub( 1, boost::memory_order_acq_rel ) == 1 && s->settle() )
+           {
+              std::vector<T> values;
+              values.reserve( s->values.size() );
+              for( optional<T>& v : s->values )
+                 values.push_back( fc::move( *v ) );
+              s->result->set_value( fc::move( values ) );
+           }
+        } );
+     }
+     return future<std::vector<T>>( s->result );
+  }
+
+  /** @see when_all(), for futures without a value */
+  inline future<void> when_all( const std::vector<future<void>>& futures, const char* desc FC_TASK_NAME_DEFAULT_ARG )
+  {
+     std::shared_ptr<detail::combined_state<void>> s = std::make_shared<detail::combined_state<void>>( futures.size(), desc );
+     if( futures.empty() )
+        s->result->set_value();
+
+     for( const future<void>& f : futures )
+     {
+        detail::on_ready( f, [s]( const exception_ptr& e ) {
+           if( e )
+           {
+              if( s->settle() )
+                 s->result->set_exception( e );
+           }
+           else if( s->remaining.fetch_sub( 1, boost::memory_order_acq_rel ) == 1 && s->settle() )
+              s->result->set_value();
+        } );
+     }
+     return future<void>( s->result );
+  }
+
+  /**
+   *  @return a future for the index of the first of @p futures to become ready, whether it
+   *  holds a value or an exception.  Unlike fc::wait_any() no fiber blocks on the futures.
+   *
+   *  @pre !futures.empty()
+   */
+  template<typename T>
+  future<size_t> when_any( const std::vector<future<T>>& futures, const char* desc FC_TASK_NAME_DEFAULT_ARG )
+  {
+     FC_ASSERT( !futures.empty(), "when_any() needs at least one future" );
+     std::shared_ptr<detail::combined_state<size_t>> s = std::make_shared<detail::combined_state<size_t>>( futures.size(), desc );
+     for( size_t i = 0; i < futures.size(); ++i )
+     {
+        detail::on_ready( futures[i], [s,i]( const exception_ptr& ) {
+           if( s->settle() )
+              s->result->set_value( i );
+        } );
+     }
+     return future<size_t>( s->result );
+  }
+
+} // namespace fc
@@ -0,0 +1,147 @@
+#pragma once
+#include <fc/thread/thread.hpp>
+
+/**
+ *  Lets stackless C++20 coroutines wait for fc::future without blocking a fiber.
+ *
+ *  A coroutine returning fc::task_co<T> can <code>co_await</code> any fc::future; while it
+ *  is suspended only its frame is kept alive, not a fiber stack, and it is resumed as a
+ *  task on the fc::thread it was suspended on.  Only available when the compiler supports
+ *  coroutines, in which case FC_HAS_COROUTINES is defined.
+ */
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#define FC_HAS_COROUTINES 1
+
+namespace fc {
+
+  template<typename T> class task_co;
+
+  namespace detail {
+     /** posts the resumption of @p h to the ready queue of @p t */
+     inline void resume_coroutine( fc::thread& t, std::coroutine_handle<> h, const char* desc )
+     {
+        t.async( [h]{ h.resume(); }, desc );
+     }
+
+     template<typename T>
+     struct future_awaiter
+     {
+        future<T> f;
+
+        bool await_ready()const { return f.ready(); }
+        void await_suspend( std::coroutine_handle<> h )
+        {
+           fc::thread* t = &fc::thread::current();
+           on_ready( f, [t,h]( const exception_ptr& ) { resume_coroutine( *t, h, "co_await" ); } );
+        }
+        /// never blocks, the future is ready; rethrows its exception
+        auto await_resume() -> decltype(f.wait()) { return f.wait(); }
+     };
+
+     struct resume_on_awaiter
+     {
+        fc::thread* target;
+
+        bool await_ready()const { return &fc::thread::current() == target; }
+        void await_suspend( std::coroutine_handle<> h ) { resume_coroutine( *target, h, "resume_on" ); }
+        void await_resume()const {}
+     };
+
+     template<typename T>
+     struct task_co_promise_base
+     {
+        task_co_promise_base() : result( new promise<T>( "task_co" ) ) {}
+
+        /// runs eagerly on the caller until the first co_await, like a function call
+        std::suspend_never initial_suspend()noexcept { return {}; }
+        /// the frame is freed as soon as result is set
+        std::suspend_never final_suspend()noexcept { return {}; }
+
+        void unhandled_exception()
+        {
+           try
+           {
+              throw;
+           }
+           catch( const exception& e )
+           {
+              result->set_exception( e.dynamic_copy_exception() );
+           }
+           catch( ... )
+           {
+              result->set_exception( std::make_shared<fc::unhandled_exception>( FC_LOG_MESSAGE( warn, "unhandled exception: ${diagnostic}", ("diagnostic",boost::current_exception_diagnostic_information()) ) ) );
+           }
+        }
+
+        // coroutine frames are allocated like tasks
+        FC_USE_TASK_ALLOCATOR
+
+        typename promise<T>::ptr result;
+     };
+
+     template<typename T>
+     struct task_co_promise : task_co_promise_base<T>
+     {
+        task_co<T> get_return_object();
+        void return_value( T v ) { this->result->set_value( fc::move(v) ); }
+     };
+
+     template<>
+     struct task_co_promise<void> : task_co_promise_base<void>
+     {
+        task_co<void> get_return_object();
+        void return_void() { result->set_value(); }
+     };
+  }
+
+  /**
+   *  @brief return type of coroutines that co_await fc futures
+   *
+   *  A task_co is the future of the coroutine's result, so it can be waited on, chained
+   *  with then(), combined with when_all() or co_awaited by another coroutine.
+   *
+   *  A suspended coroutine resumes on the thread it was suspended on; if that thread quits
+   *  first, it is never resumed.  Calling wait() inside a coroutine blocks the fiber
+   *  running it, co_await the future instead.
+   */
+  template<typename T>
+  class task_co : public future<T>
+  {
+     public:
+        typedef detail::task_co_promise<T> promise_type;
+
+        task_co( const typename promise<T>::ptr& p ) : future<T>( p ) {}
+  };
+
+  template<typename T>
+  task_co<T> detail::task_co_promise<T>::get_return_object() { return task_co<T>( this->result ); }
+  inline task_co<void> detail::task_co_promise<void>::get_return_object() { return task_co<void>( result ); }
+
+  /** suspends the calling coroutine until @p f is ready, @return the value of @p f */
+  template<typename T>
+  detail::future_awaiter<T> operator co_await( const future<T>& f )
+  {
+     return detail::future_awaiter<T>{ f };
+  }
+
+  /** <code>co_await resume_on(t)</code> moves the calling coroutine to thread @p t */
+  inline detail::resume_on_awaiter resume_on( fc::thread& t )
+  {
+     return detail::resume_on_awaiter{ &t };
+  }
+
+  /**
+   *  Like fc::thread::async() for coroutine functions: starts <code>f()</code> on thread
+   *  @p t and @return a future for the result of the coroutine it returns.
+   */
+  template<typename Functor>
+  auto co_async( fc::thread& t, Functor f ) -> decltype(f())
+  {
+     co_await resume_on( t );
+     co_return co_await f();
+  }
+
+} // namespace fc
+
+#endif // __cpp_impl_coroutine
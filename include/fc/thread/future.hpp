@@ -4,8 +4,11 @@
 #include <fc/shared_ptr.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/thread/spin_yield_lock.hpp>
+#include <fc/thread/task_allocator.hpp>
 #include <fc/optional.hpp>
 
+#include <utility>
+
 //#define FC_TASK_NAMES_ARE_MANDATORY 1
 #ifdef FC_TASK_NAMES_ARE_MANDATORY
 # define FC_TASK_NAME_DEFAULT_ARG
@@ -29,8 +32,13 @@ namespace fc {
   namespace detail {
      class completion_handler {
        public:
+          completion_handler():next(nullptr){}
           virtual ~completion_handler(){};
           virtual void on_complete( const void* v, const fc::exception_ptr& e ) = 0;
+
+          completion_handler* next; // handlers registered on the same promise, in order
+
+          FC_USE_TASK_ALLOCATOR
      };
      
      template<typename Functor, typename T>
@@ -63,6 +71,9 @@ namespace fc {
       typedef fc::shared_ptr<promise_base> ptr;
       promise_base(const char* desc FC_TASK_NAME_DEFAULT_ARG);
 
+      // promises and tasks are short lived and mostly small, see task_allocator
+      FC_USE_TASK_ALLOCATOR
+
       const char* get_desc()const;
                    
       virtual void cancel(const char* reason FC_CANCELATION_REASON_DEFAULT_ARG);
@@ -102,7 +113,8 @@ namespace fc {
     private:
 #endif
       const char*                 _desc;
-      detail::completion_handler* _compl;
+      const void*                 _value;  // what _set_value() was given, for handlers added later
+      detail::completion_handler* _compl;  // handlers waiting for the promise to become ready
   };
 
   template<typename T = void> 
@@ -244,11 +256,27 @@ namespace fc {
        * The given completion handler will be called from some
        * arbitrary thread and should not 'block'. Generally
        * it should post an event or start a new async operation.
+       *
+       * Every handler registered is called once; if the future is already
+       * ready the handler is called right away, on the calling thread.
        */
       template<typename CompletionHandler>
       void on_complete( CompletionHandler&& c ) {
         m_prom->on_complete( fc::forward<CompletionHandler>(c) );
       }
+
+      /**
+       * @pre valid()
+       *
+       * Runs <code>f(value)</code> as a task on the calling thread once this future is
+       * ready, without a fiber waiting for it.  If this future fails, f is not called
+       * and the returned future fails with the same exception.
+       *
+       * Defined in fc/thread/continuation.hpp, which fc/thread/thread.hpp includes.
+       */
+      template<typename Functor>
+      auto then( Functor&& f, const char* desc FC_TASK_NAME_DEFAULT_ARG ) const
+         -> future<decltype(f(std::declval<const T&>()))>;
     private:
       friend class thread;
       fc::shared_ptr<promise<T>> m_prom;
@@ -311,6 +339,11 @@ namespace fc {
         m_prom->on_complete( fc::forward<CompletionHandler>(c) );
       }
 
+      /// @see future<T>::then(), f takes no arguments
+      template<typename Functor>
+      auto then( Functor&& f, const char* desc FC_TASK_NAME_DEFAULT_ARG ) const
+         -> future<decltype(f())>;
+
     private:
       friend class thread;
       fc::shared_ptr<promise<void>> m_prom;
@@ -0,0 +1,77 @@
+#pragma once
+#include <fc/string.hpp>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+namespace fc {
+   namespace detail { class stack_pool_impl; }
+
+   /**
+    *  Size of the stack a task's fiber runs on, requested through fc::async().
+    *  Most tasks fit in the normal FC_CONTEXT_STACK_SIZE stack; short handlers that are
+    *  alive by the thousands can ask for a compact one, deeply recursive work for a large one.
+    */
+   enum class stack_class : uint8_t
+   {
+      compact = 0, ///< 64 KiB, not "small" which rpcndr.h defines as a macro
+      normal  = 1, ///< FC_CONTEXT_STACK_SIZE
+      large   = 2  ///< 8 MiB
+   };
+
+  /**
+   *  @brief process-wide cache of fiber stacks, one list per stack_class
+   *
+   *  Stacks are mapped with a guard page below them, so an overflow faults instead of
+   *  corrupting the neighbouring allocation, and pages are only committed when touched.
+   *  A stack that is returned to the cache gives its pages back to the OS, so idle
+   *  stacks cost address space but no memory.
+   *
+   *  With usage tracking enabled the pool also records the deepest stack use seen for
+   *  each task description, which shows which tasks could move to a smaller stack.
+   *  Tracking costs a few system calls per task and is off by default.  Tasks that run
+   *  on a thread's own stack rather than a fiber are not measured.
+   */
+  class stack_pool
+  {
+    public:
+      static stack_pool& instance();
+
+      /** @return the usable size of stacks of class @p c, not counting the guard page */
+      static size_t stack_size( stack_class c );
+
+      struct class_stats
+      {
+         size_t   stack_size = 0;
+         uint32_t in_use = 0;  ///< stacks owned by a context
+         uint32_t cached = 0;  ///< stacks waiting in the pool for reuse
+      };
+      class_stats get_stats( stack_class c )const;
+
+      /** limits how many released stacks of each class are kept for reuse, the rest are unmapped */
+      void set_max_cached( uint32_t stacks_per_class );
+
+      struct task_usage
+      {
+         std::string desc;
+         stack_class cls = stack_class::normal;
+         size_t      high_water = 0; ///< deepest stack use seen in bytes, rounded up to a word
+         uint64_t    runs = 0;
+      };
+
+      void set_usage_tracking( bool enabled );
+      bool usage_tracking_enabled()const;
+      /** @return the high water mark of every task description seen since the last reset_usage() */
+      std::vector<task_usage> get_usage()const;
+      void reset_usage();
+
+    private:
+      friend struct context;
+      friend class thread_d;
+      stack_pool();
+      ~stack_pool();
+
+      std::unique_ptr<detail::stack_pool_impl> my;
+  };
+
+} // namespace fc
@@ -1,6 +1,7 @@
 #pragma once
 #include <fc/thread/future.hpp>
 #include <fc/thread/priority.hpp>
+#include <fc/thread/stack_pool.hpp>
 #include <fc/aligned.hpp>
 #include <fc/fwd.hpp>
 
@@ -25,6 +26,19 @@ namespace fc {
       };
       void* get_task_specific_data(unsigned slot);
       void set_task_specific_data(unsigned slot, void* new_value, void(*cleanup)(void*));
+
+      /** intrusive link into a thread's timer wheel, see src/thread/timer_wheel.hpp */
+      struct timer_hook
+      {
+         static const uint32_t unlinked = 0xffffffff;
+         timer_hook() : prev(nullptr), next(nullptr), owner(nullptr), expiry_tick(0), slot(unlinked) {}
+
+         timer_hook* prev;
+         timer_hook* next;
+         void*       owner;
+         uint64_t    expiry_tick;
+         uint32_t    slot;
+      };
    }
 
   class task_base : virtual public promise_base {
@@ -37,7 +51,10 @@ namespace fc {
       /// Task priority looks like unsupported feature.
       uint64_t    _posted_num;
       priority    _prio;
+      stack_class _stack_class;
       time_point  _when;
+      thread*     _scheduled_thread; // set if _when is in the future, so cancel() can tell it
+      detail::timer_hook _timer;     // used by the thread while waiting for _when
       void        _set_active_context(context*);
       context*    _active_context;
       task_base*  _next;
@@ -53,6 +70,7 @@ namespace fc {
       // thread/thread_private
       friend class thread;
       friend class thread_d;
+      friend class thread_pool;
       fwd<spin_lock,8> _spinlock;
 
       // avoid rtti info for every possible functor...
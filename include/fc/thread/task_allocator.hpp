@@ -0,0 +1,46 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+namespace fc { namespace detail {
+
+   /**
+    *  Thread-caching slab allocator behind operator new/delete of promises, tasks and
+    *  completion handlers.
+    *
+    *  Blocks are grouped in 64 byte size classes up to max_block_size; each thread keeps
+    *  a free list per class and carves new blocks out of chunks it owns.  A block freed
+    *  on another thread, which is common since tasks usually complete on the thread they
+    *  were posted to while the poster drops the last reference, is pushed onto a lock-free
+    *  list of its owning thread and reclaimed by it on its next allocation of that class.
+    *  Caches of exited threads are handed to the next thread that starts allocating.
+    *
+    *  Anything larger than max_block_size goes straight to the global operator new.
+    */
+   class task_allocator
+   {
+      public:
+         static const size_t max_block_size = 1024;
+
+         static void* allocate( size_t size );
+         static void  deallocate( void* p );
+
+         /** counters of the calling thread's cache */
+         struct stats
+         {
+            uint64_t slab_allocations = 0; ///< served from a free list or a chunk
+            uint64_t heap_allocations = 0; ///< calls into the global operator new, chunks and large blocks
+            uint64_t remote_frees     = 0; ///< blocks this thread freed that another thread owns
+         };
+         static stats get_thread_stats();
+   };
+
+} } // namespace fc::detail
+
+/**
+ *  Declares class specific operator new and delete that use fc::detail::task_allocator.
+ *  Derived classes inherit them, so the allocation is sized for the most derived type.
+ */
+#define FC_USE_TASK_ALLOCATOR \
+   static void* operator new( size_t size ) { return fc::detail::task_allocator::allocate( size ); } \
+   static void  operator delete( void* p )  { fc::detail::task_allocator::deallocate( p ); }
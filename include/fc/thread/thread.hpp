@@ -17,6 +17,7 @@ namespace fc {
       unsigned get_next_unused_task_storage_slot();
       void* get_task_specific_data(unsigned slot);
       void set_task_specific_data(unsigned slot, void* new_value, void(*cleanup)(void*));
+      class thread_pool_impl;
    }
 
   class thread {
@@ -64,18 +65,33 @@ namespace fc {
        *
        *  @param f the operation to perform
        *  @param prio the priority relative to other tasks
+       *  @param stack the size of the stack the task runs on, see fc::stack_pool
        */
       template<typename Functor>
-      auto async( Functor&& f, const char* desc FC_TASK_NAME_DEFAULT_ARG, priority prio = priority()) -> fc::future<decltype(f())> {
+      auto async( Functor&& f, const char* desc FC_TASK_NAME_DEFAULT_ARG, priority prio = priority(),
+                  stack_class stack = stack_class::normal ) -> fc::future<decltype(f())> {
          typedef decltype(f()) Result;
          typedef typename fc::deduce<Functor>::type FunctorType;
          fc::task<Result,sizeof(FunctorType)>* tsk = 
               new fc::task<Result,sizeof(FunctorType)>( fc::forward<Functor>(f), desc );
+         tsk->_stack_class = stack;
          fc::future<Result> r(fc::shared_ptr< fc::promise<Result> >(tsk,true) );
          async_task(tsk,prio);
          return r;
       }
       void poke();
+
+      /**
+       *  Counters for cross-thread posting.  A wakeup is only sent when a task is posted to
+       *  an empty inbox while this thread is parked waiting for work; wakeups_avoided counts
+       *  posts to an empty inbox that found the thread still running.
+       */
+      struct wakeup_stats
+      {
+         uint64_t wakeups_sent = 0;
+         uint64_t wakeups_avoided = 0;
+      };
+      wakeup_stats get_wakeup_stats()const;
      
      
       /**
@@ -134,6 +150,7 @@ namespace fc {
       friend class task_base;
       friend class thread_d;
       friend class mutex;
+      friend class detail::thread_pool_impl;
       friend void* detail::get_thread_specific_data(unsigned slot);
       friend void detail::set_thread_specific_data(unsigned slot, void* new_value, void(*cleanup)(void*));
       friend unsigned detail::get_next_unused_task_storage_slot();
@@ -160,6 +177,7 @@ namespace fc {
       void async_task( task_base* t, const priority& p, const time_point& tp );
 
       void notify_task_has_been_canceled();
+      void notify_scheduled_task_canceled( task_base* t );
       void unblock(fc::context* c);
 
       class thread_d* my;
@@ -198,8 +216,9 @@ namespace fc {
    int wait_any_until( std::vector<promise_base::ptr>&& v, const time_point& tp );
 
    template<typename Functor>
-   auto async( Functor&& f, const char* desc FC_TASK_NAME_DEFAULT_ARG, priority prio = priority()) -> fc::future<decltype(f())> {
-      return fc::thread::current().async( fc::forward<Functor>(f), desc, prio );
+   auto async( Functor&& f, const char* desc FC_TASK_NAME_DEFAULT_ARG, priority prio = priority(),
+               stack_class stack = stack_class::normal ) -> fc::future<decltype(f())> {
+      return fc::thread::current().async( fc::forward<Functor>(f), desc, prio, stack );
    }
    template<typename Functor>
    auto schedule( Functor&& f, const fc::time_point& t, const char* desc FC_TASK_NAME_DEFAULT_ARG, priority prio = priority()) -> fc::future<decltype(f())> {
@@ -247,3 +266,4 @@ namespace fc {
 }
 #endif
 
+#include <fc/thread/continuation.hpp>
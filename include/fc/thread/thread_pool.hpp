@@ -0,0 +1,66 @@
+#pragma once
+#include <fc/thread/thread.hpp>
+#include <memory>
+
+namespace fc {
+   namespace detail { class thread_pool_impl; }
+
+  /**
+   *  @brief a fixed set of fc::threads that share the work posted to the pool
+   *
+   *  Every worker owns a deque of tasks that have not been started yet.  async() puts
+   *  a new task on the deque of the least-loaded worker; a worker that runs out of
+   *  work takes tasks from the back of its peers' deques before it goes to sleep.
+   *
+   *  Once a task has started it stays on the worker that started it (its fiber belongs
+   *  to that worker's scheduler), so fc::future, fc::mutex and task specific data
+   *  behave exactly as they do for tasks posted directly to an fc::thread.
+   */
+  class thread_pool {
+    public:
+      thread_pool( uint16_t num_threads, const std::string& name_prefix = "pool" );
+      ~thread_pool();
+
+      /**
+       *  Calls function <code>f</code> on one of the pool's threads and returns a future<T>
+       *  that can be used to wait on the result.
+       *
+       *  @param f the operation to perform
+       *  @param prio the priority relative to other tasks on the worker that runs it
+       *  @param stack the size of the stack the task runs on, see fc::stack_pool
+       */
+      template<typename Functor>
+      auto async( Functor&& f, const char* desc FC_TASK_NAME_DEFAULT_ARG, priority prio = priority(),
+                  stack_class stack = stack_class::normal ) -> fc::future<decltype(f())> {
+         typedef decltype(f()) Result;
+         typedef typename fc::deduce<Functor>::type FunctorType;
+         fc::task<Result,sizeof(FunctorType)>* tsk =
+              new fc::task<Result,sizeof(FunctorType)>( fc::forward<Functor>(f), desc );
+         tsk->_stack_class = stack;
+         fc::future<Result> r(fc::shared_ptr< fc::promise<Result> >(tsk,true) );
+         post_task(tsk,prio);
+         return r;
+      }
+
+      uint16_t    size()const;
+      fc::thread& get_thread( uint16_t index );
+
+      /**
+       *  @return the worker with the fewest queued and running tasks, useful for
+       *  pinning long lived work (e.g. a connection) to a thread.
+       */
+      fc::thread& least_loaded_thread();
+
+      /**
+       *  Cancels all tasks that have not been started yet and quits every worker.
+       *  Called by the destructor.
+       */
+      void quit();
+
+    private:
+      void post_task( task_base* t, const priority& p );
+
+      std::unique_ptr<detail::thread_pool_impl> my;
+  };
+
+} // namespace fc
@@ -16,6 +16,7 @@
 #include <fc/container/flat_fwd.hpp>
 #include <fc/smart_ref_fwd.hpp>
 #include <boost/multi_index_container_fwd.hpp>
+#include <boost/utility/string_view.hpp>
 
 #ifdef FC_ASSERT
 #define _FC_ASSERT(...) FC_ASSERT( __VA_ARGS__ )
@@ -177,6 +178,11 @@ namespace fc
     * variant's allocate everything but strings, arrays, and objects on the
     * stack and are 'move aware' for values allcoated on the heap.  
     *
+    * Strings of up to 14 bytes (10 on 32 bit systems) are stored inline.  Longer strings,
+    * blobs, arrays and objects are reference counted and shared between copies until one
+    * of them is modified through get_array(), get_object() or get_blob(); the payload
+    * returned there is never shared again, so references to it stay valid like before.
+    *
     * Memory usage on 64 bit systems is 16 bytes and 12 bytes on 32 bit systems.
     */
    class variant
@@ -222,7 +228,7 @@ namespace fc
         variant( mutable_variant_object, uint32_t max_depth = 1 );
         variant( variants, uint32_t max_depth = 1 );
         variant( const variant&, uint32_t max_depth = 1 );
-        variant( variant&&, uint32_t max_depth = 1 );
+        variant( variant&&, uint32_t max_depth = 1 )noexcept;
        ~variant();
 
         /**
@@ -280,7 +286,9 @@ namespace fc
         string                      as_string()const;
 
         /// @pre  get_type() == string_type
-        const string&               get_string()const;
+        string                      get_string()const;
+        /// @pre  get_type() == string_type, @return a view valid until this variant changes
+        boost::string_view          get_string_view()const;
                                     
         /// @throw if get_type() != array_type | null_type
         variants&                   get_array();
@@ -327,7 +335,7 @@ namespace fc
            from_variant( *this, v, max_depth );
         }
 
-        variant& operator=( variant&& v );
+        variant& operator=( variant&& v )noexcept;
         variant& operator=( const variant& v );
 
         template<typename T>
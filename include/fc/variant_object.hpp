@@ -6,6 +6,8 @@
 namespace fc
 {
    class mutable_variant_object;
+
+   namespace detail { struct variant_object_data; }
    
    /**
     *  @ingroup Serializable
@@ -15,8 +17,8 @@ namespace fc
     *  Keys are kept in the order they are inserted.
     *  This dictionary implements copy-on-write
     *
-    *  @note This class is not optimized for random-access on large
-    *        sets of key-value pairs.
+    *  Objects with many keys build a hash index of them on their first lookup, so find()
+    *  stays constant time for large sets of key-value pairs.
     */
    class variant_object
    {
@@ -69,10 +71,7 @@ namespace fc
        
       template<typename T>
       variant_object( string key, T&& val )
-      :_key_value( std::make_shared<std::vector<entry> >() )
-      {
-         *this = variant_object( std::move(key), variant(forward<T>(val)) );
-      }
+      :variant_object( std::move(key), variant(forward<T>(val)) ) {}
       variant_object( const variant_object& );
       variant_object( variant_object&& );
 
@@ -86,7 +85,7 @@ namespace fc
       variant_object& operator=( const mutable_variant_object& );
 
    private:
-      std::shared_ptr< std::vector< entry > > _key_value;
+      std::shared_ptr< detail::variant_object_data > _key_value;
       friend class mutable_variant_object;
    };
    /** @ingroup Serializable */
@@ -103,8 +102,8 @@ namespace fc
    *  Keys are kept in the order they are inserted.
    *  This dictionary implements copy-on-write
    *
-   *  @note This class is not optimized for random-access on large
-   *        sets of key-value pairs.
+   *  Like variant_object, large objects index their keys.  The index follows set(),
+   *  operator() and erase(); values may be changed through iterators, keys may not.
    */
    class mutable_variant_object
    {
@@ -190,7 +189,7 @@ namespace fc
 
       template<typename T>
       explicit mutable_variant_object( T&& v )
-      :_key_value( new std::vector<entry>() )
+      :mutable_variant_object()
       {
           *this = variant(fc::forward<T>(v)).get_object();
       }
@@ -201,7 +200,7 @@ namespace fc
       mutable_variant_object( string key, variant val );
       template<typename T>
       mutable_variant_object( string key, T&& val )
-      :_key_value( new std::vector<entry>() )
+      :mutable_variant_object()
       {
          set( std::move(key), variant(fc::forward<T>(val)) );
       }
@@ -209,12 +208,13 @@ namespace fc
       mutable_variant_object( mutable_variant_object&& );
       mutable_variant_object( const mutable_variant_object& );
       mutable_variant_object( const variant_object& );
+      ~mutable_variant_object();
 
       mutable_variant_object& operator=( mutable_variant_object&& );
       mutable_variant_object& operator=( const mutable_variant_object& );
       mutable_variant_object& operator=( const variant_object& );
    private:
-      std::unique_ptr< std::vector< entry > > _key_value;
+      std::unique_ptr< detail::variant_object_data > _key_value;
       friend class variant_object;
    };
 
@@ -8,6 +8,13 @@ namespace fc {
   namespace asio {
     namespace detail {
 
+      fc::exception_ptr error_to_exception( const boost::system::error_code& ec )
+      {
+        if( ec == boost::asio::error::eof  )
+          return fc::exception_ptr( new fc::eof_exception( FC_LOG_MESSAGE( error, "${message} ", ("message", boost::system::system_error(ec).what())) ) );
+        return fc::exception_ptr( new fc::exception( FC_LOG_MESSAGE( error, "${message} ", ("message", boost::system::system_error(ec).what())) ) );
+      }
+
       read_write_handler::read_write_handler(const promise<size_t>::ptr& completion_promise) :
         _completion_promise(completion_promise)
       {
@@ -19,10 +26,8 @@ namespace fc {
         //assert(false); // to detect anywhere we're not passing in a shared buffer
         if( !ec )
           _completion_promise->set_value(bytes_transferred);
-        else if( ec == boost::asio::error::eof  )
-          _completion_promise->set_exception( fc::exception_ptr( new fc::eof_exception( FC_LOG_MESSAGE( error, "${message} ", ("message", boost::system::system_error(ec).what())) ) ) );
         else
-          _completion_promise->set_exception( fc::exception_ptr( new fc::exception( FC_LOG_MESSAGE( error, "${message} ", ("message", boost::system::system_error(ec).what())) ) ) );
+          _completion_promise->set_exception( error_to_exception( ec ) );
       }
 
       read_write_handler_with_buffer::read_write_handler_with_buffer(const promise<size_t>::ptr& completion_promise, 
@@ -35,10 +40,22 @@ namespace fc {
       {
         if( !ec )
           _completion_promise->set_value(bytes_transferred);
-        else if( ec == boost::asio::error::eof  )
-          _completion_promise->set_exception( fc::exception_ptr( new fc::eof_exception( FC_LOG_MESSAGE( error, "${message} ", ("message", boost::system::system_error(ec).what())) ) ) );
         else
-          _completion_promise->set_exception( fc::exception_ptr( new fc::exception( FC_LOG_MESSAGE( error, "${message} ", ("message", boost::system::system_error(ec).what())) ) ) );
+          _completion_promise->set_exception( error_to_exception( ec ) );
+      }
+
+      read_write_handler_with_chain::read_write_handler_with_chain(const promise<size_t>::ptr& completion_promise,
+                                                                   const std::shared_ptr<const const_buffer_chain>& chain) :
+        _completion_promise(completion_promise),
+        _chain(chain)
+      {}
+
+      void read_write_handler_with_chain::operator()(const boost::system::error_code& ec, size_t bytes_transferred)
+      {
+        if( !ec )
+          _completion_promise->set_value(bytes_transferred);
+        else
+          _completion_promise->set_exception( error_to_exception( ec ) );
       }
 
         void error_handler( const promise<void>::ptr& p,
@@ -153,6 +170,30 @@ namespace fc {
         return *fc_asio_service[0].io;
     }
 
+    // asio passes no more buffers than this to one system call
+    static const size_t max_gather_buffers = 64;
+
+    std::vector<boost::asio::const_buffer> chain_buffers( const const_buffer_chain& chain, size_t length, size_t offset )
+    {
+      std::vector<boost::asio::const_buffer> buffers;
+      buffers.reserve( std::min<size_t>( chain.size(), max_gather_buffers ) );
+      for( const auto& slice : chain )
+      {
+        if( length == 0 || buffers.size() == max_gather_buffers )
+          break;
+        if( offset >= slice.size )
+        {
+          offset -= slice.size;
+          continue;
+        }
+        const size_t size = std::min( slice.size - offset, length );
+        buffers.emplace_back( slice.data.get() + slice.offset + offset, size );
+        length -= size;
+        offset = 0;
+      }
+      return buffers;
+    }
+
     namespace tcp {
       std::vector<boost::asio::ip::tcp::endpoint> resolve( const std::string& hostname, const std::string& port)
       {
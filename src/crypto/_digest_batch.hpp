@@ -0,0 +1,61 @@
+#pragma once
+#include <fc/crypto/digest_batch.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+# define FC_DIGEST_BATCH_X86 1
+#endif
+
+/* Hashing several messages at once, one 64 byte block of each per step
+ */
+namespace fc { namespace detail {
+
+   /**
+    *  Compresses one block of each lane.  Word i of the state of lane l is at
+    *  state[i * lanes + l]; lanes without a message get a block of zeros.
+    */
+   typedef void (*lane_transform)( uint32_t* state, const unsigned char* const* blocks );
+   /** hashes whole messages, for kernels which keep the state in registers between blocks */
+   typedef void (*batch_function)( const digest_input* in, size_t count, char* out );
+
+   struct lane_kernel
+   {
+      const char*       name;
+      uint32_t          lanes;       ///< at most max_lanes
+      uint32_t          words;       ///< of state and of the digest
+      const uint32_t*   initial_state;
+      bool              big_endian;  ///< for the length and the digest
+      lane_transform    transform;
+      batch_function    batch;       ///< used instead of transform if set
+   };
+
+   /** walks the blocks of a message: its whole blocks in place, then the padded rest */
+   struct block_cursor
+   {
+      const unsigned char* next;
+      size_t               body_blocks;
+      size_t               tail_blocks;
+      unsigned char        tail[128];
+
+      void start( const digest_input& in, bool big_endian );
+      /** moves to the next block, false when there is none */
+      bool advance();
+   };
+
+   const uint32_t max_lanes = 8;
+
+   /** the kernel hash_many should use for sha256, or nullptr to hash one message at a time */
+   const lane_kernel* sha256_lane_kernel();
+   const lane_kernel* ripemd160_lane_kernel();
+
+   /** pads and hashes count messages, writing words * 4 bytes of digest per message to out */
+   void hash_lanes( const lane_kernel& k, const digest_input* in, size_t count, char* out );
+
+#ifdef FC_DIGEST_BATCH_X86
+   void sha256_transform_sse41( uint32_t* state, const unsigned char* const* blocks );
+   void sha256_transform_avx2( uint32_t* state, const unsigned char* const* blocks );
+   void sha256_hash_many_shani( const digest_input* in, size_t count, char* out );
+   void ripemd160_transform_sse41( uint32_t* state, const unsigned char* const* blocks );
+   void ripemd160_transform_avx2( uint32_t* state, const unsigned char* const* blocks );
+#endif
+
+} } // fc::detail
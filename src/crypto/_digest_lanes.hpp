@@ -0,0 +1,217 @@
+#pragma once
+#include <boost/config.hpp>
+#include <stdint.h>
+
+/* SHA-256 and RIPEMD-160 compression of several blocks at once, one per vector lane.
+ * Included only by the translation units built for one instruction set, each of which
+ * provides the vector operations; everything is file local so that code built with
+ * different flags never gets merged by the linker.  The rounds are unrolled at compile time
+ * and forced inline, which lets the message words stay in registers.
+ */
+namespace {
+
+   const uint32_t sha256_k[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+   };
+
+   /** V provides vec, lanes, the arithmetic and load_block */
+   template<typename V>
+   struct sha256_lanes
+   {
+      typedef typename V::vec vec;
+
+      template<int n>
+      static BOOST_FORCEINLINE vec ror( vec x ) { return V::or_( V::template shr<n>( x ), V::template shl<32 - n>( x ) ); }
+
+      static BOOST_FORCEINLINE vec big_sigma0( vec x ) { return V::xor_( V::xor_( ror<2>( x ), ror<13>( x ) ), ror<22>( x ) ); }
+      static BOOST_FORCEINLINE vec big_sigma1( vec x ) { return V::xor_( V::xor_( ror<6>( x ), ror<11>( x ) ), ror<25>( x ) ); }
+      static BOOST_FORCEINLINE vec sigma0( vec x ) { return V::xor_( V::xor_( ror<7>( x ), ror<18>( x ) ), V::template shr<3>( x ) ); }
+      static BOOST_FORCEINLINE vec sigma1( vec x ) { return V::xor_( V::xor_( ror<17>( x ), ror<19>( x ) ), V::template shr<10>( x ) ); }
+      static BOOST_FORCEINLINE vec ch( vec e, vec f, vec g ) { return V::xor_( g, V::and_( e, V::xor_( f, g ) ) ); }
+      static BOOST_FORCEINLINE vec maj( vec a, vec b, vec c ) { return V::or_( V::and_( a, b ), V::and_( c, V::or_( a, b ) ) ); }
+
+      template<int i>
+      static BOOST_FORCEINLINE vec schedule( vec* w )
+      {
+         if( i >= 16 )
+            w[i & 15] = V::add( V::add( sigma1( w[(i - 2) & 15] ), w[(i - 7) & 15] ),
+                                V::add( sigma0( w[(i - 15) & 15] ), w[i & 15] ) );
+         return w[i & 15];
+      }
+
+      template<int i>
+      static BOOST_FORCEINLINE void round( vec a, vec b, vec c, vec& d, vec e, vec f, vec g, vec& h, vec* w )
+      {
+         const vec t1 = V::add( V::add( V::add( h, big_sigma1( e ) ), V::add( ch( e, f, g ), V::set1( sha256_k[i] ) ) ),
+                                schedule<i>( w ) );
+         d = V::add( d, t1 );
+         h = V::add( t1, V::add( big_sigma0( a ), maj( a, b, c ) ) );
+      }
+
+      /** rounds i to i + 7, after which the variables are back in their places */
+      template<int i>
+      static BOOST_FORCEINLINE void rounds( vec& a, vec& b, vec& c, vec& d, vec& e, vec& f, vec& g, vec& h, vec* w )
+      {
+         round<i>( a, b, c, d, e, f, g, h, w );
+         round<i + 1>( h, a, b, c, d, e, f, g, w );
+         round<i + 2>( g, h, a, b, c, d, e, f, w );
+         round<i + 3>( f, g, h, a, b, c, d, e, w );
+         round<i + 4>( e, f, g, h, a, b, c, d, w );
+         round<i + 5>( d, e, f, g, h, a, b, c, w );
+         round<i + 6>( c, d, e, f, g, h, a, b, w );
+         round<i + 7>( b, c, d, e, f, g, h, a, w );
+      }
+
+      static void transform( uint32_t* state, const unsigned char* const* blocks )
+      {
+         const uint32_t n = V::lanes;
+         vec w[16];
+         V::template load_block<true>( blocks, w );
+         vec a = V::load( state ),         b = V::load( state + n ),     c = V::load( state + 2 * n ), d = V::load( state + 3 * n );
+         vec e = V::load( state + 4 * n ), f = V::load( state + 5 * n ), g = V::load( state + 6 * n ), h = V::load( state + 7 * n );
+         rounds<0>( a, b, c, d, e, f, g, h, w );
+         rounds<8>( a, b, c, d, e, f, g, h, w );
+         rounds<16>( a, b, c, d, e, f, g, h, w );
+         rounds<24>( a, b, c, d, e, f, g, h, w );
+         rounds<32>( a, b, c, d, e, f, g, h, w );
+         rounds<40>( a, b, c, d, e, f, g, h, w );
+         rounds<48>( a, b, c, d, e, f, g, h, w );
+         rounds<56>( a, b, c, d, e, f, g, h, w );
+         V::store( state,         V::add( a, V::load( state ) ) );
+         V::store( state + n,     V::add( b, V::load( state + n ) ) );
+         V::store( state + 2 * n, V::add( c, V::load( state + 2 * n ) ) );
+         V::store( state + 3 * n, V::add( d, V::load( state + 3 * n ) ) );
+         V::store( state + 4 * n, V::add( e, V::load( state + 4 * n ) ) );
+         V::store( state + 5 * n, V::add( f, V::load( state + 5 * n ) ) );
+         V::store( state + 6 * n, V::add( g, V::load( state + 6 * n ) ) );
+         V::store( state + 7 * n, V::add( h, V::load( state + 7 * n ) ) );
+      }
+   };
+
+   /** message word and rotation of each step of the left and the right line */
+   constexpr uint8_t ripemd160_rl[80] = {
+      0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+      7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+      3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+      1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+      4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13
+   };
+   constexpr uint8_t ripemd160_rr[80] = {
+      5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+      6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+      15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+      8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+      12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11
+   };
+   constexpr uint8_t ripemd160_sl[80] = {
+      11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+      7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+      11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+      11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+      9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6
+   };
+   constexpr uint8_t ripemd160_sr[80] = {
+      8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+      9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+      9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+      15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+      8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11
+   };
+   const uint32_t ripemd160_kl[5] = { 0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e };
+   const uint32_t ripemd160_kr[5] = { 0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000 };
+
+   template<typename V>
+   struct ripemd160_lanes
+   {
+      typedef typename V::vec vec;
+
+      template<int n>
+      static BOOST_FORCEINLINE vec rol( vec x ) { return V::or_( V::template shl<n>( x ), V::template shr<32 - n>( x ) ); }
+      static BOOST_FORCEINLINE vec not_( vec x ) { return V::xor_( x, V::set1( 0xffffffff ) ); }
+
+      /** the boolean function of round r, the right line uses them in reverse order */
+      template<int r>
+      static BOOST_FORCEINLINE vec f( vec x, vec y, vec z )
+      {
+         switch( r )
+         {
+            case 0:  return V::xor_( V::xor_( x, y ), z );
+            case 1:  return V::or_( V::and_( x, y ), V::andnot( x, z ) );
+            case 2:  return V::xor_( V::or_( x, not_( y ) ), z );
+            case 3:  return V::or_( V::and_( x, z ), V::andnot( z, y ) );
+            default: return V::xor_( x, V::or_( y, not_( z ) ) );
+         }
+      }
+
+      template<int i>
+      static BOOST_FORCEINLINE void step( vec& a, vec b, vec& c, vec d, vec e, const vec* x )
+      {
+         a = V::add( rol<ripemd160_sl[i]>( V::add( V::add( a, f<i / 16>( b, c, d ) ), V::add( x[ripemd160_rl[i]], V::set1( ripemd160_kl[i / 16] ) ) ) ), e );
+         c = rol<10>( c );
+      }
+
+      template<int i>
+      static BOOST_FORCEINLINE void step_right( vec& a, vec b, vec& c, vec d, vec e, const vec* x )
+      {
+         a = V::add( rol<ripemd160_sr[i]>( V::add( V::add( a, f<4 - i / 16>( b, c, d ) ), V::add( x[ripemd160_rr[i]], V::set1( ripemd160_kr[i / 16] ) ) ) ), e );
+         c = rol<10>( c );
+      }
+
+      /** steps i to i + 4 of both lines, after which the variables are back in their places */
+      template<int i>
+      static BOOST_FORCEINLINE void steps( vec& a, vec& b, vec& c, vec& d, vec& e,
+                                           vec& ar, vec& br, vec& cr, vec& dr, vec& er, const vec* x )
+      {
+         step<i>( a, b, c, d, e, x );
+         step<i + 1>( e, a, b, c, d, x );
+         step<i + 2>( d, e, a, b, c, x );
+         step<i + 3>( c, d, e, a, b, x );
+         step<i + 4>( b, c, d, e, a, x );
+         step_right<i>( ar, br, cr, dr, er, x );
+         step_right<i + 1>( er, ar, br, cr, dr, x );
+         step_right<i + 2>( dr, er, ar, br, cr, x );
+         step_right<i + 3>( cr, dr, er, ar, br, x );
+         step_right<i + 4>( br, cr, dr, er, ar, x );
+      }
+
+      static void transform( uint32_t* state, const unsigned char* const* blocks )
+      {
+         const uint32_t n = V::lanes;
+         vec x[16];
+         V::template load_block<false>( blocks, x );
+         const vec h0 = V::load( state ), h1 = V::load( state + n ), h2 = V::load( state + 2 * n ),
+                   h3 = V::load( state + 3 * n ), h4 = V::load( state + 4 * n );
+         vec a = h0, b = h1, c = h2, d = h3, e = h4;
+         vec ar = h0, br = h1, cr = h2, dr = h3, er = h4;
+         steps<0>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<5>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<10>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<15>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<20>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<25>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<30>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<35>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<40>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<45>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<50>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<55>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<60>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<65>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<70>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         steps<75>( a, b, c, d, e, ar, br, cr, dr, er, x );
+         V::store( state,         V::add( V::add( h1, c ), dr ) );
+         V::store( state + n,     V::add( V::add( h2, d ), er ) );
+         V::store( state + 2 * n, V::add( V::add( h3, e ), ar ) );
+         V::store( state + 3 * n, V::add( V::add( h4, a ), br ) );
+         V::store( state + 4 * n, V::add( V::add( h0, b ), cr ) );
+      }
+   };
+
+} // anonymous
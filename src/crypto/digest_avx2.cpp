@@ -0,0 +1,79 @@
+#include "_digest_batch.hpp"
+
+#ifdef FC_DIGEST_BATCH_X86
+#include <immintrin.h>
+#include "_digest_lanes.hpp"
+
+namespace {
+   /** eight lanes in AVX registers, built with -mavx2 */
+   struct avx2
+   {
+      typedef __m256i vec;
+      static const uint32_t lanes = 8;
+
+      static vec load( const uint32_t* p ) { return _mm256_loadu_si256( (const __m256i*)p ); }
+      static void store( uint32_t* p, vec v ) { _mm256_storeu_si256( (__m256i*)p, v ); }
+      static vec set1( uint32_t x ) { return _mm256_set1_epi32( (int)x ); }
+      static vec add( vec a, vec b ) { return _mm256_add_epi32( a, b ); }
+      static vec xor_( vec a, vec b ) { return _mm256_xor_si256( a, b ); }
+      static vec and_( vec a, vec b ) { return _mm256_and_si256( a, b ); }
+      static vec or_( vec a, vec b ) { return _mm256_or_si256( a, b ); }
+      /** ~a & b */
+      static vec andnot( vec a, vec b ) { return _mm256_andnot_si256( a, b ); }
+      template<int n> static vec shl( vec x ) { return _mm256_slli_epi32( x, n ); }
+      template<int n> static vec shr( vec x ) { return _mm256_srli_epi32( x, n ); }
+
+      /** w[i] gets word i of the block of every lane */
+      template<bool big_endian>
+      static void load_block( const unsigned char* const* blocks, vec* w )
+      {
+         const vec swap = _mm256_set_epi8( 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                           12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3 );
+         for( int half = 0; half < 2; ++half )
+         {
+            vec r[8];
+            for( int l = 0; l < 8; ++l )
+            {
+               r[l] = _mm256_loadu_si256( (const __m256i*)( blocks[l] + 32 * half ) );
+               if( big_endian )
+                  r[l] = _mm256_shuffle_epi8( r[l], swap );
+            }
+            // transposes within the 128 bit halves, then swaps the halves
+            vec t[8], u[8];
+            for( int l = 0; l < 8; l += 2 )
+            {
+               t[l]     = _mm256_unpacklo_epi32( r[l], r[l + 1] );
+               t[l + 1] = _mm256_unpackhi_epi32( r[l], r[l + 1] );
+            }
+            for( int l = 0; l < 8; l += 4 )
+            {
+               u[l]     = _mm256_unpacklo_epi64( t[l], t[l + 2] );
+               u[l + 1] = _mm256_unpackhi_epi64( t[l], t[l + 2] );
+               u[l + 2] = _mm256_unpacklo_epi64( t[l + 1], t[l + 3] );
+               u[l + 3] = _mm256_unpackhi_epi64( t[l + 1], t[l + 3] );
+            }
+            vec* out = w + 8 * half;
+            for( int i = 0; i < 4; ++i )
+            {
+               out[i]     = _mm256_permute2x128_si256( u[i], u[i + 4], 0x20 );
+               out[i + 4] = _mm256_permute2x128_si256( u[i], u[i + 4], 0x31 );
+            }
+         }
+      }
+   };
+}
+
+namespace fc { namespace detail {
+
+   void sha256_transform_avx2( uint32_t* state, const unsigned char* const* blocks )
+   {
+      sha256_lanes<avx2>::transform( state, blocks );
+   }
+
+   void ripemd160_transform_avx2( uint32_t* state, const unsigned char* const* blocks )
+   {
+      ripemd160_lanes<avx2>::transform( state, blocks );
+   }
+
+} } // fc::detail
+#endif
@@ -0,0 +1,260 @@
+#include <fc/crypto/digest_batch.hpp>
+#include <fc/exception/exception.hpp>
+#include "_digest_batch.hpp"
+
+#include <atomic>
+#include <string.h>
+
+#ifdef FC_DIGEST_BATCH_X86
+# ifdef _MSC_VER
+#  include <intrin.h>
+# else
+#  include <cpuid.h>
+# endif
+#endif
+
+namespace fc { namespace detail {
+
+   namespace {
+      /** the ways to hash, slowest last; a kernel is used at its level and at faster ones */
+      enum batch_level { sha_ni_level, avx2_level, sse41_level, generic_level };
+      const char* const level_names[] = { "sha-ni", "avx2", "sse4.1", "generic" };
+
+      struct cpu_features
+      {
+         bool sse41 = false;
+         bool avx2  = false;
+         bool sha   = false;
+
+         cpu_features()
+         {
+#ifdef FC_DIGEST_BATCH_X86
+            uint32_t r[4];
+            cpuid( 0, r );
+            const uint32_t max_leaf = r[0];
+            cpuid( 1, r );
+            const bool ssse3 = r[2] & (1u << 9);
+            sse41 = ssse3 && ( r[2] & (1u << 19) );
+            // AVX registers need to be saved by the OS too
+            const bool os_avx = ( r[2] & (1u << 27) ) && ( r[2] & (1u << 28) ) && ( xcr0() & 6 ) == 6;
+            if( max_leaf >= 7 )
+            {
+               cpuid( 7, r );
+               avx2 = os_avx && ( r[1] & (1u << 5) );
+               sha = sse41 && ( r[1] & (1u << 29) );
+            }
+#endif
+         }
+
+         bool supports( batch_level level )const
+         {
+            switch( level )
+            {
+               case sha_ni_level: return sha;
+               case avx2_level:   return avx2;
+               case sse41_level:  return sse41;
+               default:           return true;
+            }
+         }
+
+#ifdef FC_DIGEST_BATCH_X86
+         static void cpuid( uint32_t leaf, uint32_t* r )
+         {
+# ifdef _MSC_VER
+            int regs[4];
+            __cpuidex( regs, (int)leaf, 0 );
+            memcpy( r, regs, sizeof(regs) );
+# else
+            __cpuid_count( leaf, 0, r[0], r[1], r[2], r[3] );
+# endif
+         }
+
+         static uint64_t xcr0()
+         {
+# ifdef _MSC_VER
+            return _xgetbv( 0 );
+# else
+            uint32_t lo, hi;
+            __asm__( "xgetbv" : "=a"(lo), "=d"(hi) : "c"(0) );
+            return ( uint64_t(hi) << 32 ) | lo;
+# endif
+         }
+#endif
+      };
+
+      const cpu_features& cpu()
+      {
+         static const cpu_features features;
+         return features;
+      }
+
+      /** the fastest level hash_many may use, set for tests and benchmarks */
+      std::atomic<int> max_level( sha_ni_level );
+
+      struct leveled_kernel
+      {
+         batch_level level;
+         lane_kernel kernel;
+      };
+
+      const uint32_t sha256_initial_state[8] = {
+         0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+      };
+      const uint32_t ripemd160_initial_state[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+#ifdef FC_DIGEST_BATCH_X86
+      const leveled_kernel sha256_kernels[] = {
+         { sha_ni_level, { "sha-ni", 2, 8, sha256_initial_state, true, nullptr, sha256_hash_many_shani } },
+         { avx2_level,   { "avx2",   8, 8, sha256_initial_state, true, sha256_transform_avx2, nullptr } },
+         { sse41_level,  { "sse4.1", 4, 8, sha256_initial_state, true, sha256_transform_sse41, nullptr } }
+      };
+      const leveled_kernel ripemd160_kernels[] = {
+         { avx2_level,   { "avx2",   8, 5, ripemd160_initial_state, false, ripemd160_transform_avx2, nullptr } },
+         { sse41_level,  { "sse4.1", 4, 5, ripemd160_initial_state, false, ripemd160_transform_sse41, nullptr } }
+      };
+
+      template<size_t N>
+      const lane_kernel* select( const leveled_kernel (&kernels)[N] )
+      {
+         const int level = max_level.load( std::memory_order_relaxed );
+         for( const auto& k : kernels )
+            if( k.level >= level && cpu().supports( k.level ) )
+               return &k.kernel;
+         return nullptr;
+      }
+#endif
+   }
+
+   void block_cursor::start( const digest_input& in, bool big_endian )
+   {
+      body_blocks = in.size / 64;
+      const size_t rest = in.size % 64;
+      tail_blocks = rest < 56 ? 1 : 2;
+      const size_t tail_size = 64 * tail_blocks;
+      if( rest )
+         memcpy( tail, in.data + 64 * body_blocks, rest );
+      tail[rest] = 0x80;
+      memset( tail + rest + 1, 0, tail_size - rest - 1 );
+      const uint64_t bits = uint64_t( in.size ) * 8;
+      for( int b = 0; b < 8; ++b )
+         tail[big_endian ? tail_size - 1 - b : tail_size - 8 + b] = uint8_t( bits >> ( 8 * b ) );
+      next = body_blocks ? (const unsigned char*)in.data : tail;
+   }
+
+   bool block_cursor::advance()
+   {
+      if( body_blocks && --body_blocks == 0 )
+         next = tail;
+      else if( body_blocks )
+         next += 64;
+      else if( --tail_blocks )
+         next += 64;
+      else
+         return false;
+      return true;
+   }
+
+   const lane_kernel* sha256_lane_kernel()
+   {
+#ifdef FC_DIGEST_BATCH_X86
+      return select( sha256_kernels );
+#else
+      return nullptr;
+#endif
+   }
+
+   const lane_kernel* ripemd160_lane_kernel()
+   {
+#ifdef FC_DIGEST_BATCH_X86
+      return select( ripemd160_kernels );
+#else
+      return nullptr;
+#endif
+   }
+
+   void hash_lanes( const lane_kernel& k, const digest_input* in, size_t count, char* out )
+   {
+      if( k.batch )
+      {
+         k.batch( in, count, out );
+         return;
+      }
+
+      static const unsigned char idle_block[64] = {};
+      uint32_t state[8 * max_lanes];
+      block_cursor cursors[max_lanes];
+      size_t index[max_lanes];
+      bool busy[max_lanes] = {};
+      const unsigned char* blocks[max_lanes];
+      const size_t digest_size = 4 * k.words;
+
+      size_t next = 0;
+      size_t active = 0;
+      while( true )
+      {
+         for( uint32_t l = 0; l < k.lanes && next < count; ++l )
+         {
+            if( busy[l] )
+               continue;
+            cursors[l].start( in[next], k.big_endian );
+            index[l] = next;
+            for( uint32_t w = 0; w < k.words; ++w )
+               state[w * k.lanes + l] = k.initial_state[w];
+            busy[l] = true;
+            ++active;
+            ++next;
+         }
+         if( active == 0 )
+            break;
+
+         for( uint32_t l = 0; l < k.lanes; ++l )
+            blocks[l] = busy[l] ? cursors[l].next : idle_block;
+         k.transform( state, blocks );
+
+         for( uint32_t l = 0; l < k.lanes; ++l )
+         {
+            if( !busy[l] || cursors[l].advance() )
+               continue;
+            char* digest = out + digest_size * index[l];
+            for( uint32_t w = 0; w < k.words; ++w )
+            {
+               const uint32_t v = state[w * k.lanes + l];
+               for( int b = 0; b < 4; ++b )
+                  digest[4 * w + b] = char( v >> ( k.big_endian ? 24 - 8 * b : 8 * b ) );
+            }
+            busy[l] = false;
+            --active;
+         }
+      }
+   }
+
+} // detail
+
+   std::vector<string> digest_batch_implementations()
+   {
+      std::vector<string> names;
+      for( int level = detail::sha_ni_level; level <= detail::generic_level; ++level )
+         if( detail::cpu().supports( detail::batch_level( level ) ) )
+            names.push_back( detail::level_names[level] );
+      return names;
+   }
+
+   void set_digest_batch_implementation( const string& name )
+   {
+      if( name.empty() )
+      {
+         detail::max_level = detail::sha_ni_level;
+         return;
+      }
+      for( int level = detail::sha_ni_level; level <= detail::generic_level; ++level )
+      {
+         if( name != detail::level_names[level] )
+            continue;
+         FC_ASSERT( detail::cpu().supports( detail::batch_level( level ) ), "${name} is not supported by this cpu", ("name",name) );
+         detail::max_level = level;
+         return;
+      }
+      FC_THROW_EXCEPTION( invalid_arg_exception, "unknown digest batch implementation ${name}", ("name",name) );
+   }
+
+} // fc
@@ -0,0 +1,64 @@
+#include "_digest_batch.hpp"
+
+#ifdef FC_DIGEST_BATCH_X86
+#include <smmintrin.h>
+#include "_digest_lanes.hpp"
+
+namespace {
+   /** four lanes in SSE registers, built with -msse4.1 */
+   struct sse41
+   {
+      typedef __m128i vec;
+      static const uint32_t lanes = 4;
+
+      static vec load( const uint32_t* p ) { return _mm_loadu_si128( (const __m128i*)p ); }
+      static void store( uint32_t* p, vec v ) { _mm_storeu_si128( (__m128i*)p, v ); }
+      static vec set1( uint32_t x ) { return _mm_set1_epi32( (int)x ); }
+      static vec add( vec a, vec b ) { return _mm_add_epi32( a, b ); }
+      static vec xor_( vec a, vec b ) { return _mm_xor_si128( a, b ); }
+      static vec and_( vec a, vec b ) { return _mm_and_si128( a, b ); }
+      static vec or_( vec a, vec b ) { return _mm_or_si128( a, b ); }
+      /** ~a & b */
+      static vec andnot( vec a, vec b ) { return _mm_andnot_si128( a, b ); }
+      template<int n> static vec shl( vec x ) { return _mm_slli_epi32( x, n ); }
+      template<int n> static vec shr( vec x ) { return _mm_srli_epi32( x, n ); }
+
+      /** w[i] gets word i of the block of every lane */
+      template<bool big_endian>
+      static void load_block( const unsigned char* const* blocks, vec* w )
+      {
+         const vec swap = _mm_set_epi8( 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3 );
+         for( int q = 0; q < 4; ++q )
+         {
+            vec r[4];
+            for( int l = 0; l < 4; ++l )
+            {
+               r[l] = _mm_loadu_si128( (const __m128i*)( blocks[l] + 16 * q ) );
+               if( big_endian )
+                  r[l] = _mm_shuffle_epi8( r[l], swap );
+            }
+            const vec t0 = _mm_unpacklo_epi32( r[0], r[1] ), t1 = _mm_unpackhi_epi32( r[0], r[1] );
+            const vec t2 = _mm_unpacklo_epi32( r[2], r[3] ), t3 = _mm_unpackhi_epi32( r[2], r[3] );
+            w[4 * q]     = _mm_unpacklo_epi64( t0, t2 );
+            w[4 * q + 1] = _mm_unpackhi_epi64( t0, t2 );
+            w[4 * q + 2] = _mm_unpacklo_epi64( t1, t3 );
+            w[4 * q + 3] = _mm_unpackhi_epi64( t1, t3 );
+         }
+      }
+   };
+}
+
+namespace fc { namespace detail {
+
+   void sha256_transform_sse41( uint32_t* state, const unsigned char* const* blocks )
+   {
+      sha256_lanes<sse41>::transform( state, blocks );
+   }
+
+   void ripemd160_transform_sse41( uint32_t* state, const unsigned char* const* blocks )
+   {
+      ripemd160_lanes<sse41>::transform( state, blocks );
+   }
+
+} } // fc::detail
+#endif
@@ -4,6 +4,14 @@
 #include <fc/crypto/hmac.hpp>
 #include <fc/crypto/openssl.hpp>
 #include <fc/crypto/ripemd160.hpp>
+#include <fc/crypto/city.hpp>
+#include <fc/thread/scoped_lock.hpp>
+#include <fc/thread/thread_pool.hpp>
+
+#include <boost/thread/mutex.hpp>
+
+#include <list>
+#include <unordered_map>
 
 #ifdef _WIN32
 # include <malloc.h>
@@ -150,7 +158,7 @@ namespace fc { namespace ecc {
     public_key public_key::from_base58( const std::string& b58 )
     {
         array<char, 37> data;
-        size_t s = fc::from_base58(b58, (char*)&data, sizeof(data) );
+        size_t s = fc::from_base58( b58, data );
         FC_ASSERT( s == sizeof(data) );
 
         public_key_data key;
@@ -379,6 +387,191 @@ namespace fc { namespace ecc {
                                      detail::_right(hash) );
         return result;
     }
+
+    namespace detail {
+        /** keys recovered by recover_batch, by digest and signature, most recently used first */
+        class recovery_cache
+        {
+            public:
+                typedef fc::array<char,32 + 65> key_type;
+
+                struct entry
+                {
+                    public_key_data key;
+                    bool            canonical; ///< recovered with the canonical check
+                };
+
+                static key_type make_key( const signature_and_digest& sig )
+                {
+                    key_type key;
+                    memcpy( key.begin(), sig.second.data(), 32 );
+                    memcpy( key.begin() + 32, sig.first.begin(), 65 );
+                    return key;
+                }
+
+                /** a key recovered without the check is not used for a caller that wants it */
+                bool find( const key_type& key, bool check_canonical, public_key_data& found )
+                {
+                    fc::scoped_lock<boost::mutex> lock( _lock );
+                    if( _capacity == 0 )
+                        return false;
+                    auto itr = _index.find( key );
+                    if( itr == _index.end() || ( check_canonical && !itr->second->second.canonical ) )
+                    {
+                        ++_stats.misses;
+                        return false;
+                    }
+                    _entries.splice( _entries.begin(), _entries, itr->second );
+                    found = itr->second->second.key;
+                    ++_stats.hits;
+                    return true;
+                }
+
+                void insert( const key_type& key, const entry& value )
+                {
+                    fc::scoped_lock<boost::mutex> lock( _lock );
+                    if( _capacity == 0 )
+                        return;
+                    auto itr = _index.find( key );
+                    if( itr != _index.end() )
+                    {
+                        itr->second->second.canonical |= value.canonical;
+                        return;
+                    }
+                    _entries.emplace_front( key, value );
+                    _index[key] = _entries.begin();
+                    trim();
+                }
+
+                void resize( size_t capacity )
+                {
+                    fc::scoped_lock<boost::mutex> lock( _lock );
+                    _capacity = capacity;
+                    trim();
+                }
+
+                recovery_cache_stats stats()
+                {
+                    fc::scoped_lock<boost::mutex> lock( _lock );
+                    recovery_cache_stats result = _stats;
+                    result.size = _entries.size();
+                    result.capacity = _capacity;
+                    return result;
+                }
+
+            private:
+                struct key_hash
+                {
+                    size_t operator()( const key_type& key )const { return fc::city_hash_size_t( key.begin(), key.size() ); }
+                };
+                typedef std::list< std::pair<key_type,entry> > entry_list;
+
+                void trim()
+                {
+                    while( _entries.size() > _capacity )
+                    {
+                        _index.erase( _entries.back().first );
+                        _entries.pop_back();
+                    }
+                }
+
+                boost::mutex                                                     _lock;
+                size_t                                                           _capacity = 32768;
+                entry_list                                                       _entries;
+                std::unordered_map<key_type,entry_list::iterator,key_hash>       _index;
+                recovery_cache_stats                                             _stats;
+        };
+
+        static recovery_cache& get_recovery_cache()
+        {
+            static recovery_cache cache;
+            return cache;
+        }
+    }
+
+    std::vector<public_key> recover_batch( const std::vector<signature_and_digest>& sigs, bool check_canonical,
+                                           fc::thread_pool* pool )
+    {
+        detail::recovery_cache& cache = detail::get_recovery_cache();
+        std::vector<public_key> keys( sigs.size() );
+        std::vector<size_t> missing;
+        for( size_t i = 0; i < sigs.size(); ++i )
+        {
+            public_key_data found;
+            if( cache.find( detail::recovery_cache::make_key( sigs[i] ), check_canonical, found ) )
+                keys[i] = public_key( found );
+            else
+                missing.push_back( i );
+        }
+
+        // a recovery takes tens of microseconds, enough of them make a task worth posting
+        const size_t min_chunk = 16;
+        if( !pool || missing.size() <= min_chunk )
+        {
+            for( size_t i : missing )
+                keys[i] = public_key( sigs[i].first, sigs[i].second, check_canonical );
+        }
+        else
+        {
+            // the tasks own what they read and write, a cancelled caller may return before they finish
+            struct batch
+            {
+                std::vector<signature_and_digest> sigs;
+                std::vector<public_key>           keys;
+            };
+            auto work = std::make_shared<batch>();
+            work->sigs.reserve( missing.size() );
+            for( size_t i : missing )
+                work->sigs.push_back( sigs[i] );
+            work->keys.resize( missing.size() );
+
+            const size_t chunk = std::max( min_chunk, ( missing.size() + 4 * pool->size() - 1 ) / ( 4 * pool->size() ) );
+            std::vector< fc::future<void> > done;
+            for( size_t begin = 0; begin < missing.size(); begin += chunk )
+            {
+                const size_t end = std::min( begin + chunk, missing.size() );
+                done.push_back( pool->async( [work,begin,end,check_canonical](){
+                    for( size_t i = begin; i < end; ++i )
+                        work->keys[i] = public_key( work->sigs[i].first, work->sigs[i].second, check_canonical );
+                }, "recover_batch" ) );
+            }
+            fc::exception_ptr error;
+            for( auto& f : done )
+            {
+                try
+                {
+                    f.wait();
+                }
+                catch( const fc::canceled_exception& )
+                {
+                    throw;
+                }
+                catch( const fc::exception& e )
+                {
+                    if( !error )
+                        error = e.dynamic_copy_exception();
+                }
+            }
+            if( error )
+                error->dynamic_rethrow_exception();
+            for( size_t i = 0; i < missing.size(); ++i )
+                keys[missing[i]] = work->keys[i];
+        }
+
+        for( size_t i : missing )
+            cache.insert( detail::recovery_cache::make_key( sigs[i] ), { keys[i].serialize(), check_canonical } );
+        return keys;
+    }
+
+    void set_recovery_cache_size( size_t entries )
+    {
+        detail::get_recovery_cache().resize( entries );
+    }
+
+    recovery_cache_stats get_recovery_cache_stats()
+    {
+        return detail::get_recovery_cache().stats();
+    }
 }
 
 void to_variant( const ecc::private_key& var, variant& vo, uint32_t max_depth )
@@ -9,6 +9,7 @@
 #include <fc/variant.hpp>
 #include <vector>
 #include "_digest_common.hpp"
+#include "_digest_batch.hpp"
 
 namespace fc 
 {
@@ -57,6 +58,23 @@ ripemd160 ripemd160::hash( const string& s ) {
   return hash( s.c_str(), s.size() );
 }
 
+void ripemd160::hash_many( const digest_input* in, size_t count, ripemd160* out )
+{
+  const detail::lane_kernel* k = count > 1 ? detail::ripemd160_lane_kernel() : nullptr;
+  if( k )
+     detail::hash_lanes( *k, in, count, out->data() );
+  else
+     for( size_t i = 0; i < count; ++i )
+        out[i] = hash( in[i].data, in[i].size );
+}
+
+std::vector<ripemd160> ripemd160::hash_many( const std::vector<digest_input>& in )
+{
+  std::vector<ripemd160> out( in.size() );
+  hash_many( in.data(), in.size(), out.data() );
+  return out;
+}
+
 void ripemd160::encoder::write( const char* d, uint32_t dlen ) {
   RIPEMD160_Update( &my->ctx, d, dlen); 
 }
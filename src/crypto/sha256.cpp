@@ -8,6 +8,7 @@
 #include <fc/variant.hpp>
 #include <fc/exception/exception.hpp>
 #include "_digest_common.hpp"
+#include "_digest_batch.hpp"
 
 namespace fc {
 
@@ -53,6 +54,45 @@ namespace fc {
         return hash( s.data(), sizeof( s._hash ) );
     }
 
+    void sha256::hash_many( const digest_input* in, size_t count, sha256* out )
+    {
+      const detail::lane_kernel* k = count > 1 ? detail::sha256_lane_kernel() : nullptr;
+      if( k )
+         detail::hash_lanes( *k, in, count, out->data() );
+      else
+         for( size_t i = 0; i < count; ++i )
+            out[i] = hash( in[i].data, in[i].size );
+    }
+
+    std::vector<sha256> sha256::hash_many( const std::vector<digest_input>& in )
+    {
+      std::vector<sha256> out( in.size() );
+      hash_many( in.data(), in.size(), out.data() );
+      return out;
+    }
+
+    sha256 sha256::merkle_root( const std::vector<sha256>& leaves )
+    {
+      if( leaves.empty() )
+         return sha256();
+      std::vector<sha256> level( leaves );
+      std::vector<sha256> parents;
+      std::vector<digest_input> pairs;
+      while( level.size() > 1 )
+      {
+         // the two children are next to each other in level
+         pairs.clear();
+         for( size_t i = 0; i + 1 < level.size(); i += 2 )
+            pairs.emplace_back( level[i].data(), 2 * sizeof(sha256) );
+         parents.resize( ( level.size() + 1 ) / 2 );
+         hash_many( pairs.data(), pairs.size(), parents.data() );
+         if( level.size() % 2 )
+            parents.back() = level.back();
+         level.swap( parents );
+      }
+      return level.front();
+    }
+
     void sha256::encoder::write( const char* d, uint32_t dlen ) {
       SHA256_Update( &my->ctx, d, dlen); 
     }
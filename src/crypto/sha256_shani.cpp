@@ -0,0 +1,157 @@
+#include "_digest_batch.hpp"
+
+#ifdef FC_DIGEST_BATCH_X86
+#include <boost/config.hpp>
+#include <immintrin.h>
+
+/* SHA-256 with the SHA extensions, built with -msha -msse4.1.  Two messages are hashed
+ * side by side so that the rounds of one fill the latency of the other's, each keeping its
+ * state in registers from block to block.
+ */
+namespace {
+
+   const uint32_t k[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+   };
+
+   /** one message, its state as the instructions want it, ABEF and CDGH */
+   struct shani_lane
+   {
+      __m128i abef;
+      __m128i cdgh;
+      __m128i abef_before;
+      __m128i cdgh_before;
+      __m128i m[4];
+
+      BOOST_FORCEINLINE void init()
+      {
+         abef = _mm_set_epi32( 0x6a09e667, 0xbb67ae85, 0x510e527f, 0x9b05688c );
+         cdgh = _mm_set_epi32( 0x3c6ef372, 0xa54ff53a, 0x1f83d9ab, 0x5be0cd19 );
+      }
+
+      BOOST_FORCEINLINE void begin_block( const unsigned char* block )
+      {
+         abef_before = abef;
+         cdgh_before = cdgh;
+         const __m128i swap = _mm_set_epi8( 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3 );
+         for( int i = 0; i < 4; ++i )
+            m[i] = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*)( block + 16 * i ) ), swap );
+      }
+
+      /** rounds 4 * g to 4 * g + 3, scheduling their message words first */
+      template<int g>
+      BOOST_FORCEINLINE void rounds()
+      {
+         if( g >= 4 )
+         {
+            const __m128i prev = m[(g + 3) & 3];
+            m[g & 3] = _mm_sha256msg2_epu32( _mm_add_epi32( _mm_sha256msg1_epu32( m[g & 3], m[(g + 1) & 3] ),
+                                                            _mm_alignr_epi8( prev, m[(g + 2) & 3], 4 ) ),
+                                             prev );
+         }
+         __m128i msg = _mm_add_epi32( m[g & 3], _mm_loadu_si128( (const __m128i*)( k + 4 * g ) ) );
+         cdgh = _mm_sha256rnds2_epu32( cdgh, abef, msg );
+         msg = _mm_shuffle_epi32( msg, 0x0e );
+         abef = _mm_sha256rnds2_epu32( abef, cdgh, msg );
+      }
+
+      BOOST_FORCEINLINE void end_block()
+      {
+         abef = _mm_add_epi32( abef, abef_before );
+         cdgh = _mm_add_epi32( cdgh, cdgh_before );
+      }
+
+      /** writes a to h big endian */
+      BOOST_FORCEINLINE void digest( char* out )const
+      {
+         const __m128i swap = _mm_set_epi8( 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3 );
+         const __m128i feba = _mm_shuffle_epi32( abef, 0x1b );
+         const __m128i dchg = _mm_shuffle_epi32( cdgh, 0xb1 );
+         const __m128i dcba = _mm_blend_epi16( feba, dchg, 0xf0 );
+         const __m128i hgfe = _mm_alignr_epi8( dchg, feba, 8 );
+         _mm_storeu_si128( (__m128i*)out, _mm_shuffle_epi8( dcba, swap ) );
+         _mm_storeu_si128( (__m128i*)( out + 16 ), _mm_shuffle_epi8( hgfe, swap ) );
+      }
+   };
+
+   /** the rounds from group g on, of one lane or of two side by side */
+   template<int g>
+   BOOST_FORCEINLINE void rounds_from( shani_lane& l )
+   {
+      l.rounds<g>();
+      rounds_from<g + 1>( l );
+   }
+
+   template<>
+   BOOST_FORCEINLINE void rounds_from<16>( shani_lane& ) {}
+
+   template<int g>
+   BOOST_FORCEINLINE void rounds_from( shani_lane& l0, shani_lane& l1 )
+   {
+      l0.rounds<g>();
+      l1.rounds<g>();
+      rounds_from<g + 1>( l0, l1 );
+   }
+
+   template<>
+   BOOST_FORCEINLINE void rounds_from<16>( shani_lane&, shani_lane& ) {}
+
+   /** finishes a message alone once its partner is done */
+   void finish( shani_lane& l, fc::detail::block_cursor& c )
+   {
+      do {
+         l.begin_block( c.next );
+         rounds_from<0>( l );
+         l.end_block();
+      } while( c.advance() );
+   }
+}
+
+namespace fc { namespace detail {
+
+   void sha256_hash_many_shani( const digest_input* in, size_t count, char* out )
+   {
+      block_cursor c0, c1;
+      shani_lane l0, l1;
+      size_t i = 0;
+      for( ; i + 1 < count; i += 2 )
+      {
+         c0.start( in[i], true );
+         c1.start( in[i + 1], true );
+         l0.init();
+         l1.init();
+         bool more0, more1;
+         do {
+            l0.begin_block( c0.next );
+            l1.begin_block( c1.next );
+            rounds_from<0>( l0, l1 );
+            l0.end_block();
+            l1.end_block();
+            more0 = c0.advance();
+            more1 = c1.advance();
+         } while( more0 && more1 );
+         if( more0 )
+            finish( l0, c0 );
+         if( more1 )
+            finish( l1, c1 );
+         l0.digest( out + 32 * i );
+         l1.digest( out + 32 * ( i + 1 ) );
+      }
+      if( i < count )
+      {
+         c0.start( in[i], true );
+         l0.init();
+         finish( l0, c0 );
+         l0.digest( out + 32 * i );
+      }
+   }
+
+} } // fc::detail
+#endif
@@ -178,7 +178,35 @@ namespace fc
       return writesome(buf.get() + offset, len);
     }
 
+    size_t buffered_ostream::writesome( const const_buffer_chain& chain, size_t offset )
+    {
+      const size_t copy_limit = 2048;
+      const size_t len = total_size( chain ) - offset;
+      if( len >= copy_limit )
+      {
+        write_buffered();
+        return my->_ostr->writesome( chain, offset );
+      }
+      for( const auto& slice : chain )
+      {
+        if( offset >= slice.size )
+        {
+          offset -= slice.size;
+          continue;
+        }
+        writesome( slice.data.get() + slice.offset + offset, slice.size - offset );
+        offset = 0;
+      }
+      return len;
+    }
+
     void  buffered_ostream::flush()
+    {
+        write_buffered();
+        my->_ostr->flush();
+    }
+
+    void  buffered_ostream::write_buffered()
     {
 #ifndef NDEBUG
         // This code was written with the assumption that you'd only be making one call to flush 
@@ -196,7 +224,6 @@ namespace fc
 
         while( size_t bytes_from_rdbuf = static_cast<size_t>(my->_rdbuf.sgetn(my->_shared_write_buffer.get(), write_buffer_size)) )
            my->_ostr->write( my->_shared_write_buffer, bytes_from_rdbuf );
-        my->_ostr->flush();
     }
 
     void  buffered_ostream::close()
@@ -380,4 +380,32 @@ namespace fc {
     return *this;
   }
 
+  size_t ostream::writesome( const const_buffer_chain& chain, size_t offset )
+  {
+    for( const auto& slice : chain )
+    {
+      if( offset < slice.size )
+        return writesome( slice.data, slice.size - offset, slice.offset + offset );
+      offset -= slice.size;
+    }
+    return 0;
+  }
+
+  ostream& ostream::write( const const_buffer_chain& chain )
+  {
+    const size_t len = total_size( chain );
+    size_t bytes_written = 0;
+    while( bytes_written < len )
+      bytes_written += writesome( chain, bytes_written );
+    return *this;
+  }
+
+  size_t total_size( const const_buffer_chain& chain )
+  {
+    size_t size = 0;
+    for( const auto& slice : chain )
+      size += slice.size;
+    return size;
+  }
+
 } // namespace fc
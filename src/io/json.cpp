@@ -6,12 +6,19 @@
 #include <fc/io/sstream.hpp>
 #include <fc/log/logger.hpp>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <fstream>
 #include <sstream>
 
 #include <boost/filesystem/fstream.hpp>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 namespace fc
 {
     // forward declarations of provided functions
@@ -26,11 +33,10 @@ namespace fc
     template<typename T, json::parse_type parser_type> variants arrayFromStream( T& in, uint32_t max_depth );
     template<typename T, json::parse_type parser_type> variant number_from_stream( T& in );
     template<typename T> variant token_from_stream( T& in );
-    void escape_string( const string& str, ostream& os );
-    template<typename T> void to_stream( T& os, const variants& a, json::output_formatting format, uint32_t max_depth );
-    template<typename T> void to_stream( T& os, const variant_object& o, json::output_formatting format, uint32_t max_depth );
-    template<typename T> void to_stream( T& os, const variant& v, json::output_formatting format, uint32_t max_depth );
     fc::string pretty_print( const fc::string& v, uint8_t indent );
+    namespace json_simd {
+       variant from_buffer( const char* data, size_t size, uint32_t max_depth, bool* only_whitespace_follows = nullptr );
+    }
 }
 
 #if __cplusplus > 201402L
@@ -457,6 +463,8 @@ namespace fc
 
    variant json::from_string( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    { try {
+      if( ptype == simd_parser )
+         return json_simd::from_buffer( utf8_str.data(), utf8_str.size(), max_depth );
       fc::istream_ptr in( new fc::stringstream( utf8_str ) );
       fc::buffered_istream bin( in );
       return from_stream( bin, ptype, max_depth );
@@ -474,172 +482,273 @@ namespace fc
       } FC_RETHROW_EXCEPTIONS( warn, "", ("str",utf8_str) )
    }
 
-   /**
-    *  Convert '\t', '\a', '\n', '\\' and '"'  to "\t\a\n\\\""
-    *
-    *  All other characters are printed as UTF8.
-    */
-   void escape_string( const string& str, ostream& os )
+   namespace
    {
-      os << '"';
-      for( auto itr = str.begin(); itr != str.end(); ++itr )
+      const char digit_pairs[] =
+         "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+         "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+         "8081828384858687888990919293949596979899";
+
+      /** writes @p v backwards from @p end, @return its first digit */
+      char* format_decimal( uint64_t v, char* end )
       {
-         switch( *itr )
+         while( v >= 100 )
          {
-            case '\b':        // \x08
-               os << "\\b";
-               break;
-            case '\f':        // \x0c
-               os << "\\f";
-               break;
-            case '\n':        // \x0a
-               os << "\\n";
-               break;
-            case '\r':        // \x0d
-               os << "\\r";
-               break;
-            case '\t':        // \x09
-               os << "\\t";
-               break;
-            case '\\':
-               os << "\\\\";
-               break;
-            case '\"':
-               os << "\\\"";
-               break;
-            case '\x00': os << "\\u0000"; break;
-            case '\x01': os << "\\u0001"; break;
-            case '\x02': os << "\\u0002"; break;
-            case '\x03': os << "\\u0003"; break;
-            case '\x04': os << "\\u0004"; break;
-            case '\x05': os << "\\u0005"; break;
-            case '\x06': os << "\\u0006"; break;
-            case '\x07': os << "\\u0007"; break; // \a is not valid JSON
-         // case '\x08': os << "\\u0008"; break; // \b
-         // case '\x09': os << "\\u0009"; break; // \t
-         // case '\x0a': os << "\\u000a"; break; // \n
-            case '\x0b': os << "\\u000b"; break;
-         // case '\x0c': os << "\\u000c"; break; // \f
-         // case '\x0d': os << "\\u000d"; break; // \r
-            case '\x0e': os << "\\u000e"; break;
-            case '\x0f': os << "\\u000f"; break;
-
-            case '\x10': os << "\\u0010"; break;
-            case '\x11': os << "\\u0011"; break;
-            case '\x12': os << "\\u0012"; break;
-            case '\x13': os << "\\u0013"; break;
-            case '\x14': os << "\\u0014"; break;
-            case '\x15': os << "\\u0015"; break;
-            case '\x16': os << "\\u0016"; break;
-            case '\x17': os << "\\u0017"; break;
-            case '\x18': os << "\\u0018"; break;
-            case '\x19': os << "\\u0019"; break;
-            case '\x1a': os << "\\u001a"; break;
-            case '\x1b': os << "\\u001b"; break;
-            case '\x1c': os << "\\u001c"; break;
-            case '\x1d': os << "\\u001d"; break;
-            case '\x1e': os << "\\u001e"; break;
-            case '\x1f': os << "\\u001f"; break;
+            const unsigned i = unsigned( v % 100 ) * 2;
+            v /= 100;
+            *--end = digit_pairs[i + 1];
+            *--end = digit_pairs[i];
+         }
+         if( v >= 10 )
+         {
+            const unsigned i = unsigned( v ) * 2;
+            *--end = digit_pairs[i + 1];
+            *--end = digit_pairs[i];
+         }
+         else
+            *--end = char( '0' + v );
+         return end;
+      }
+
+      inline bool needs_escape( char c )
+      {
+         return static_cast<unsigned char>( c ) < 0x20 || c == '"' || c == '\\';
+      }
 
+      /** @return the first character in [p, end) that has to be escaped, or end */
+      const char* find_escape( const char* p, const char* end )
+      {
+#if defined(__SSE2__) || defined(_M_X64)
+         const __m128i quote = _mm_set1_epi8( '"' );
+         const __m128i backslash = _mm_set1_epi8( '\\' );
+         const __m128i control = _mm_set1_epi8( 0x1f );
+         for( ; end - p >= 16; p += 16 )
+         {
+            const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+            const __m128i special = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( v, quote ), _mm_cmpeq_epi8( v, backslash ) ),
+                                                  _mm_cmpeq_epi8( _mm_max_epu8( v, control ), control ) );
+            const unsigned bits = unsigned( _mm_movemask_epi8( special ) );
+            if( bits )
+            {
+               while( !needs_escape( *p ) )
+                  ++p;
+               return p;
+            }
+         }
+#endif
+         while( p != end && !needs_escape( *p ) )
+            ++p;
+         return p;
+      }
+
+      /**
+       *  Appends the escape sequence of @p c: the short forms for '\b', '\f', '\n', '\r',
+       *  '\t', '\\' and '"', \u00XX for the other control characters.
+       */
+      void append_escaped( std::string& out, char c )
+      {
+         static const char hex[] = "0123456789abcdef";
+         switch( c )
+         {
+            case '\b': out.append( "\\b", 2 );  break;
+            case '\f': out.append( "\\f", 2 );  break;
+            case '\n': out.append( "\\n", 2 );  break;
+            case '\r': out.append( "\\r", 2 );  break;
+            case '\t': out.append( "\\t", 2 );  break;
+            case '\\': out.append( "\\\\", 2 ); break;
+            case '"':  out.append( "\\\"", 2 ); break;
             default:
-               os << *itr;
+            {
+               const char u[6] = { '\\', 'u', '0', '0', hex[ (c >> 4) & 0xf ], hex[ c & 0xf ] };
+               out.append( u, sizeof(u) );
+            }
          }
       }
-      os << '"';
    }
-   ostream& json::to_stream( ostream& out, const fc::string& str )
+
+   json::writer::writer( output_formatting format, uint32_t max_depth )
+   :_format(format), _max_depth(max_depth) {}
+
+   json::writer& json::writer::write( const variant& v )
    {
-        escape_string( str, out );
-        return out;
+      write( v, _max_depth );
+      return *this;
    }
 
-   template<typename T>
-   void to_stream( T& os, const variants& a, json::output_formatting format, uint32_t max_depth )
+   json::writer& json::writer::write( const variants& a )
    {
-      os << '[';
-      auto itr = a.begin();
+      write( a, _max_depth );
+      return *this;
+   }
 
-      while( itr != a.end() )
+   json::writer& json::writer::write( const variant_object& o )
+   {
+      write( o, _max_depth );
+      return *this;
+   }
+
+   json::writer& json::writer::write_string( const char* str, size_t size )
+   {
+      const char* const end = str + size;
+      _buffer.reserve( _buffer.size() + size + 2 );
+      _buffer += '"';
+      while( true )
       {
-         to_stream( os, *itr, format, max_depth );
-         ++itr;
-         if( itr != a.end() )
-            os << ',';
+         const char* special = find_escape( str, end );
+         _buffer.append( str, special );
+         if( special == end )
+            break;
+         append_escaped( _buffer, *special );
+         str = special + 1;
       }
-      os << ']';
+      _buffer += '"';
+      return *this;
    }
-   template<typename T>
-   void to_stream( T& os, const variant_object& o, json::output_formatting format, uint32_t max_depth )
+
+   std::string json::writer::release()
    {
-       os << '{';
-       auto itr = o.begin();
+      std::string result;
+      result.swap( _buffer );
+      return result;
+   }
 
-       while( itr != o.end() )
-       {
-          escape_string( itr->key(), os );
-          os << ':';
-          to_stream( os, itr->value(), format, max_depth );
-          ++itr;
-          if( itr != o.end() )
-             os << ',';
-       }
-       os << '}';
+   json::writer& json::writer::write_null()
+   {
+      _buffer.append( "null", 4 );
+      return *this;
    }
 
-   template<typename T>
-   void to_stream( T& os, const variant& v, json::output_formatting format, uint32_t max_depth )
+   json::writer& json::writer::write_bool( bool b )
+   {
+      if( b )
+         _buffer.append( "true", 4 );
+      else
+         _buffer.append( "false", 5 );
+      return *this;
+   }
+
+   json::writer& json::writer::write_int64( int64_t i )
+   {
+      char digits[24];
+      char* end = digits + sizeof(digits);
+      char* begin = format_decimal( i < 0 ? 0 - uint64_t(i) : uint64_t(i), end );
+      if( i < 0 )
+         *--begin = '-';
+      write_number( begin, end, _format == stringify_large_ints_and_doubles && ( i > INT32_MAX || i < INT32_MIN ) );
+      return *this;
+   }
+
+   json::writer& json::writer::write_uint64( uint64_t u )
+   {
+      char digits[24];
+      char* end = digits + sizeof(digits);
+      write_number( format_decimal( u, end ), end, _format == stringify_large_ints_and_doubles && u > 0xffffffff );
+      return *this;
+   }
+
+   json::writer& json::writer::write_double( double d )
+   {
+      // same format as fc::to_string(double), without the stringstream
+      char digits[512];
+      const int n = snprintf( digits, sizeof(digits), "%.*f", std::numeric_limits<double>::digits10 + 2, d );
+      write_number( digits, digits + n, _format == stringify_large_ints_and_doubles );
+      return *this;
+   }
+
+   json::writer& json::writer::write_key( const char* name )
+   {
+      write_string( name, strlen( name ) );
+      _buffer += ':';
+      return *this;
+   }
+
+   void json::writer::write_number( const char* begin, const char* end, bool quoted )
+   {
+      if( quoted )
+         _buffer += '"';
+      _buffer.append( begin, end );
+      if( quoted )
+         _buffer += '"';
+   }
+
+   void json::writer::write( const variants& a, uint32_t max_depth )
+   {
+      _buffer += '[';
+      for( auto itr = a.begin(); itr != a.end(); ++itr )
+      {
+         if( itr != a.begin() )
+            _buffer += ',';
+         write( *itr, max_depth );
+      }
+      _buffer += ']';
+   }
+
+   void json::writer::write( const variant_object& o, uint32_t max_depth )
+   {
+      _buffer += '{';
+      for( auto itr = o.begin(); itr != o.end(); ++itr )
+      {
+         if( itr != o.begin() )
+            _buffer += ',';
+         write_string( itr->key() );
+         _buffer += ':';
+         write( itr->value(), max_depth );
+      }
+      _buffer += '}';
+   }
+
+   void json::writer::write( const variant& v, uint32_t max_depth )
    {
       FC_ASSERT( max_depth > 0, "Too many nested objects!" );
       switch( v.get_type() )
       {
          case variant::null_type:
-              os << "null";
+              write_null();
               return;
          case variant::int64_type:
-              if( format == json::stringify_large_ints_and_doubles &&
-                  ( v.as_int64() > INT32_MAX || v.as_int64() < INT32_MIN ) )
-                 os << '"'<<v.as_string()<<'"';
-              else
-                 os << v.as_int64();
+              write_int64( v.as_int64() );
               return;
          case variant::uint64_type:
-              if( format == json::stringify_large_ints_and_doubles &&
-                  v.as_uint64() > 0xffffffff )
-                 os << '"'<<v.as_string()<<'"';
-              else
-                 os << v.as_uint64();
+              write_uint64( v.as_uint64() );
               return;
          case variant::double_type:
-              if (format == json::stringify_large_ints_and_doubles)
-                 os << '"'<<v.as_string()<<'"';
-              else
-                 os << v.as_string();
+              write_double( v.as_double() );
               return;
          case variant::bool_type:
-              os << v.as_string();
+              write_bool( v.as_bool() );
               return;
          case variant::string_type:
-              escape_string( v.get_string(), os );
+              {
+                 const boost::string_view str = v.get_string_view();
+                 write_string( str.data(), str.size() );
+              }
               return;
          case variant::blob_type:
-              escape_string( v.as_string(), os );
+              write_string( v.as_string() );
               return;
          case variant::array_type:
-              to_stream( os, v.get_array(), format, max_depth - 1 );
+              write( v.get_array(), max_depth - 1 );
               return;
          case variant::object_type:
-              to_stream(os, v.get_object(), format, max_depth - 1 );
+              write( v.get_object(), max_depth - 1 );
               return;
          default:
             FC_THROW_EXCEPTION( fc::invalid_arg_exception, "Unsupported variant type: " + v.get_type() );
       }
    }
 
+   ostream& json::to_stream( ostream& out, const fc::string& str )
+   {
+      writer w;
+      w.write_string( str );
+      return out.write( w.data(), w.size() );
+   }
+
    fc::string   json::to_string( const variant& v, output_formatting format, uint32_t max_depth )
    {
-      fc::stringstream ss;
-      fc::to_stream( ss, v, format, max_depth );
-      return ss.str();
+      writer w( format, max_depth );
+      w.write( v );
+      return w.release();
    }
 
 
@@ -748,12 +857,20 @@ namespace fc
       }
       else
       {
+       json::writer w( format, max_depth );
+       w.write( v );
        fc::ofstream o(fi);
-       fc::to_stream( o, v, format, max_depth );
+       o.write( w.data(), w.size() );
       }
    }
    variant json::from_file( const fc::path& p, parse_type ptype, uint32_t max_depth )
    {
+      if( ptype == simd_parser )
+      {
+         std::string content;
+         read_file_contents( p, content );
+         return json_simd::from_buffer( content.data(), content.size(), max_depth );
+      }
       fc::istream_ptr in( new fc::ifstream( p ) );
       fc::buffered_istream bin( in );
       return from_stream( bin, ptype, max_depth );
@@ -774,6 +891,23 @@ namespace fc
 #endif
           case broken_nul_parser:
               return variant_from_stream<fc::buffered_istream, broken_nul_parser>( in, max_depth );
+          case simd_parser:
+          {
+              std::string content;
+              char chunk[4096];
+              try
+              {
+                 while( true )
+                    content.append( chunk, in.readsome( chunk, sizeof(chunk) ) );
+              }
+              catch( const eof_exception& )
+              { // EOF ends the input
+              }
+              catch( const std::ios_base::failure& )
+              { // read error ends the input
+              }
+              return json_simd::from_buffer( content.data(), content.size(), max_depth );
+          }
           default:
               FC_ASSERT( false, "Unknown JSON parser type {ptype}", ("ptype", ptype) );
       }
@@ -781,23 +915,32 @@ namespace fc
 
    ostream& json::to_stream( ostream& out, const variant& v, output_formatting format, uint32_t max_depth )
    {
-      fc::to_stream( out, v, format, max_depth );
-      return out;
+      writer w( format, max_depth );
+      w.write( v );
+      return out.write( w.data(), w.size() );
    }
    ostream& json::to_stream( ostream& out, const variants& v, output_formatting format, uint32_t max_depth )
    {
-      fc::to_stream( out, v, format, max_depth );
-      return out;
+      writer w( format, max_depth );
+      w.write( v );
+      return out.write( w.data(), w.size() );
    }
    ostream& json::to_stream( ostream& out, const variant_object& v, output_formatting format, uint32_t max_depth )
    {
-      fc::to_stream( out, v, format, max_depth );
-      return out;
+      writer w( format, max_depth );
+      w.write( v );
+      return out.write( w.data(), w.size() );
    }
 
    bool json::is_valid( const std::string& utf8_str, parse_type ptype, uint32_t max_depth )
    {
       if( utf8_str.size() == 0 ) return false;
+      if( ptype == simd_parser )
+      {
+         bool only_whitespace_follows;
+         json_simd::from_buffer( utf8_str.data(), utf8_str.size(), max_depth, &only_whitespace_follows );
+         return only_whitespace_follows;
+      }
       fc::istream_ptr in( new fc::stringstream( utf8_str ) );
       fc::buffered_istream bin( in );
       from_stream( bin, ptype, max_depth );
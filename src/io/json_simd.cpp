@@ -0,0 +1,639 @@
+#include <fc/io/json.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/string.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define FC_JSON_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define FC_JSON_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ *  json::simd_parser works in two passes over a contiguous buffer.
+ *
+ *  Stage 1 classifies the input 64 bytes at a time with SSE2 or AVX2 (chosen at run time)
+ *  and records the offset of every structural character: brackets, braces, colons and
+ *  commas outside of strings, every unescaped quote and the first byte of every number or
+ *  literal.  Stage 2 walks that index and builds the variants directly, without copying
+ *  tokens into a stream first; strings without escapes are copied in one go.
+ */
+
+namespace fc { namespace json_simd {
+
+   namespace {
+
+      const size_t block_size = 64;
+
+      /** one bit per byte of a block for each class of characters stage 1 looks for */
+      struct block_masks
+      {
+         uint64_t backslash;
+         uint64_t quote;
+         uint64_t op;          ///< { } [ ] : ,
+         uint64_t whitespace;  ///< space \t \n \r
+         uint64_t eol;         ///< \r \n \x04, which the strict parser refuses inside strings
+      };
+
+      inline unsigned trailing_zeros( uint64_t v )
+      {
+#ifdef _MSC_VER
+         unsigned long i;
+         _BitScanForward64( &i, v );
+         return unsigned(i);
+#else
+         return unsigned( __builtin_ctzll( v ) );
+#endif
+      }
+
+      void classify_scalar( const char* in, block_masks& m )
+      {
+         m = block_masks();
+         for( size_t i = 0; i < block_size; ++i )
+         {
+            const uint64_t bit = uint64_t(1) << i;
+            switch( in[i] )
+            {
+               case '\\':
+                  m.backslash |= bit;
+                  break;
+               case '"':
+                  m.quote |= bit;
+                  break;
+               case '{': case '}': case '[': case ']': case ':': case ',':
+                  m.op |= bit;
+                  break;
+               case ' ': case '\t':
+                  m.whitespace |= bit;
+                  break;
+               case '\n': case '\r':
+                  m.whitespace |= bit;
+                  m.eol |= bit;
+                  break;
+               case '\x04':
+                  m.eol |= bit;
+                  break;
+               default:
+                  break;
+            }
+         }
+      }
+
+#ifdef FC_JSON_SIMD_SSE2
+      inline __m128i eq_sse2( __m128i v, char c ) { return _mm_cmpeq_epi8( v, _mm_set1_epi8( c ) ); }
+      inline uint64_t bits_sse2( __m128i v ) { return uint16_t( _mm_movemask_epi8( v ) ); }
+
+      void classify_sse2( const char* in, block_masks& m )
+      {
+         m = block_masks();
+         for( size_t i = 0; i < block_size; i += 16 )
+         {
+            const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( in + i ) );
+            const __m128i op = _mm_or_si128( _mm_or_si128( _mm_or_si128( eq_sse2( v, '{' ), eq_sse2( v, '}' ) ),
+                                                           _mm_or_si128( eq_sse2( v, '[' ), eq_sse2( v, ']' ) ) ),
+                                             _mm_or_si128( eq_sse2( v, ':' ), eq_sse2( v, ',' ) ) );
+            const __m128i eol = _mm_or_si128( eq_sse2( v, '\n' ), eq_sse2( v, '\r' ) );
+            const __m128i ws = _mm_or_si128( eol, _mm_or_si128( eq_sse2( v, ' ' ), eq_sse2( v, '\t' ) ) );
+            m.backslash  |= bits_sse2( eq_sse2( v, '\\' ) ) << i;
+            m.quote      |= bits_sse2( eq_sse2( v, '"' ) ) << i;
+            m.op         |= bits_sse2( op ) << i;
+            m.whitespace |= bits_sse2( ws ) << i;
+            m.eol        |= bits_sse2( _mm_or_si128( eol, eq_sse2( v, '\x04' ) ) ) << i;
+         }
+      }
+#endif
+
+#ifdef FC_JSON_SIMD_AVX2
+      __attribute__((target("avx2"))) inline __m256i eq_avx2( __m256i v, char c ) { return _mm256_cmpeq_epi8( v, _mm256_set1_epi8( c ) ); }
+      __attribute__((target("avx2"))) inline uint64_t bits_avx2( __m256i v ) { return uint32_t( _mm256_movemask_epi8( v ) ); }
+
+      __attribute__((target("avx2"))) void classify_avx2( const char* in, block_masks& m )
+      {
+         m = block_masks();
+         for( size_t i = 0; i < block_size; i += 32 )
+         {
+            const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( in + i ) );
+            const __m256i op = _mm256_or_si256( _mm256_or_si256( _mm256_or_si256( eq_avx2( v, '{' ), eq_avx2( v, '}' ) ),
+                                                                 _mm256_or_si256( eq_avx2( v, '[' ), eq_avx2( v, ']' ) ) ),
+                                                _mm256_or_si256( eq_avx2( v, ':' ), eq_avx2( v, ',' ) ) );
+            const __m256i eol = _mm256_or_si256( eq_avx2( v, '\n' ), eq_avx2( v, '\r' ) );
+            const __m256i ws = _mm256_or_si256( eol, _mm256_or_si256( eq_avx2( v, ' ' ), eq_avx2( v, '\t' ) ) );
+            m.backslash  |= bits_avx2( eq_avx2( v, '\\' ) ) << i;
+            m.quote      |= bits_avx2( eq_avx2( v, '"' ) ) << i;
+            m.op         |= bits_avx2( op ) << i;
+            m.whitespace |= bits_avx2( ws ) << i;
+            m.eol        |= bits_avx2( _mm256_or_si256( eol, eq_avx2( v, '\x04' ) ) ) << i;
+         }
+      }
+#endif
+
+      typedef void (*classifier)( const char*, block_masks& );
+
+      classifier select_classifier()
+      {
+#ifdef FC_JSON_SIMD_AVX2
+         __builtin_cpu_init();
+         if( __builtin_cpu_supports( "avx2" ) )
+            return classify_avx2;
+#endif
+#ifdef FC_JSON_SIMD_SSE2
+         return classify_sse2;
+#else
+         return classify_scalar;
+#endif
+      }
+
+      /**
+       *  @return the bits of the bytes escaped by a backslash.  @p carry is 1 when the first
+       *  byte of the block is escaped, and is set for the next block.  Backslashes are rare,
+       *  so this only loops over the ones there are.
+       */
+      inline uint64_t escaped_bits( uint64_t backslash, uint64_t& carry )
+      {
+         uint64_t escaped = carry;
+         backslash &= ~carry;
+         carry = 0;
+         while( backslash )
+         {
+            const unsigned i = trailing_zeros( backslash );
+            if( i == 63 )
+            {
+               carry = 1;
+               break;
+            }
+            const uint64_t next = uint64_t(2) << i;
+            escaped |= next;
+            backslash &= ~( next | ( next >> 1 ) );
+         }
+         return escaped;
+      }
+
+      /** bit i of the result is the parity of bits 0..i of @p v */
+      inline uint64_t prefix_xor( uint64_t v )
+      {
+         v ^= v << 1;
+         v ^= v << 2;
+         v ^= v << 4;
+         v ^= v << 8;
+         v ^= v << 16;
+         v ^= v << 32;
+         return v;
+      }
+
+      struct structural_index
+      {
+         std::vector<uint32_t> positions;
+         /** offset of the first \r, \n or \x04 inside a string, or npos */
+         size_t                first_eol_in_string = std::string::npos;
+      };
+
+      void build_index( const char* data, size_t size, structural_index& idx )
+      {
+         static const classifier classify = select_classifier();
+
+         idx.positions.reserve( size / 8 + 16 );
+         uint64_t prev_escaped = 0;
+         uint64_t prev_in_string = 0;
+         uint64_t prev_scalar = 0;
+         block_masks m;
+         char tail[block_size];
+         for( size_t base = 0; base < size; base += block_size )
+         {
+            const char* block = data + base;
+            if( size - base < block_size )
+            {
+               memset( tail, ' ', block_size );
+               memcpy( tail, block, size - base );
+               block = tail;
+            }
+            classify( block, m );
+
+            const uint64_t escaped = escaped_bits( m.backslash, prev_escaped );
+            const uint64_t quotes = m.quote & ~escaped;
+            // includes the opening quote of each string but not the closing one
+            const uint64_t in_string = prefix_xor( quotes ) ^ prev_in_string;
+            prev_in_string = uint64_t( int64_t( in_string ) >> 63 );
+
+            const uint64_t scalar = ~( m.op | m.whitespace | quotes | in_string );
+            const uint64_t scalar_starts = scalar & ~( ( scalar << 1 ) | prev_scalar );
+            prev_scalar = scalar >> 63;
+
+            const uint64_t eol = m.eol & in_string & ~escaped;
+            if( eol && idx.first_eol_in_string == std::string::npos )
+               idx.first_eol_in_string = base + trailing_zeros( eol );
+
+            uint64_t structurals = ( m.op & ~in_string ) | quotes | scalar_starts;
+            while( structurals )
+            {
+               idx.positions.push_back( uint32_t( base + trailing_zeros( structurals ) ) );
+               structurals &= structurals - 1;
+            }
+         }
+      }
+
+      inline bool is_digit( char c ) { return c >= '0' && c <= '9'; }
+
+      /** characters that may follow a number or a literal */
+      inline bool ends_scalar( char c )
+      {
+         switch( c )
+         {
+            case ' ': case '\t': case '\n': case '\r':
+            case '{': case '}': case '[': case ']': case ':': case ',':
+               return true;
+            default:
+               return false;
+         }
+      }
+
+      /** stage 2: builds variants from the structural index */
+      class decoder
+      {
+         public:
+            decoder( const char* data, size_t size, const structural_index& idx )
+            :_data(data), _end(data + size), _idx(idx), _next(0), _count(idx.positions.size()) {}
+
+            variant value( uint32_t max_depth )
+            {
+               if( max_depth == 0 )
+                  FC_THROW_EXCEPTION( parse_error_exception, "Too many nested items in JSON input!" );
+               if( _next == _count )
+                  FC_THROW_EXCEPTION( eof_exception, "unexpected end of file" );
+               const char c = _data[ _idx.positions[_next] ];
+               switch( c )
+               {
+                  case '"':
+                     return string_value();
+                  case '{':
+                     return object( max_depth - 1 );
+                  case '[':
+                     return array( max_depth - 1 );
+                  case 'n':
+                  case 't':
+                  case 'f':
+                     return word();
+                  case '-':
+                  case '0': case '1': case '2': case '3': case '4':
+                  case '5': case '6': case '7': case '8': case '9':
+                     return number();
+                  default:
+                     FC_THROW_EXCEPTION( parse_error_exception, "Unexpected char '${c}' at offset ${o}",
+                                         ("c", std::string( 1, c ))("o", _idx.positions[_next]) );
+               }
+            }
+
+            /** @return true if nothing but whitespace follows what has been decoded */
+            bool at_end()const { return _next == _count; }
+
+            /** @return the character at the next structural position */
+            char current()const
+            {
+               if( _next == _count )
+                  FC_THROW_EXCEPTION( parse_error_exception, "Unexpected EOF" );
+               return _data[ _idx.positions[_next] ];
+            }
+
+            void advance() { ++_next; }
+
+            std::string string_value()
+            {
+               // nothing inside a string is structural, so the next position is the closing quote
+               if( _next + 1 == _count )
+                  FC_THROW_EXCEPTION( parse_error_exception, "unexpected EOF in string" );
+               const size_t open = _idx.positions[_next];
+               const size_t close = _idx.positions[_next + 1];
+               _next += 2;
+
+               const char* begin = _data + open + 1;
+               const char* end = _data + close;
+               if( _idx.first_eol_in_string > open && _idx.first_eol_in_string < close )
+                  FC_THROW_EXCEPTION( parse_error_exception, "unexpected EOL in string '${token}'",
+                                      ("token", std::string( begin, _data + _idx.first_eol_in_string )) );
+
+               const char* escape = static_cast<const char*>( memchr( begin, '\\', end - begin ) );
+               if( !escape )
+                  return std::string( begin, end );
+
+               std::string result;
+               result.reserve( end - begin );
+               result.append( begin, escape );
+               // the closing quote is not escaped, so every backslash is followed by a character
+               for( const char* p = escape; p < end; ++p )
+               {
+                  if( *p != '\\' )
+                  {
+                     result += *p;
+                     continue;
+                  }
+                  switch( *++p )
+                  {
+                     case 't':
+                        result += '\t';
+                        break;
+                     case 'n':
+                        result += '\n';
+                        break;
+                     case 'r':
+                        result += '\r';
+                        break;
+                     default:
+                        result += *p;
+                        break;
+                  }
+               }
+               return result;
+            }
+
+            variant object( uint32_t max_depth )
+            {
+               mutable_variant_object obj;
+               ++_next;
+               if( current() == '}' )
+               {
+                  ++_next;
+                  return variant_object( std::move( obj ) );
+               }
+               while( true )
+               {
+                  if( current() != '"' )
+                     FC_THROW_EXCEPTION( parse_error_exception, "Expected '\"' at offset ${o}", ("o", _idx.positions[_next]) );
+                  std::string key = string_value();
+                  if( current() != ':' )
+                     FC_THROW_EXCEPTION( parse_error_exception, "Expected ':' after key \"${key}\"", ("key", key) );
+                  ++_next;
+                  variant val = value( max_depth );
+                  obj( std::move( key ), std::move( val ) );
+
+                  const char c = current();
+                  ++_next;
+                  if( c == '}' )
+                     return variant_object( std::move( obj ) );
+                  if( c != ',' )
+                     FC_THROW_EXCEPTION( parse_error_exception, "Expected ',' or '}' after ${variant}", ("variant", obj) );
+               }
+            }
+
+            variant array( uint32_t max_depth )
+            {
+               variants ar;
+               ++_next;
+               if( current() == ']' )
+               {
+                  ++_next;
+                  return variant( std::move( ar ) );
+               }
+               while( true )
+               {
+                  ar.push_back( value( max_depth ) );
+
+                  const char c = current();
+                  ++_next;
+                  if( c == ']' )
+                     return variant( std::move( ar ) );
+                  if( c != ',' )
+                     FC_THROW_EXCEPTION( parse_error_exception, "Expected ',' or ']' after parsing ${variant}", ("variant", ar) );
+               }
+            }
+
+            variant word()
+            {
+               const char* p = _data + _idx.positions[_next++];
+               const size_t avail = _end - p;
+               variant result;
+               size_t length;
+               if( avail >= 4 && memcmp( p, "null", 4 ) == 0 )
+                  length = 4;
+               else if( avail >= 4 && memcmp( p, "true", 4 ) == 0 )
+               {
+                  result = true;
+                  length = 4;
+               }
+               else if( avail >= 5 && memcmp( p, "false", 5 ) == 0 )
+               {
+                  result = false;
+                  length = 5;
+               }
+               else
+                  length = 0;
+               if( length == 0 || ( length < avail && !ends_scalar( p[length] ) ) )
+                  FC_THROW_EXCEPTION( parse_error_exception, "expected: null|true|false" );
+               return result;
+            }
+
+            /**
+             *  Integers become int64 when negative and uint64 otherwise, like in the strict
+             *  parser, including its "-0" being an unsigned 0.  Numbers with a fraction or an
+             *  exponent are doubles.
+             */
+            variant number()
+            {
+               static const uint64_t INT64_MAX_PLUS_ONE = static_cast<uint64_t>(INT64_MAX) + 1;
+
+               const char* const start = _data + _idx.positions[_next++];
+               const char* p = start;
+               const bool negative = *p == '-';
+               if( negative )
+                  ++p;
+
+               const char* const digits = p;
+               uint64_t val = 0;
+               bool overflow = false;
+               for( ; p < _end && is_digit( *p ); ++p )
+               {
+                  const uint64_t digit = uint64_t( *p - '0' );
+                  if( val > ( UINT64_MAX - digit ) / 10 )
+                     overflow = true;
+                  val = val * 10 + digit;
+               }
+               if( p == digits )
+                  FC_THROW_EXCEPTION( parse_error_exception, "illegal character in token" );
+               if( *digits == '0' && p - digits > 1 )
+                  FC_THROW_EXCEPTION( parse_error_exception, "expected '.'|'e'|'E' parsing number, got '0'" );
+
+               bool real = false;
+               if( p < _end && *p == '.' )
+               {
+                  const char* fraction = ++p;
+                  while( p < _end && is_digit( *p ) )
+                     ++p;
+                  if( p == fraction )
+                     FC_THROW_EXCEPTION( parse_error_exception, "expected digit after '.'" );
+                  real = true;
+               }
+               if( p < _end && ( *p == 'e' || *p == 'E' ) )
+               {
+                  ++p;
+                  if( p < _end && ( *p == '+' || *p == '-' ) )
+                     ++p;
+                  const char* exponent = p;
+                  while( p < _end && is_digit( *p ) )
+                     ++p;
+                  if( p == exponent )
+                     FC_THROW_EXCEPTION( parse_error_exception, "expected exponent after 'e'|'E' parsing number" );
+                  real = true;
+               }
+               if( p < _end && !ends_scalar( *p ) )
+                  FC_THROW_EXCEPTION( parse_error_exception, "illegal character '${c}' in number", ("c", std::string( 1, *p )) );
+
+               if( real )
+                  return variant( fc::to_double( std::string( start, p ) ) );
+               if( overflow )
+                  FC_THROW_EXCEPTION( parse_error_exception, "integer literal overflow" );
+               if( negative && val != 0 )
+               {
+                  if( val > INT64_MAX_PLUS_ONE )
+                     FC_THROW_EXCEPTION( parse_error_exception, "negative integer literal overflow" );
+                  if( val == INT64_MAX_PLUS_ONE )
+                     return variant( INT64_MIN );
+                  return variant( -static_cast<int64_t>( val ) );
+               }
+               return variant( val );
+            }
+
+         private:
+            const char*                _data;
+            const char*                _end;
+            const structural_index&    _idx;
+            size_t                     _next;
+            size_t                     _count;
+      };
+
+   } // anonymous namespace
+} // namespace json_simd
+
+   namespace detail
+   {
+      class json_reader_impl
+      {
+         public:
+            json_reader_impl( const char* data, size_t size )
+            :dec( data, size, build( data, size ) ) {}
+
+            const json_simd::structural_index& build( const char* data, size_t size )
+            {
+               FC_ASSERT( size <= UINT32_MAX, "JSON input of ${size} bytes is too large for the simd parser", ("size", size) );
+               json_simd::build_index( data, size, idx );
+               return idx;
+            }
+
+            json_simd::structural_index idx;
+            json_simd::decoder          dec;
+      };
+   }
+
+   json::reader::reader( const char* data, size_t size )
+   :my( new detail::json_reader_impl( data, size ) ) {}
+
+   json::reader::~reader() {}
+
+   char json::reader::peek()const
+   {
+      return my->dec.current();
+   }
+
+   bool json::reader::at_end()const
+   {
+      return my->dec.at_end();
+   }
+
+   variant json::reader::read_variant( uint32_t max_depth )
+   {
+      return my->dec.value( max_depth );
+   }
+
+   std::string json::reader::read_string()
+   {
+      if( my->dec.current() != '"' )
+         FC_THROW_EXCEPTION( parse_error_exception, "Expected '\"', got '${c}'", ("c", std::string( 1, my->dec.current() )) );
+      return my->dec.string_value();
+   }
+
+   bool json::reader::read_null()
+   {
+      if( my->dec.current() != 'n' )
+         return false;
+      my->dec.word();
+      return true;
+   }
+
+   bool json::reader::begin_object()
+   {
+      if( my->dec.current() != '{' )
+         FC_THROW_EXCEPTION( parse_error_exception, "Expected '{', got '${c}'", ("c", std::string( 1, my->dec.current() )) );
+      my->dec.advance();
+      if( my->dec.current() != '}' )
+         return true;
+      my->dec.advance();
+      return false;
+   }
+
+   std::string json::reader::read_key()
+   {
+      std::string key = read_string();
+      if( my->dec.current() != ':' )
+         FC_THROW_EXCEPTION( parse_error_exception, "Expected ':' after key \"${key}\"", ("key", key) );
+      my->dec.advance();
+      return key;
+   }
+
+   bool json::reader::next_member()
+   {
+      const char c = my->dec.current();
+      my->dec.advance();
+      if( c == '}' )
+         return false;
+      if( c != ',' )
+         FC_THROW_EXCEPTION( parse_error_exception, "Expected ',' or '}', got '${c}'", ("c", std::string( 1, c )) );
+      return true;
+   }
+
+   bool json::reader::begin_array()
+   {
+      if( my->dec.current() != '[' )
+         FC_THROW_EXCEPTION( parse_error_exception, "Expected '[', got '${c}'", ("c", std::string( 1, my->dec.current() )) );
+      my->dec.advance();
+      if( my->dec.current() != ']' )
+         return true;
+      my->dec.advance();
+      return false;
+   }
+
+   bool json::reader::next_element()
+   {
+      const char c = my->dec.current();
+      my->dec.advance();
+      if( c == ']' )
+         return false;
+      if( c != ',' )
+         FC_THROW_EXCEPTION( parse_error_exception, "Expected ',' or ']', got '${c}'", ("c", std::string( 1, c )) );
+      return true;
+   }
+
+namespace json_simd {
+   variant from_buffer( const char* data, size_t size, uint32_t max_depth, bool* only_whitespace_follows )
+   {
+      FC_ASSERT( size <= UINT32_MAX, "JSON input of ${size} bytes is too large for the simd parser", ("size", size) );
+      structural_index idx;
+      build_index( data, size, idx );
+      decoder d( data, size, idx );
+      variant result = d.value( max_depth );
+      if( only_whitespace_follows )
+         *only_whitespace_follows = d.at_end();
+      return result;
+   }
+
+} // namespace json_simd
+} // namespace fc
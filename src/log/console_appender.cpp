@@ -114,7 +114,7 @@ namespace fc {
          line << std::setw( 20 ) << std::left << m.get_context().get_method().substr(p,20).c_str() <<" ";
       }
       line << "] ";
-      fc::string message = fc::format_string( m.get_format(), m.get_data(), my->cfg.max_object_depth );
+      fc::string message = m.get_message( my->cfg.max_object_depth );
       line << message;
 
       fc::unique_lock<boost::mutex> lock(log_mutex());
@@ -1,6 +1,8 @@
 #include <fc/exception/exception.hpp>
 #include <fc/io/fstream.hpp>
 #include <fc/log/file_appender.hpp>
+#include <fc/log/log_message.hpp>
+#include <fc/optional.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/thread/scoped_lock.hpp>
 #include <fc/thread/thread.hpp>
@@ -8,7 +10,11 @@
 #ifdef FC_USE_FULL_ZLIB
 # include <fc/compress/zlib.hpp>
 #endif
+#include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <queue>
 #include <sstream>
@@ -18,6 +24,74 @@ namespace fc {
 
    static const string compression_extension( ".gz" );
 
+   namespace detail {
+      /** messages queued by one thread for the writer thread of the async mode, which formats them */
+      class message_ring
+      {
+         public:
+            explicit message_ring( uint32_t capacity )
+            {
+               size_t size = 1;
+               while( size < capacity )
+                  size <<= 1;
+               _messages.resize( size );
+            }
+
+            /** called by the owning thread only */
+            bool push( const log_message& m )
+            {
+               const size_t tail = _tail.load( std::memory_order_relaxed );
+               if( tail - _head.load( std::memory_order_acquire ) == _messages.size() )
+                  return false;
+               _messages[tail & ( _messages.size() - 1 )] = m;
+               _tail.store( tail + 1, std::memory_order_release );
+               return true;
+            }
+
+            /** called by the writer thread only, @return the number of messages passed to @p f */
+            template<typename F>
+            size_t pop_all( F&& f )
+            {
+               size_t head = _head.load( std::memory_order_relaxed );
+               const size_t tail = _tail.load( std::memory_order_acquire );
+               for( size_t i = head; i != tail; ++i )
+               {
+                  optional<log_message>& m = _messages[i & ( _messages.size() - 1 )];
+                  f( *m );
+                  m.reset();
+               }
+               _head.store( tail, std::memory_order_release );
+               return tail - head;
+            }
+
+            bool half_full()const
+            {
+               return _tail.load( std::memory_order_relaxed ) - _head.load( std::memory_order_relaxed ) > _messages.size() / 2;
+            }
+
+            /** set when the owning thread exits, the writer then forgets the ring once it is empty */
+            std::atomic<bool>                   abandoned{ false };
+
+         private:
+            std::vector< optional<log_message> > _messages;
+            std::atomic<size_t>                 _head{ 0 };
+            std::atomic<size_t>                 _tail{ 0 };
+      };
+
+      /** the rings of the calling thread, by appender */
+      struct thread_message_rings
+      {
+         ~thread_message_rings()
+         {
+            for( auto& r : rings )
+               r.second->abandoned = true;
+         }
+         std::vector< std::pair< uint64_t, std::shared_ptr<message_ring> > > rings;
+      };
+      static thread_local thread_message_rings local_message_rings;
+      static std::atomic<uint64_t> next_appender_id{ 1 };
+   }
+
    class file_appender::impl : public fc::retainable
    {
       public:
@@ -25,6 +99,20 @@ namespace fc {
          ofstream                   out;
          boost::mutex               slock;
 
+         // async mode
+         const uint64_t                                   id = detail::next_appender_id++;
+         boost::mutex                                     rings_lock;
+         std::vector< std::shared_ptr<detail::message_ring> > rings;
+         boost::thread                                    writer;
+         boost::mutex                                     wake_lock;
+         boost::condition_variable                        wake;
+         std::atomic<bool>                                wake_requested{ false };
+         std::atomic<bool>                                stopping{ false };
+         std::atomic<uint64_t>                            written{ 0 };
+         std::atomic<uint64_t>                            dropped{ 0 };
+         std::atomic<uint64_t>                            waits{ 0 };
+         std::atomic<uint64_t>                            writes{ 0 };
+
       private:
          future<void>               _rotation_task;
          time_point_sec             _current_file_start_time;
@@ -78,6 +166,12 @@ namespace fc {
 
          ~impl()
          {
+            if( writer.joinable() )
+            {
+               stopping = true;
+               request_write();
+               writer.join();
+            }
             try
             {
               _rotation_task.cancel_and_wait("file_appender is destructing");
@@ -87,6 +181,105 @@ namespace fc {
             }
          }
 
+         void start_writer()
+         {
+            FC_ASSERT( cfg.async_flush_interval > microseconds() && cfg.async_queue_size > 0 );
+            writer = boost::thread( [this]() { write_loop(); } );
+         }
+
+         void request_write()
+         {
+            wake_requested = true;
+            fc::scoped_lock<boost::mutex> lock( wake_lock );
+            wake.notify_one();
+         }
+
+         detail::message_ring& local_ring()
+         {
+            auto& local = detail::local_message_rings.rings;
+            for( auto& r : local )
+               if( r.first == id )
+                  return *r.second;
+            auto ring = std::make_shared<detail::message_ring>( cfg.async_queue_size );
+            {
+               fc::scoped_lock<boost::mutex> lock( rings_lock );
+               rings.push_back( ring );
+            }
+            local.emplace_back( id, ring );
+            return *ring;
+         }
+
+         /** queues @p m on the ring of the calling thread, as config::async_overflow says when it is full */
+         void enqueue( const log_message& m )
+         {
+            detail::message_ring& ring = local_ring();
+            if( !ring.push( m ) )
+            {
+               if( cfg.async_overflow == overflow::drop )
+               {
+                  ++dropped;
+                  return;
+               }
+               ++waits;
+               request_write();
+               while( !ring.push( m ) )
+                  boost::this_thread::sleep_for( boost::chrono::microseconds( 50 ) );
+            }
+            if( ring.half_full() && !wake_requested.load( std::memory_order_relaxed ) )
+               request_write();
+         }
+
+         void write_loop()
+         {
+            const boost::chrono::microseconds interval( cfg.async_flush_interval.count() );
+            std::stringstream batch;
+            std::vector< std::shared_ptr<detail::message_ring> > current;
+            bool stop = false;
+            while( !stop )
+            {
+               {
+                  boost::unique_lock<boost::mutex> lock( wake_lock );
+                  if( !wake_requested )
+                     wake.wait_for( lock, interval );
+                  wake_requested = false;
+               }
+               // lines logged before stopping are still written
+               stop = stopping;
+
+               {
+                  fc::scoped_lock<boost::mutex> lock( rings_lock );
+                  current = rings;
+               }
+               size_t lines = 0;
+               for( auto& ring : current )
+               {
+                  const bool abandoned = ring->abandoned;
+                  lines += ring->pop_all( [this,&batch]( const log_message& m ) { format_line( m, batch ); } );
+                  if( abandoned )
+                  {
+                     fc::scoped_lock<boost::mutex> lock( rings_lock );
+                     rings.erase( std::find( rings.begin(), rings.end(), ring ) );
+                  }
+               }
+               current.clear();
+               if( lines == 0 )
+                  continue;
+
+               {
+                  const std::string text = batch.str();
+                  fc::scoped_lock<boost::mutex> lock( slock );
+                  out.write( text.data(), text.size() );
+                  if( cfg.flush )
+                     out.flush();
+               }
+               written += lines;
+               ++writes;
+               batch.str( std::string() );
+            }
+         }
+
+         void format_line( const log_message& m, std::ostream& line )const;
+
          void rotate_files( bool initializing = false )
          {
              FC_ASSERT( cfg.rotate );
@@ -181,6 +374,8 @@ namespace fc {
          if(!my->cfg.rotate)
             my->out.open( my->cfg.filename, std::ios_base::out | std::ios_base::app);
 
+         if( my->cfg.async )
+            my->start_writer();
       }
       catch( ... )
       {
@@ -190,10 +385,37 @@ namespace fc {
 
    file_appender::~file_appender(){}
 
-   // MS THREAD METHOD  MESSAGE \t\t\t File:Line
+   file_appender::async_stats file_appender::get_async_stats()const
+   {
+      async_stats stats;
+      stats.written = my->written;
+      stats.dropped = my->dropped;
+      stats.waits = my->waits;
+      stats.writes = my->writes;
+      return stats;
+   }
+
    void file_appender::log( const log_message& m )
    {
+      if( my->cfg.async )
+      {
+        my->enqueue( m );
+        return;
+      }
+
       std::stringstream line;
+      my->format_line( m, line );
+      {
+        fc::scoped_lock<boost::mutex> lock( my->slock );
+        my->out << line.str();
+        if( my->cfg.flush )
+          my->out.flush();
+      }
+   }
+
+   // MS THREAD METHOD  MESSAGE \t\t\t File:Line
+   void file_appender::impl::format_line( const log_message& m, std::ostream& line )const
+   {
       //line << (m.get_context().get_timestamp().time_since_epoch().count() % (1000ll*1000ll*60ll*60))/1000 <<"ms ";
       //line << string(m.get_context().get_timestamp()) << " ";
       time_point timestamp = m.get_context().get_timestamp();
@@ -218,15 +440,9 @@ namespace fc {
       }
 
       line << "] ";
-      fc::string message = fc::format_string( m.get_format(), m.get_data(), my->cfg.max_object_depth );
+      fc::string message = m.get_message( cfg.max_object_depth );
       line << message.c_str();
-
-      {
-        fc::scoped_lock<boost::mutex> lock( my->slock );
-        my->out << line.str() << "\t\t\t" << m.get_context().get_file() << ":" << m.get_context().get_line_number() << "\n";
-        if( my->cfg.flush )
-          my->out.flush();
-      }
+      line << "\t\t\t" << m.get_context().get_file() << ":" << m.get_context().get_line_number() << "\n";
    }
 
 } // fc
@@ -24,6 +24,42 @@ namespace fc
             string       hostname;
             string       context;
             time_point   timestamp;
+
+            // set instead of the strings above by the constructor used by FC_LOG_CONTEXT
+            const char*  file_name = nullptr;
+            const char*  method_name = nullptr;
+            const char*  task_desc = nullptr;
+      };
+
+      /** an argument of a log message, as it was given */
+      struct log_arg_value
+      {
+         enum kind_type : uint8_t { int_kind, uint_kind, double_kind, bool_kind, string_kind, variant_kind };
+
+         boost::string_view   name;
+         kind_type            kind;
+         union
+         {
+            int64_t              i;
+            uint64_t             u;
+            double               d;
+            bool                 b;
+            const variant*       v;
+         };
+         boost::string_view   str;
+
+         variant to_variant()const
+         {
+            switch( kind )
+            {
+               case int_kind:    return variant( i );
+               case uint_kind:   return variant( u );
+               case double_kind: return variant( d );
+               case bool_kind:   return variant( b );
+               case string_kind: return variant( std::string( str.data(), str.size() ) );
+               default:          return *v;
+            }
+         }
       };
 
       class log_message_impl
@@ -33,10 +69,116 @@ namespace fc
             :context( std::move(ctx) ){}
             log_message_impl(){}
 
+            ~log_message_impl()
+            {
+               for( size_t i = 0; i < arg_count; ++i )
+                  if( arg( i ).kind == log_arg_value::variant_kind )
+                     arg( i ).v->~variant();
+            }
+
             log_context     context;
-            string          format;
+            boost::string_view format;
+            string          format_storage;
             variant_object  args;
+
+            // the arguments added by FC_LOG_MESSAGE, their names and strings are in the arena
+            static const size_t inline_args = 6;
+            static const size_t arena_size = 256;
+
+            log_arg_value                        first_args[inline_args];
+            std::vector<log_arg_value>           more_args;
+            size_t                               arg_count = 0;
+            alignas(variant) char                arena[arena_size];
+            size_t                               arena_used = 0;
+            std::vector< std::unique_ptr<char[]> > spilled;
+
+            const log_arg_value& arg( size_t i )const { return i < inline_args ? first_args[i] : more_args[i - inline_args]; }
+
+            /** @return @p size bytes aligned for a variant, from the arena while it has room */
+            char* allocate( size_t size )
+            {
+               const size_t aligned = ( size + alignof(variant) - 1 ) & ~( alignof(variant) - 1 );
+               if( arena_used + aligned <= arena_size )
+               {
+                  char* result = arena + arena_used;
+                  arena_used += aligned;
+                  return result;
+               }
+               spilled.emplace_back( new char[aligned] );
+               return spilled.back().get();
+            }
+
+            boost::string_view copy( boost::string_view s )
+            {
+               if( s.empty() )
+                  return boost::string_view();
+               char* data = allocate( s.size() );
+               memcpy( data, s.data(), s.size() );
+               return boost::string_view( data, s.size() );
+            }
+
+            log_arg_value& add( boost::string_view name, log_arg_value::kind_type kind )
+            {
+               log_arg_value value;
+               value.name = copy( name );
+               value.kind = kind;
+               if( arg_count < inline_args )
+                  first_args[arg_count] = value;
+               else
+                  more_args.push_back( value );
+               ++arg_count;
+               return arg_count <= inline_args ? first_args[arg_count - 1] : more_args.back();
+            }
+
+            const log_arg_value* find( boost::string_view name )const
+            {
+               for( size_t i = 0; i < arg_count; ++i )
+                  if( arg( i ).name == name )
+                     return &arg( i );
+               return nullptr;
+            }
       };
+
+      /** appends @p v as format_string does, objects and arrays as JSON */
+      static void append_variant( string& out, const variant& v, uint32_t max_object_depth )
+      {
+         if( v.is_object() || v.is_array() )
+         {
+            try
+            {
+               out += json::to_string( v, json::stringify_large_ints_and_doubles, max_object_depth );
+            }
+            catch( const fc::assert_exception& e )
+            {
+               out += "[\"ERROR_WHILE_CONVERTING_VALUE_TO_STRING\"]";
+            }
+         }
+         else
+            out += v.as_string();
+      }
+
+      static void append_arg( string& out, const log_arg_value& a, uint32_t max_object_depth )
+      {
+         switch( a.kind )
+         {
+            case log_arg_value::int_kind:    out += fc::to_string( a.i ); break;
+            case log_arg_value::uint_kind:   out += fc::to_string( a.u ); break;
+            case log_arg_value::double_kind: out += fc::to_string( a.d ); break;
+            case log_arg_value::bool_kind:   out += a.b ? "true" : "false"; break;
+            case log_arg_value::string_kind: out.append( a.str.data(), a.str.size() ); break;
+            default:                         append_variant( out, *a.v, max_object_depth );
+         }
+      }
+
+      /** @return the file name without its directories, as fc::path::filename() */
+      static const char* file_name_of( const char* file )
+      {
+         const char* name = file;
+         for( const char* c = file; *c; ++c )
+            if( *c == '/' || *c == '\\' )
+               name = c + 1;
+         return name;
+      }
    }
 
 
@@ -49,13 +191,14 @@ namespace fc
    :my( std::make_shared<detail::log_context_impl>() )
    {
       my->level       = ll;
-      my->file        = fc::path(file).filename().generic_string(); // TODO truncate filename
+      my->file_name   = detail::file_name_of( file );
       my->line        = line;
-      my->method      = method;
+      my->method_name = method;
       my->timestamp   = time_point::now();
-      my->thread_name = fc::thread::current().name();
-      const char* current_task_desc = fc::thread::current().current_task_desc();
-      my->task_name   = current_task_desc ? current_task_desc : "?unnamed?";
+      fc::thread& current = fc::thread::current();
+      my->thread_name = current.name();
+      const char* current_task_desc = current.current_task_desc();
+      my->task_desc   = current_task_desc ? current_task_desc : "?unnamed?";
    }
 
    log_context::log_context( const variant& v, uint32_t max_depth )
@@ -77,7 +220,7 @@ namespace fc
 
    fc::string log_context::to_string()const
    {
-      return my->thread_name + "  " + my->file + ":" + fc::to_string(my->line) + " " + my->method;
+      return my->thread_name + "  " + get_file() + ":" + fc::to_string(my->line) + " " + get_method();
 
    }
 
@@ -152,11 +295,11 @@ namespace fc
 
 
 
-   string     log_context::get_file()const       { return my->file; }
+   string     log_context::get_file()const       { return my->file_name ? string( my->file_name ) : my->file; }
    uint64_t   log_context::get_line_number()const { return my->line; }
-   string     log_context::get_method()const     { return my->method; }
+   string     log_context::get_method()const     { return my->method_name ? string( my->method_name ) : my->method; }
    string     log_context::get_thread_name()const { return my->thread_name; }
-   string     log_context::get_task_name()const { return my->task_name; }
+   string     log_context::get_task_name()const { return my->task_desc ? string( my->task_desc ) : my->task_name; }
    string     log_context::get_host_name()const   { return my->hostname; }
    time_point  log_context::get_timestamp()const  { return my->timestamp; }
    log_level  log_context::get_log_level()const{ return my->level;   }
@@ -167,9 +310,9 @@ namespace fc
    {
       mutable_variant_object o;
               o( "level",        variant(my->level, max_depth) )
-               ( "file",         my->file                )
+               ( "file",         get_file()              )
                ( "line",         my->line                )
-               ( "method",       my->method              )
+               ( "method",       get_method()            )
                ( "hostname",     my->hostname            )
                ( "thread_name",  my->thread_name         )
                ( "timestamp",    variant(my->timestamp, max_depth) );
@@ -187,14 +330,22 @@ namespace fc
    log_message::log_message( log_context ctx, std::string format, variant_object args )
    :my( std::make_shared<detail::log_message_impl>(std::move(ctx)) )
    {
-      my->format  = std::move(format);
+      my->format_storage = std::move(format);
+      my->format  = my->format_storage;
       my->args    = std::move(args);
    }
 
+   log_message::log_message( log_context ctx, const char* format )
+   :my( std::make_shared<detail::log_message_impl>(std::move(ctx)) )
+   {
+      my->format = my->copy( format );
+   }
+
    log_message::log_message( const variant& v, uint32_t max_depth )
    :my( std::make_shared<detail::log_message_impl>( log_context( v.get_object()["context"], max_depth ) ) )
    {
-      my->format = v.get_object()["format"].as_string();
+      my->format_storage = v.get_object()["format"].as_string();
+      my->format = my->format_storage;
       my->args   = v.get_object()["data"].get_object();
    }
 
@@ -202,17 +353,96 @@ namespace fc
    {
       return limited_mutable_variant_object(max_depth)
                           ( "context", my->context )
-                          ( "format",  my->format )
-                          ( "data",    my->args   );
+                          ( "format",  get_format() )
+                          ( "data",    get_data() );
+   }
+
+   void log_message::add_int( boost::string_view name, int64_t value )
+   {
+      my->add( name, detail::log_arg_value::int_kind ).i = value;
+   }
+
+   void log_message::add_uint( boost::string_view name, uint64_t value )
+   {
+      my->add( name, detail::log_arg_value::uint_kind ).u = value;
+   }
+
+   void log_message::add_double( boost::string_view name, double value )
+   {
+      my->add( name, detail::log_arg_value::double_kind ).d = value;
+   }
+
+   void log_message::add_bool( boost::string_view name, bool value )
+   {
+      my->add( name, detail::log_arg_value::bool_kind ).b = value;
+   }
+
+   void log_message::add_string( boost::string_view name, boost::string_view value )
+   {
+      const boost::string_view copied = my->copy( value );
+      my->add( name, detail::log_arg_value::string_kind ).str = copied;
+   }
+
+   void log_message::add_variant( boost::string_view name, variant value )
+   {
+      variant* v = new( my->allocate( sizeof(variant) ) ) variant( std::move(value) );
+      my->add( name, detail::log_arg_value::variant_kind ).v = v;
    }
 
    log_context    log_message::get_context()const { return my->context; }
-   string         log_message::get_format()const  { return my->format;  }
-   variant_object log_message::get_data()const    { return my->args;    }
+   string         log_message::get_format()const  { return string( my->format.data(), my->format.size() ); }
 
-   string        log_message::get_message()const
+   variant_object log_message::get_data()const
    {
-      return format_string( my->format, my->args );
+      if( my->arg_count == 0 )
+         return my->args;
+      mutable_variant_object data( my->args );
+      for( size_t i = 0; i < my->arg_count; ++i )
+         data( string( my->arg( i ).name.data(), my->arg( i ).name.size() ), my->arg( i ).to_variant() );
+      return data;
+   }
+
+   string        log_message::get_message( uint32_t max_object_depth )const
+   {
+      // same substitution as format_string(), straight from the arguments
+      const boost::string_view format = my->format;
+      string result;
+      result.reserve( format.size() + 16 * my->arg_count );
+      size_t prev = 0;
+      size_t next = format.find( '$' );
+      while( prev < format.size() )
+      {
+         result.append( format.data() + prev, ( next == boost::string_view::npos ? format.size() : next ) - prev );
+         if( next == boost::string_view::npos || next + 1 >= format.size() )
+         {
+            if( next != boost::string_view::npos )
+               result += '$';
+            return result;
+         }
+
+         prev = next + 1;
+         if( format[prev] == '{' )
+         {
+            next = format.find( '}', prev );
+            if( next != boost::string_view::npos )
+            {
+               const boost::string_view key = format.substr( prev + 1, next - prev - 1 );
+               auto val = my->args.size() ? my->args.find( string( key.data(), key.size() ) ) : my->args.end();
+               const detail::log_arg_value* a = nullptr;
+               if( val != my->args.end() )
+                  detail::append_variant( result, val->value(), max_object_depth );
+               else if( ( a = my->find( key ) ) != nullptr )
+                  detail::append_arg( result, *a, max_object_depth );
+               else
+                  result.append( "${" ).append( key.data(), key.size() ).append( "}" );
+               prev = next + 1;
+            }
+         }
+         else
+            result += format[next];
+         next = format.find( '$', prev );
+      }
+      return result;
    }
 
 
@@ -8,23 +8,55 @@
 #include <fc/log/logger.hpp>
 #include <fc/io/stdio.hpp>
 #include <fc/network/url.hpp>
+#include <fc/thread/thread.hpp>
 #include <boost/algorithm/string.hpp>
-#include <boost/range/algorithm_ext/push_back.hpp>
 
 class fc::http::connection::impl 
 {
   public:
    fc::tcp_socket sock;
    fc::ip::endpoint ep;
-   impl() {}
+   impl() : read_pos(0) {}
+
+   /**
+    *  Bytes received but not consumed yet.  Reading through this buffer instead of one
+    *  byte per readsome() also keeps the start of pipelined requests for the next read.
+    */
+   std::vector<char> read_buffer;
+   size_t            read_pos;
+
+   /** reads whatever the socket has, @pre the buffer has been consumed */
+   void fill()
+   {
+     read_buffer.resize( 1024 * 8 );
+     read_pos = 0;
+     try
+     {
+       read_buffer.resize( sock.readsome( read_buffer.data(), read_buffer.size() ) );
+     }
+     catch( ... )
+     {
+       read_buffer.clear();
+       throw;
+     }
+   }
+
+   void reset_buffer()
+   {
+     read_buffer.clear();
+     read_pos = 0;
+   }
 
    size_t read_until(std::shared_ptr<char> buffer, size_t buffer_length, char c = '\n') 
    {
      size_t offset = 0;
-     while (offset < buffer_length && 
-         sock.readsome(buffer, 1, offset) == 1) 
+     while (offset < buffer_length)
      {
-       if (buffer.get()[offset] == c)
+       while( read_pos == read_buffer.size() )
+         fill();
+       const char next = read_buffer[read_pos++];
+       buffer.get()[offset] = next;
+       if (next == c)
        {
          buffer.get()[offset] = 0;
          return offset;
@@ -34,6 +66,15 @@ class fc::http::connection::impl
      return offset;
    }
 
+   void read( char* data, size_t length )
+   {
+     const size_t buffered = std::min( length, read_buffer.size() - read_pos );
+     std::copy( read_buffer.data() + read_pos, read_buffer.data() + read_pos + buffered, data );
+     read_pos += buffered;
+     if( buffered < length )
+       sock.read( data + buffered, length - buffered );
+   }
+
    fc::http::reply parse_reply() 
    {
       fc::http::reply rep;
@@ -87,9 +128,9 @@ class fc::http::connection::impl
             content_length = length;
             if (*content_length)
             {
-              std::shared_ptr<char> temp_data(new char[*content_length], [](char* p){ delete[] p; });
-              sock.read(temp_data, *content_length, 0);
-              boost::push_back(rep.body, std::make_pair(temp_data.get(), temp_data.get() + *content_length));
+              const size_t offset = rep.body.size();
+              rep.body.resize( offset + *content_length );
+              read( rep.body.data() + offset, *content_length );
               read_until(line, buffer_length, '\n'); //discard cr/lf after each chunk 
             }
           }
@@ -100,9 +141,8 @@ class fc::http::connection::impl
         {
           if (*content_length)
           {
-            std::shared_ptr<char> temp_data(new char[*content_length], [](char* p){ delete[] p; });
-            sock.read(temp_data, *content_length, 0);
-            boost::push_back(rep.body, std::make_pair(temp_data.get(), temp_data.get() + *content_length));
+            rep.body.resize( *content_length );
+            read( rep.body.data(), *content_length );
           }
         }
         else //just read until closed if no content length or chunking
@@ -111,8 +151,8 @@ class fc::http::connection::impl
           {
             try
             {
-              sock.read(line, 1, 0);
-              rep.body.push_back(line.get()[0]);
+              rep.body.insert( rep.body.end(), read_buffer.begin() + read_pos, read_buffer.end() );
+              fill();
             }
             catch (const fc::canceled_exception&)
             {
@@ -157,6 +197,7 @@ connection::~connection(){}
 void connection::connect_to( const fc::ip::endpoint& ep ) 
 {
   my->sock.close();
+  my->reset_buffer();
   my->sock.connect_to( my->ep = ep );
 }
 
@@ -170,6 +211,7 @@ http::reply connection::request( const fc::string& method,
   if( !my->sock.is_open() ) 
   {
     wlog( "Re-open socket!" );
+    my->reset_buffer();
     my->sock.connect_to( my->ep );
   }
   try 
@@ -184,23 +226,16 @@ http::reply connection::request( const fc::string& method,
       req << "Content-Length: "<< body.size() << "\r\n";
     req << "\r\n"; 
 
+    // header and body in one write, see server::response
     {
       fc::string head = req.str();
+      head += body;
       std::shared_ptr<char> write_buffer(new char[head.size()], [](char* p){ delete[] p; });
       std::copy(head.begin(), head.end(), write_buffer.get());
       my->sock.write(write_buffer, head.size(), 0);
       //elog("Sending header ${head}", ("head", head));
       //  fc::cerr.write( head.c_str() );
     }
-
-    if( body.size() )  
-    {
-      std::shared_ptr<char> write_buffer(new char[body.size()], [](char* p){ delete[] p; });
-      std::copy(body.begin(), body.end(), write_buffer.get());
-      my->sock.write(write_buffer, body.size(), 0);
-      //elog("Sending body ${body}", ("body", body));
-      //fc::cerr.write( body.c_str() );
-    }
     // fc::cerr.flush();
 
     return my->parse_reply();
@@ -233,6 +268,9 @@ http::request connection::read_request()const {
   bytes_read = my->read_until(line, buffer_length, ' '); // PATH
   req.path = std::string(line.get(), bytes_read);
   bytes_read = my->read_until(line, buffer_length, '\n'); // HTTP/1.0
+  req.version = std::string(line.get(), bytes_read);
+  if( req.version.size() && req.version.back() == '\r' )
+    req.version.erase( req.version.size() - 1 );
   
   while( (bytes_read = my->read_until(line, buffer_length, '\n')) > 1 ) 
   {
@@ -263,15 +301,45 @@ http::request connection::read_request()const {
   // Transfer-Encoding: chunked.  handle that here.
 
   if( req.body.size() )
-  {
-    std::shared_ptr<char> body_buffer(new char[req.body.size()], [](char* p){ delete[] p; });
-    my->sock.read(body_buffer, req.body.size(), 0);
-    std::copy(body_buffer.get(), body_buffer.get() + req.body.size(), req.body.data());
-  }
+    my->read( req.body.data(), req.body.size() );
 
   return req;
 }
 
+bool connection::wait_for_request( const fc::microseconds& timeout )const {
+  if( my->read_pos < my->read_buffer.size() )
+    return true;
+  fc::future<void> filled = fc::async( [this](){ my->fill(); }, "http wait_for_request" );
+  fc::exception_ptr canceled;
+  try
+  {
+    filled.wait( timeout );
+    return my->read_pos < my->read_buffer.size();
+  }
+  catch( const fc::canceled_exception& e )
+  {
+    canceled = e.dynamic_copy_exception();
+  }
+  catch( const fc::exception& )
+  {
+  }
+  // the fill task reads into this connection, it has to end before the caller can free it
+  my->sock.close();
+  while( !filled.ready() )
+  {
+    try
+    {
+      filled.wait();
+    }
+    catch( const fc::exception& )
+    {
+    }
+  }
+  if( canceled )
+    canceled->dynamic_rethrow_exception();
+  return false;
+}
+
 fc::string request::get_header( const fc::string& key )const 
 {
   for( auto itr = headers.begin(); itr != headers.end(); ++itr )
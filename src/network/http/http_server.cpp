@@ -5,6 +5,8 @@
 #include <fc/network/ip.hpp>
 #include <fc/io/stdio.hpp>
 #include <fc/log/logger.hpp>
+#include <boost/algorithm/string.hpp>
+#include <map>
 
 
 namespace fc { namespace http {
@@ -12,11 +14,25 @@ namespace fc { namespace http {
   class server::response::impl : public fc::retainable
   {
     public:
-      impl( const fc::http::connection_ptr& c, const std::function<void()>& cont = std::function<void()>() )
-      :body_bytes_sent(0),body_length(0),con(c),handle_next_req(cont)
+      impl( const fc::http::connection_ptr& c, const std::function<void()>& cont = std::function<void()>(),
+            bool keep = false )
+      :body_bytes_sent(0),body_length(0),con(c),handle_next_req(cont),keep_alive(keep),
+       completed(new fc::promise<bool>("http response"))
       {}
 
-      void send_header() 
+      /** a response dropped before all of its body was written ends its connection */
+      ~impl()
+      {
+         if( !completed->ready() )
+            completed->set_value( false );
+      }
+
+      /**
+       *  Sends the header followed by the first @p len bytes of the body in one write, a
+       *  separate small write would wait for the delayed ACK of the header on kept-alive
+       *  connections.
+       */
+      void send_header( const char* data = nullptr, uint64_t len = 0 ) 
       {
          //ilog( "sending header..." );
          fc::stringstream ss;
@@ -39,10 +55,21 @@ namespace fc { namespace http {
               ss << "Internal Server Error\r\n"; 
               break;
          }
+         bool has_connection_header = false;
          for( uint32_t i = 0; i < rep.headers.size(); ++i ) 
+         {
             ss << rep.headers[i].key << ": " << rep.headers[i].val << "\r\n";
+            if( boost::iequals( rep.headers[i].key, "Connection" ) )
+            {
+               has_connection_header = true;
+               keep_alive = keep_alive && boost::iequals( rep.headers[i].val, "keep-alive" );
+            }
+         }
+         if( !has_connection_header )
+            ss << "Connection: " << ( keep_alive ? "keep-alive" : "close" ) << "\r\n";
          ss << "Content-Length: " << body_length << "\r\n\r\n";
          std::string s = ss.str();
+         s.append( data, static_cast<size_t>(len) );
          std::shared_ptr<char> write_buffer(new char[s.size()], [](char* p){ delete[] p; });
          std::copy(s.begin(), s.end(), write_buffer.get());
          
@@ -55,6 +82,9 @@ namespace fc { namespace http {
       uint64_t              body_length;
       http::connection_ptr      con;
       std::function<void()> handle_next_req;
+      bool                  keep_alive;
+      /** set once the whole body has been written, to whether the connection stays open */
+      fc::promise<bool>::ptr completed;
   };
 
 
@@ -63,7 +93,8 @@ namespace fc { namespace http {
     public:
       impl(){}
 
-      impl(const fc::ip::endpoint& p ) 
+      impl(const fc::ip::endpoint& p, const fc::microseconds& idle, uint32_t max_cons )
+      :idle_timeout(idle),max_connections(max_cons)
       {
         tcp_serv.set_reuse_address();
         tcp_serv.listen(p);
@@ -72,21 +103,40 @@ namespace fc { namespace http {
 
       ~impl() 
       {
+        stopping = true;
         try
         {
           tcp_serv.close();
+        }
+        catch (...) 
+        {
+        }
+        // the accept loop may be waiting for a connection to finish, end those first
+        if( connection_finished && !connection_finished->ready() )
+          connection_finished->set_value();
+        cancel_connections();
+        try
+        {
           if (accept_complete.valid())
             accept_complete.wait();
         }
         catch (...) 
         {
         }
+        // in case the accept loop took one more connection before it saw stopping
+        cancel_connections();
+      }
 
-        for (fc::future<void>& request_in_progress : requests_in_progress)
+      void cancel_connections()
+      {
+        // connections remove themselves from the map when they finish
+        std::map<uint64_t, fc::future<void>> in_progress;
+        in_progress.swap( requests_in_progress );
+        for (auto& request_in_progress : in_progress)
         {
           try
           {
-            request_in_progress.cancel_and_wait();
+            request_in_progress.second.cancel_and_wait();
           }
           catch (const fc::exception& e)
           {
@@ -101,37 +151,66 @@ namespace fc { namespace http {
             wlog("Caught unknown exception while canceling http request task");
           }
         }
-        requests_in_progress.clear();
       }
 
       void accept_loop() 
       {
-        while( !accept_complete.canceled() )
+        while( !accept_complete.canceled() && !stopping )
         {
+          // leave further connections in the listen backlog until one finishes
+          while( max_connections && requests_in_progress.size() >= max_connections && !stopping )
+          {
+            connection_finished = new fc::promise<void>( "http_server connection finished" );
+            connection_finished->wait();
+            connection_finished.reset();
+          }
+          if( stopping )
+            return;
           http::connection_ptr con = std::make_shared<http::connection>();
           tcp_serv.accept( con->get_socket() );
           //ilog( "Accept Connection" );
-          // clean up futures for any completed requests
-          for (auto iter = requests_in_progress.begin(); iter != requests_in_progress.end();)
-            if (!iter->valid() || iter->ready())
-              iter = requests_in_progress.erase(iter);
-            else
-              ++iter;
-          requests_in_progress.emplace_back(fc::async([=](){ handle_connection(con, on_req); }, "http_server handle_connection"));
+          const uint64_t id = next_connection_id++;
+          requests_in_progress[id] = fc::async([=](){
+             handle_connection(con, on_req);
+             requests_in_progress.erase( id );
+             if( connection_finished && !connection_finished->ready() )
+               connection_finished->set_value();
+          }, "http_server handle_connection");
         }
       }
 
+      /**
+       *  Serves the requests of a connection one after the other, so pipelined requests
+       *  are answered in order, until the client or a response asks to close it or it is
+       *  idle for longer than idle_timeout.
+       */
       void handle_connection( const http::connection_ptr& c,  
                               std::function<void(const http::request&, const server::response& s )> do_on_req ) 
       {
         try 
         {
-          http::server::response rep( fc::shared_ptr<response::impl>( new response::impl(c) ) );
-          request req = c->read_request();
-          if( do_on_req ) 
-            do_on_req( req, rep );
+          while( c->wait_for_request( idle_timeout ) )
+          {
+            request req = c->read_request();
+            fc::shared_ptr<response::impl> rep_impl( new response::impl( c, std::function<void()>(), wants_keep_alive( req ) ) );
+            fc::promise<bool>::ptr completed = rep_impl->completed;
+            {
+              http::server::response rep( rep_impl );
+              rep_impl.reset();
+              if( do_on_req ) 
+                do_on_req( req, rep );
+            }
+            // the handler may still be writing the response from another task
+            if( !completed->wait() )
+              break;
+          }
           c->get_socket().close();
         } 
+        catch ( const fc::canceled_exception& ) 
+        {
+          // the server is going away, it no longer tracks this connection
+          throw;
+        }
         catch ( fc::exception& e ) 
         {
           wlog( "unable to read request ${1}", ("1", e.to_detail_string() ) );//fc::except_str().c_str());
@@ -139,16 +218,32 @@ namespace fc { namespace http {
         //wlog( "done handle connection" );
       }
 
+      /** HTTP/1.1 keeps connections by default, HTTP/1.0 only when asked to */
+      static bool wants_keep_alive( const http::request& req )
+      {
+        if( req.body.size() && req.get_header( "Transfer-Encoding" ).size() )
+          return false;
+        const fc::string connection = req.get_header( "Connection" );
+        if( req.version == "HTTP/1.0" )
+          return boost::iequals( connection, "keep-alive" );
+        return !boost::iequals( connection, "close" );
+      }
+
       fc::future<void>                                                      accept_complete;
       std::function<void(const http::request&, const server::response& s)>  on_req;
-      std::vector<fc::future<void> >                                        requests_in_progress;
+      std::map<uint64_t, fc::future<void>>                                  requests_in_progress;
+      uint64_t                                                              next_connection_id = 0;
+      fc::promise<void>::ptr                                                connection_finished;
+      fc::microseconds                                                      idle_timeout = fc::seconds(60);
+      uint32_t                                                              max_connections = 0;
+      bool                                                                  stopping = false;
       fc::tcp_server                                                        tcp_serv;
   };
 
 
 
   server::server():my( new impl() ){}
-  server::server( uint16_t port ) :my( new impl(fc::ip::endpoint( fc::ip::address(),port)) ){}
+  server::server( uint16_t port ) :my( new impl(fc::ip::endpoint( fc::ip::address(),port), fc::seconds(60), 0) ){}
   server::server( server&& s ):my(fc::move(s.my)){}
 
   server& server::operator=(server&& s)      { fc_swap(my,s.my); return *this; }
@@ -157,7 +252,19 @@ namespace fc { namespace http {
 
   void server::listen( const fc::ip::endpoint& p ) 
   {
-    my.reset( new impl(p) );
+    std::unique_ptr<impl> listening( new impl( p, my->idle_timeout, my->max_connections ) );
+    listening->on_req = my->on_req;
+    my = std::move( listening );
+  }
+
+  void server::set_idle_timeout( const fc::microseconds& timeout )
+  {
+    my->idle_timeout = timeout;
+  }
+
+  void server::set_max_connections( uint32_t max_connections )
+  {
+    my->max_connections = max_connections;
   }
 
   fc::ip::endpoint server::get_local_endpoint() const
@@ -195,13 +302,16 @@ namespace fc { namespace http {
       len = my->body_bytes_sent + len - my->body_length;
     }
     if( my->body_bytes_sent == 0 ) {
-      my->send_header();
+      my->send_header( data, len );
+    } else {
+      std::shared_ptr<char> write_buffer(new char[len], [](char* p){ delete[] p; });
+      std::copy(data, data + len, write_buffer.get());
+      my->con->get_socket().write(write_buffer, static_cast<size_t>(len), 0); 
     }
     my->body_bytes_sent += len;
-    std::shared_ptr<char> write_buffer(new char[len], [](char* p){ delete[] p; });
-    std::copy(data, data + len, write_buffer.get());
-    my->con->get_socket().write(write_buffer, static_cast<size_t>(len), 0); 
     if( my->body_bytes_sent == int64_t(my->body_length) ) {
+      if( !my->completed->ready() )
+        my->completed->set_value( my->keep_alive );
       if( false || my->handle_next_req ) {
         ilog( "handle next request..." );
         //fc::async( std::function<void()>(my->handle_next_req) );
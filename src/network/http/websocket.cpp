@@ -9,8 +9,15 @@
 #include <fc/optional.hpp>
 #include <fc/variant.hpp>
 #include <fc/thread/thread.hpp>
+#include <fc/thread/scoped_lock.hpp>
+#include <fc/thread/thread_pool.hpp>
 #include <fc/asio.hpp>
 
+#include <boost/thread/mutex.hpp>
+
+#include <algorithm>
+#include <atomic>
+
 #ifdef DEFAULT_LOGGER
 # undef DEFAULT_LOGGER
 #endif
@@ -163,6 +170,11 @@ namespace fc { namespace http {
                auto ec = _ws_connection->send( message );
                FC_ASSERT( !ec, "websocket send failed: ${msg}", ("msg",ec.message() ) );
             }
+            virtual void send_binary_message( const std::string& message )override
+            {
+               auto ec = _ws_connection->send( message, websocketpp::frame::opcode::binary );
+               FC_ASSERT( !ec, "websocket send failed: ${msg}", ("msg",ec.message() ) );
+            }
             virtual void close( int64_t code, const std::string& reason  )override
             {
                _ws_connection->close(code,reason);
@@ -173,21 +185,69 @@ namespace fc { namespace http {
               return _ws_connection->get_request_header(key);
             }
 
+            virtual std::string get_subprotocol()const override
+            {
+              return _ws_connection->get_subprotocol();
+            }
+
             T _ws_connection;
       };
 
       typedef websocketpp::lib::shared_ptr<boost::asio::ssl::context> context_ptr;
 
+      /** selects the first subprotocol the client asks for which is in @p supported */
+      template<typename Server>
+      void set_subprotocol_handler( Server& server, const std::vector<std::string>& supported )
+      {
+         server.set_validate_handler( [&server,&supported]( connection_hdl hdl ){
+            auto con = server.get_con_from_hdl( hdl );
+            for( const auto& requested : con->get_requested_subprotocols() )
+               if( std::find( supported.begin(), supported.end(), requested ) != supported.end() )
+               {
+                  con->select_subprotocol( requested );
+                  break;
+               }
+            return true;
+         });
+      }
+
       class websocket_server_impl
       {
          public:
-            websocket_server_impl()
+            /** a client of a server with a thread pool, and the thread serving it */
+            struct pooled_connection
+            {
+               websocket_connection_ptr  con;
+               fc::thread*               owner = nullptr;
+               std::atomic<uint32_t>     pending_messages{0};
+            };
+            typedef std::shared_ptr<pooled_connection> pooled_connection_ptr;
+
+            /** messages of one connection queued on its thread before the reader waits for them */
+            static const uint32_t max_pending_messages = 100;
+
+            websocket_server_impl( uint32_t thread_count = 0 )
             :_server_thread( fc::thread::current() )
             {
 
                _server.clear_access_channels( websocketpp::log::alevel::all );
                _server.init_asio(&fc::asio::default_io_service());
                _server.set_reuse_addr(true);
+               if( thread_count )
+                  set_pool_handlers( thread_count );
+               else
+                  set_server_thread_handlers();
+
+               _server.set_socket_init_handler( [&](websocketpp::connection_hdl hdl, boost::asio::ip::tcp::socket& s ) {
+                      boost::asio::ip::tcp::no_delay option(true);
+                      s.lowest_layer().set_option(option);
+               } );
+               set_subprotocol_handler( _server, _subprotocols );
+            }
+
+            /** runs every event on the thread that created the server */
+            void set_server_thread_handlers()
+            {
                _server.set_open_handler( [&]( connection_hdl hdl ){
                     _server_thread.async( [&](){
                        auto new_con = std::make_shared<websocket_connection_impl<websocket_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
@@ -209,11 +269,6 @@ namespace fc { namespace http {
                     }).wait();
                });
 
-               _server.set_socket_init_handler( [&](websocketpp::connection_hdl hdl, boost::asio::ip::tcp::socket& s ) {
-                      boost::asio::ip::tcp::no_delay option(true);
-                      s.lowest_layer().set_option(option);
-               } );
-
                _server.set_http_handler( [&]( connection_hdl hdl ){
                     _server_thread.async( [&](){
                        auto current_con = std::make_shared<websocket_connection_impl<websocket_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
@@ -269,29 +324,149 @@ namespace fc { namespace http {
                     }
                });
             }
+
+            /**
+             *  Pins every connection to the least loaded thread of a pool.  The asio threads
+             *  post its events to that thread without waiting for them, except for the open
+             *  event, so on_connection has installed the handlers before the first message.
+             */
+            void set_pool_handlers( uint32_t thread_count )
+            {
+               _pool.reset( new fc::thread_pool( thread_count, "websocket" ) );
+
+               _server.set_open_handler( [&]( connection_hdl hdl ){
+                    auto pc = std::make_shared<pooled_connection>();
+                    pc->owner = &_pool->least_loaded_thread();
+                    pc->con = std::make_shared<websocket_connection_impl<websocket_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
+                    {
+                       fc::scoped_lock<boost::mutex> lock( _pool_mutex );
+                       _pooled_connections[hdl] = pc;
+                    }
+                    pc->owner->async( [this,pc](){ _on_connection( pc->con ); }, "websocket open" ).wait();
+               });
+               _server.set_message_handler( [&]( connection_hdl hdl, websocket_server_type::message_ptr msg ){
+                    pooled_connection_ptr pc = find_pooled( hdl );
+                    if( !pc )
+                       return;
+                    const uint32_t pending = ++pc->pending_messages;
+                    std::string payload = std::move( msg->get_raw_payload() );
+                    auto f = pc->owner->async( [pc,payload](){
+                       --pc->pending_messages;
+                       pc->con->on_message( payload );
+                    }, "websocket message" );
+                    if( pending > max_pending_messages )
+                       f.wait();
+               });
+
+               _server.set_http_handler( [&]( connection_hdl hdl ){
+                    auto con = _server.get_con_from_hdl(hdl);
+                    con->defer_http_response();
+                    _pool->async( [this,con](){
+                       auto current_con = std::make_shared<websocket_connection_impl<websocket_server_type::connection_ptr>>( con );
+                       try
+                       {
+                          _on_connection( current_con );
+                          con->set_body( current_con->on_http( con->get_request_body() ) );
+                          con->set_status( websocketpp::http::status_code::ok );
+                       }
+                       catch( const fc::exception& e )
+                       {
+                          edump((e.to_detail_string()));
+                          con->set_status( websocketpp::http::status_code::internal_server_error );
+                       }
+                       con->send_http_response();
+                       current_con->closed();
+                    }, "websocket http" );
+               });
+
+               _server.set_close_handler( [&]( connection_hdl hdl ){
+                    remove_pooled( hdl );
+               });
+
+               _server.set_fail_handler( [&]( connection_hdl hdl ){
+                    if( _server.is_listening() )
+                       remove_pooled( hdl );
+               });
+            }
+
+            pooled_connection_ptr find_pooled( const connection_hdl& hdl )
+            {
+               fc::scoped_lock<boost::mutex> lock( _pool_mutex );
+               auto itr = _pooled_connections.find( hdl );
+               return itr != _pooled_connections.end() ? itr->second : pooled_connection_ptr();
+            }
+
+            /** signals closed() on the connection's thread, after the messages queued there */
+            void remove_pooled( const connection_hdl& hdl )
+            {
+               pooled_connection_ptr pc;
+               fc::promise<void>::ptr all_closed;
+               {
+                  fc::scoped_lock<boost::mutex> lock( _pool_mutex );
+                  auto itr = _pooled_connections.find( hdl );
+                  if( itr != _pooled_connections.end() )
+                  {
+                     pc = itr->second;
+                     _pooled_connections.erase( itr );
+                  }
+                  if( _pooled_connections.empty() )
+                     all_closed = _closed;
+               }
+               if( pc )
+                  pc->owner->async( [pc](){ pc->con->closed(); }, "websocket closed" ).wait();
+               else
+                  wlog( "unknown connection closed" );
+               if( all_closed )
+                  all_closed->set_value();
+            }
+
             ~websocket_server_impl()
             {
                if( _server.is_listening() )
                   _server.stop_listening();
 
-               if( _connections.size() )
-                  _closed = new fc::promise<void>();
+               if( !_pool )
+               {
+                  if( _connections.size() )
+                     _closed = new fc::promise<void>();
 
-               auto cpy_con = _connections;
-               for( auto item : cpy_con )
-                  _server.close( item.first, 0, "server exit" );
+                  auto cpy_con = _connections;
+                  for( auto item : cpy_con )
+                     _server.close( item.first, 0, "server exit" );
+               }
+               else
+               {
+                  con_map open;
+                  {
+                     fc::scoped_lock<boost::mutex> lock( _pool_mutex );
+                     for( const auto& item : _pooled_connections )
+                        open[item.first] = item.second->con;
+                     if( open.size() )
+                        _closed = new fc::promise<void>();
+                  }
+                  for( const auto& item : open )
+                     _server.close( item.first, 0, "server exit" );
+               }
 
                if( _closed ) _closed->wait();
+               if( _pool )
+                  _pool->quit();
             }
 
             typedef std::map<connection_hdl, websocket_connection_ptr,std::owner_less<connection_hdl> > con_map;
+            typedef std::map<connection_hdl, pooled_connection_ptr,std::owner_less<connection_hdl> > pooled_con_map;
 
             con_map                  _connections;
             fc::thread&              _server_thread;
             websocket_server_type    _server;
             on_connection_handler    _on_connection;
+            std::vector<std::string> _subprotocols;
             fc::promise<void>::ptr   _closed;
             uint32_t                 _pending_messages = 0;
+
+            std::unique_ptr<fc::thread_pool>  _pool;
+            boost::mutex                      _pool_mutex;
+            pooled_con_map                    _pooled_connections;
       };
 
       class websocket_tls_server_impl
@@ -322,6 +497,7 @@ namespace fc { namespace http {
                _server.clear_access_channels( websocketpp::log::alevel::all );
                _server.init_asio(&fc::asio::default_io_service());
                _server.set_reuse_addr(true);
+               set_subprotocol_handler( _server, _subprotocols );
                _server.set_open_handler( [&]( connection_hdl hdl ){
                     _server_thread.async( [&](){
                        auto new_con = std::make_shared<websocket_connection_impl<websocket_tls_server_type::connection_ptr>>( _server.get_con_from_hdl(hdl) );
@@ -395,6 +571,7 @@ namespace fc { namespace http {
             fc::thread&                 _server_thread;
             websocket_tls_server_type   _server;
             on_connection_handler       _on_connection;
+            std::vector<std::string>    _subprotocols;
             fc::promise<void>::ptr      _closed;
       };
 
@@ -596,6 +773,7 @@ namespace fc { namespace http {
    } // namespace detail
 
    websocket_server::websocket_server():my( new detail::websocket_server_impl() ) {}
+   websocket_server::websocket_server( uint32_t thread_count ):my( new detail::websocket_server_impl( thread_count ) ) {}
    websocket_server::~websocket_server(){}
 
    void websocket_server::on_connection( const on_connection_handler& handler )
@@ -603,6 +781,11 @@ namespace fc { namespace http {
       my->_on_connection = handler;
    }
 
+   void websocket_server::add_subprotocol( const std::string& name )
+   {
+      my->_subprotocols.push_back( name );
+   }
+
    void websocket_server::listen( uint16_t port )
    {
       my->_server.listen(port);
@@ -633,6 +816,11 @@ namespace fc { namespace http {
       my->_on_connection = handler;
    }
 
+   void websocket_tls_server::add_subprotocol( const std::string& name )
+   {
+      my->_subprotocols.push_back( name );
+   }
+
    void websocket_tls_server::listen( uint16_t port )
    {
       my->_server.listen(port);
@@ -655,10 +843,10 @@ namespace fc { namespace http {
    websocket_client::websocket_client( const std::string& ca_filename ):my( new detail::websocket_client_impl() ),smy(new detail::websocket_tls_client_impl( ca_filename )) {}
    websocket_client::~websocket_client(){ }
 
-   websocket_connection_ptr websocket_client::connect( const std::string& uri )
+   websocket_connection_ptr websocket_client::connect( const std::string& uri, const std::vector<std::string>& subprotocols )
    { try {
        if( uri.substr(0,4) == "wss:" )
-          return secure_connect(uri);
+          return secure_connect(uri, subprotocols);
        FC_ASSERT( uri.substr(0,3) == "ws:" );
 
        // wlog( "connecting to ${uri}", ("uri",uri));
@@ -677,16 +865,18 @@ namespace fc { namespace http {
        auto con = my->_client.get_connection( uri, ec );
 
        if( ec ) FC_ASSERT( !ec, "error: ${e}", ("e",ec.message()) );
+       for( const auto& p : subprotocols )
+          con->add_subprotocol( p );
 
        my->_client.connect(con);
        my->_connected->wait();
        return my->_connection;
    } FC_CAPTURE_AND_RETHROW( (uri) ) }
 
-   websocket_connection_ptr websocket_client::secure_connect( const std::string& uri )
+   websocket_connection_ptr websocket_client::secure_connect( const std::string& uri, const std::vector<std::string>& subprotocols )
    { try {
        if( uri.substr(0,3) == "ws:" )
-          return connect(uri);
+          return connect(uri, subprotocols);
        FC_ASSERT( uri.substr(0,4) == "wss:" );
        // wlog( "connecting to ${uri}", ("uri",uri));
        websocketpp::lib::error_code ec;
@@ -704,12 +894,14 @@ namespace fc { namespace http {
        auto con = smy->_client.get_connection( uri, ec );
        if( ec )
           FC_ASSERT( !ec, "error: ${e}", ("e",ec.message()) );
+       for( const auto& p : subprotocols )
+          con->add_subprotocol( p );
        smy->_client.connect(con);
        smy->_connected->wait();
        return smy->_connection;
    } FC_CAPTURE_AND_RETHROW( (uri) ) }
 
-   websocket_connection_ptr websocket_tls_client::connect( const std::string& uri )
+   websocket_connection_ptr websocket_tls_client::connect( const std::string& uri, const std::vector<std::string>& subprotocols )
    { try {
        // wlog( "connecting to ${uri}", ("uri",uri));
        websocketpp::lib::error_code ec;
@@ -728,6 +920,8 @@ namespace fc { namespace http {
        {
           FC_ASSERT( !ec, "error: ${e}", ("e",ec.message()) );
        }
+       for( const auto& p : subprotocols )
+          con->add_subprotocol( p );
        my->_client.connect(con);
        my->_connected->wait();
        return my->_connection;
@@ -43,6 +43,7 @@ namespace fc
       boost::asio::ip::tcp::socket& socket;
       const char*                   raw_buffer;
       std::shared_ptr<const char>   shared_buffer;
+      const const_buffer_chain*     chain;
 
       rate_limited_tcp_write_operation(boost::asio::ip::tcp::socket& socket,
                                        const char* buffer,
@@ -51,7 +52,8 @@ namespace fc
                                        promise<size_t>::ptr completion_promise) :
         rate_limited_operation(length, offset, std::move(completion_promise)),
         socket(socket),
-        raw_buffer(buffer)
+        raw_buffer(buffer),
+        chain(nullptr)
       {
         assert(false);
       }
@@ -63,7 +65,18 @@ namespace fc
         rate_limited_operation(length, offset, std::move(completion_promise)),
         socket(socket),
         raw_buffer(nullptr),
-        shared_buffer(buffer)
+        shared_buffer(buffer),
+        chain(nullptr)
+      {}
+      rate_limited_tcp_write_operation(boost::asio::ip::tcp::socket& socket,
+                                       const const_buffer_chain& chain,
+                                       size_t length,
+                                       size_t offset,
+                                       promise<size_t>::ptr completion_promise) :
+        rate_limited_operation(length, offset, std::move(completion_promise)),
+        socket(socket),
+        raw_buffer(nullptr),
+        chain(&chain)
       {}
       virtual void perform_operation() override
       {
@@ -71,6 +84,10 @@ namespace fc
           asio::async_write_some(socket,
                                  raw_buffer, permitted_length,
                                  completion_promise);
+        else if (chain)
+          asio::async_write_some(socket,
+                                 *chain, permitted_length, offset,
+                                 completion_promise);
         else
           asio::async_write_some(socket,
                                  shared_buffer, permitted_length, offset, 
@@ -224,6 +241,7 @@ namespace fc
       size_t readsome_impl(boost::asio::ip::tcp::socket& socket, const BufferType& buffer, size_t length, size_t offset);
       virtual size_t writesome(boost::asio::ip::tcp::socket& socket, const char* buffer, size_t length) override;
       virtual size_t writesome(boost::asio::ip::tcp::socket& socket, const std::shared_ptr<const char>& buffer, size_t length, size_t offset) override;
+      virtual size_t writesome(boost::asio::ip::tcp::socket& socket, const const_buffer_chain& chain, size_t offset) override;
       template <typename BufferType>
       size_t writesome_impl(boost::asio::ip::tcp::socket& socket, const BufferType& buffer, size_t length, size_t offset);
 
@@ -324,6 +342,12 @@ namespace fc
       return writesome_impl(socket, buffer, length, offset);
     }
 
+    size_t rate_limiting_group_impl::writesome(boost::asio::ip::tcp::socket& socket, const const_buffer_chain& chain, size_t offset)
+    {
+      // the slices are limited together, as one write of their total size
+      return writesome_impl(socket, chain, total_size(chain) - offset, offset);
+    }
+
     template <typename BufferType>
     size_t rate_limiting_group_impl::writesome_impl(boost::asio::ip::tcp::socket& socket, const BufferType& buffer, size_t length, size_t offset)
     {
@@ -54,29 +54,84 @@ namespace fc {
       virtual size_t readsome(boost::asio::ip::tcp::socket& socket, const std::shared_ptr<char>& buffer, size_t length, size_t offset) override;
       virtual size_t writesome(boost::asio::ip::tcp::socket& socket, const char* buffer, size_t length) override;
       virtual size_t writesome(boost::asio::ip::tcp::socket& socket, const std::shared_ptr<const char>& buffer, size_t length, size_t offset) override;
+      virtual size_t writesome(boost::asio::ip::tcp::socket& socket, const const_buffer_chain& chain, size_t offset) override;
+
+      bool speculate( boost::asio::ip::tcp::socket& socket )
+      {
+        if( !_speculative )
+          return false;
+        if( socket.non_blocking() )
+          return true;
+        // a socket which cannot be made non-blocking reports its error through the async path
+        boost::system::error_code ec;
+        socket.non_blocking( true, ec );
+        return !ec;
+      }
+
+      /** @return true if the read was done without waiting */
+      bool try_read( boost::asio::ip::tcp::socket& socket, char* buffer, size_t length, size_t& bytes_read )
+      {
+        ++_stats.reads;
+        if( !speculate( socket ) || !fc::asio::try_read_some( socket, boost::asio::buffer( buffer, length ), bytes_read ) )
+          return false;
+        ++_stats.immediate_reads;
+        return true;
+      }
+
+      template<typename ConstBufferSequence>
+      bool try_write( boost::asio::ip::tcp::socket& socket, const ConstBufferSequence& buffers, size_t& bytes_written )
+      {
+        ++_stats.writes;
+        if( !speculate( socket ) || !fc::asio::try_write_some( socket, buffers, bytes_written ) )
+          return false;
+        ++_stats.immediate_writes;
+        return true;
+      }
 
       fc::future<size_t> _write_in_progress;
       fc::future<size_t> _read_in_progress;
       boost::asio::ip::tcp::socket _sock;
       tcp_socket_io_hooks* _io_hooks;
+      bool _speculative = false;
+      tcp_socket::io_stats _stats;
   };
 
   size_t tcp_socket::impl::readsome(boost::asio::ip::tcp::socket& socket, char* buffer, size_t length)
   {
+    size_t bytes_read;
+    if( try_read( socket, buffer, length, bytes_read ) )
+      return bytes_read;
     return (_read_in_progress = fc::asio::read_some(socket, buffer, length)).wait();
   }
   size_t tcp_socket::impl::readsome(boost::asio::ip::tcp::socket& socket, const std::shared_ptr<char>& buffer, size_t length, size_t offset)
   {
+    size_t bytes_read;
+    if( try_read( socket, buffer.get() + offset, length, bytes_read ) )
+      return bytes_read;
     return (_read_in_progress = fc::asio::read_some(socket, buffer, length, offset)).wait();
   }
   size_t tcp_socket::impl::writesome(boost::asio::ip::tcp::socket& socket, const char* buffer, size_t length)
   {
+    size_t bytes_written;
+    if( try_write( socket, boost::asio::buffer( buffer, length ), bytes_written ) )
+      return bytes_written;
     return (_write_in_progress = fc::asio::write_some(socket, buffer, length)).wait();
   }
   size_t tcp_socket::impl::writesome(boost::asio::ip::tcp::socket& socket, const std::shared_ptr<const char>& buffer, size_t length, size_t offset)
   {
+    size_t bytes_written;
+    if( try_write( socket, boost::asio::buffer( buffer.get() + offset, length ), bytes_written ) )
+      return bytes_written;
     return (_write_in_progress = fc::asio::write_some(socket, buffer, length, offset)).wait();
   }
+  size_t tcp_socket::impl::writesome(boost::asio::ip::tcp::socket& socket, const const_buffer_chain& chain, size_t offset)
+  {
+    const size_t length = total_size( chain ) - offset;
+    size_t bytes_written;
+    if( try_write( socket, fc::asio::chain_buffers( chain, length, offset ), bytes_written ) )
+      return bytes_written;
+    return (_write_in_progress = fc::asio::write_some(socket, chain, length, offset)).wait();
+  }
 
 
   void tcp_socket::open()
@@ -116,6 +171,21 @@ namespace fc {
     return my->_io_hooks->writesome(my->_sock, buf, len, offset);
   }
 
+  void tcp_socket::set_speculative_io( bool enable )
+  {
+    my->_speculative = enable;
+  }
+
+  tcp_socket::io_stats tcp_socket::get_io_stats()const
+  {
+    return my->_stats;
+  }
+
+  size_t tcp_socket::writesome(const const_buffer_chain& chain, size_t offset)
+  {
+    return my->_io_hooks->writesome(my->_sock, chain, offset);
+  }
+
   fc::ip::endpoint tcp_socket::remote_endpoint()const
   {
     try
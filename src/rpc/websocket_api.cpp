@@ -1,8 +1,19 @@
 
 #include <fc/rpc/websocket_api.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/io/raw_variant.hpp>
+#include <fc/thread/scoped_lock.hpp>
 
 namespace fc { namespace rpc {
 
+namespace {
+   // fc::raw spends three levels on each level of a variant, and some on the frame around them
+   uint32_t binary_depth( uint32_t max_conversion_depth )
+   {
+      return 3 * max_conversion_depth + 4;
+   }
+}
+
 websocket_api_connection::~websocket_api_connection()
 {
 }
@@ -11,6 +22,7 @@ websocket_api_connection::websocket_api_connection( const std::shared_ptr<fc::ht
    : api_connection(max_depth),_connection(c)
 {
    FC_ASSERT( c );
+   _binary = c->get_subprotocol() == websocket_binary_subprotocol;
    _rpc_state.add_method( "call", [this]( const variants& args ) -> variant
    {
       FC_ASSERT( args.size() == 3 && args[2].is_array() );
@@ -60,6 +72,7 @@ variant websocket_api_connection::send_call(
 {
    if( _connection )
    {
+      FC_ASSERT( !_binary, "the binary protocol calls methods by index" );
       auto request = _rpc_state.start_remote_call(  "call", {api_id, std::move(method_name), std::move(args) } );
       _connection->send_message( fc::json::to_string(fc::variant(request, _max_conversion_depth),
                                                  fc::json::stringify_large_ints_and_doubles, _max_conversion_depth ) );
@@ -72,6 +85,8 @@ variant websocket_api_connection::send_callback(
    uint64_t callback_id,
    variants args /* = variants() */ )
 {
+   if( _connection && _binary )
+      return send_binary_request( binary_request{ optional<uint64_t>(), binary_request::callback, callback_id, 0, std::move(args) } );
    if( _connection )
    {
       auto request = _rpc_state.start_remote_call( "callback", {callback_id, std::move(args) } );
@@ -86,7 +101,9 @@ void websocket_api_connection::send_notice(
    uint64_t callback_id,
    variants args /* = variants() */ )
 {
-   if( _connection )
+   if( _connection && _binary )
+      send_binary_request( binary_request{ optional<uint64_t>(), binary_request::notice, callback_id, 0, std::move(args) } );
+   else if( _connection )
    {
       fc::rpc::request req{ optional<uint64_t>(), "notice", {callback_id, std::move(args)}};
       _connection->send_message( fc::json::to_string(fc::variant(req, _max_conversion_depth),
@@ -94,77 +111,234 @@ void websocket_api_connection::send_notice(
    }
 }
 
+variant websocket_api_connection::send_method_call(
+   api_id_type api_id,
+   uint32_t method_id,
+   string method_name,
+   variants args )
+{
+   if( _connection && _binary )
+      return send_binary_request( binary_request{ optional<uint64_t>(), binary_request::call, api_id, method_id, std::move(args) } );
+   return send_call( api_id, std::move(method_name), std::move(args) );
+}
+
+variant websocket_api_connection::send_binary_request( binary_request request )
+{
+   if( request.kind != binary_request::notice )
+      request.id = _rpc_state.start_remote_call( string(), variants() ).id;
+
+   const binary_message message( std::move(request) );
+   std::string frame( fc::raw::pack_size( message ), '\0' );
+   fc::datastream<char*> ds( &frame[0], frame.size() );
+   fc::raw::pack( ds, message, binary_depth( _max_conversion_depth ) );
+   _connection->send_binary_message( frame );
+
+   const auto& id = message.get<binary_request>().id;
+   if( !id )
+      return variant();
+   return _rpc_state.wait_for_response( *id );
+}
+
+std::string websocket_api_connection::on_binary_message(
+   const std::string& message,
+   bool send_message )
+{
+   binary_message received;
+   fc::datastream<const char*> in( message.data(), message.size() );
+   fc::raw::unpack( in, received, binary_depth( _max_conversion_depth ) );
+
+   if( received.which() == binary_message::tag<binary_response>::value )
+   {
+      const auto& reply = received.get<binary_response>();
+      response converted;
+      converted.id = reply.id;
+      converted.result = reply.result;
+      converted.error = reply.error;
+      _rpc_state.handle_reply( converted );
+      return string();
+   }
+
+   const auto& call = received.get<binary_request>();
+   binary_response reply;
+   try
+   {
+      try
+      {
+         switch( call.kind )
+         {
+            case binary_request::call:
+               reply.result = receive_method_call( call.target.value, call.method.value, call.params );
+               break;
+            case binary_request::callback:
+               reply.result = receive_callback( call.target.value, call.params );
+               break;
+            case binary_request::notice:
+               receive_notice( call.target.value, call.params );
+               break;
+            default:
+               FC_THROW( "Unknown request kind ${k}", ("k",call.kind) );
+         }
+      }
+      FC_CAPTURE_AND_RETHROW( (call.target)(call.method) )
+   }
+   catch ( const fc::exception& e )
+   {
+      reply.result.reset();
+      reply.error = error_object{ 1, e.to_string(), fc::variant( e, _max_conversion_depth ) };
+   }
+   if( !call.id )
+      return string();
+
+   reply.id = *call.id;
+   const binary_message answer( std::move(reply) );
+   std::string frame( fc::raw::pack_size( answer ), '\0' );
+   fc::datastream<char*> out( &frame[0], frame.size() );
+   fc::raw::pack( out, answer, binary_depth( _max_conversion_depth ) );
+   if( send_message && _connection )
+      _connection->send_binary_message( frame );
+   return frame;
+}
+
+void websocket_api_connection::set_max_batch_in_flight( uint32_t count )
+{
+   FC_ASSERT( count > 0 );
+   _max_batch_in_flight = count;
+}
+
 std::string websocket_api_connection::on_message(
    const std::string& message,
    bool send_message /* = true */ )
 {
    try
    {
-      auto var = fc::json::from_string(message, fc::json::legacy_parser, _max_conversion_depth);
-      const auto& var_obj = var.get_object();
+      if( _binary )
+         return on_binary_message( message, send_message );
+
+      // the batch array adds one level of nesting around the requests
+      const auto first = message.find_first_not_of( " \t\r\n" );
+      const uint32_t depth = _max_conversion_depth + ( first != std::string::npos && message[first] == '[' ? 1 : 0 );
+      auto var = fc::json::from_string(message, fc::json::legacy_parser, depth);
+
+      variant reply;
+      if( var.is_array() )
+      {
+         variants replies = handle_batch( var.get_array() );
+         if( !replies.empty() )
+            reply = variant( std::move( replies ) );
+      }
+      else
+         reply = handle_message( var );
+
+      if( !reply.is_null() )
+      {
+         auto str = fc::json::to_string( reply, fc::json::stringify_large_ints_and_doubles, depth );
+         if( send_message && _connection )
+            _connection->send_message( str );
+         return str;
+      }
+   }
+   catch ( const fc::exception& e )
+   {
+      wdump((e.to_detail_string()));
+      return e.to_detail_string();
+   }
+   return string();
+}
+
+variant websocket_api_connection::handle_message( const variant& var )
+{
+   const auto& var_obj = var.get_object();
 
-      if( var_obj.contains( "method" ) )
+   if( var_obj.contains( "method" ) )
+   {
+      auto call = var.as<fc::rpc::request>(_max_conversion_depth);
+      exception_ptr optexcept;
+      try
       {
-         auto call = var.as<fc::rpc::request>(_max_conversion_depth);
-         exception_ptr optexcept;
          try
          {
-            try
-            {
 #ifdef LOG_LONG_API
-               auto start = time_point::now();
+            auto start = time_point::now();
 #endif
 
-               auto result = _rpc_state.local_call( call.method, call.params );
+            auto result = _rpc_state.local_call( call.method, call.params );
 
 #ifdef LOG_LONG_API
-               auto end = time_point::now();
+            auto end = time_point::now();
 
-               if( end - start > fc::milliseconds( LOG_LONG_API_MAX_MS ) )
-                  elog( "API call execution time limit exceeded. method: ${m} params: ${p} time: ${t}", ("m",call.method)("p",call.params)("t", end - start) );
-               else if( end - start > fc::milliseconds( LOG_LONG_API_WARN_MS ) )
-                  wlog( "API call execution time nearing limit. method: ${m} params: ${p} time: ${t}", ("m",call.method)("p",call.params)("t", end - start) );
+            if( end - start > fc::milliseconds( LOG_LONG_API_MAX_MS ) )
+               elog( "API call execution time limit exceeded. method: ${m} params: ${p} time: ${t}", ("m",call.method)("p",call.params)("t", end - start) );
+            else if( end - start > fc::milliseconds( LOG_LONG_API_WARN_MS ) )
+               wlog( "API call execution time nearing limit. method: ${m} params: ${p} time: ${t}", ("m",call.method)("p",call.params)("t", end - start) );
 #endif
 
-               if( call.id )
-               {
-                  auto reply = fc::json::to_string( response( *call.id, result, "2.0" ), fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
-                  if( send_message && _connection )
-                     _connection->send_message( reply );
-                  return reply;
-               }
-            }
-            FC_CAPTURE_AND_RETHROW( (call.method)(call.params) )
+            if( call.id )
+               return variant( response( *call.id, result, "2.0" ), _max_conversion_depth );
          }
-         catch ( const fc::exception& e )
+         FC_CAPTURE_AND_RETHROW( (call.method)(call.params) )
+      }
+      catch ( const fc::exception& e )
+      {
+         if( call.id )
          {
-            if( call.id )
-            {
-               optexcept = e.dynamic_copy_exception();
-            }
+            optexcept = e.dynamic_copy_exception();
          }
-         if( optexcept ) {
+      }
+      if( optexcept )
+         return variant( response( *call.id, error_object{ 1, optexcept->to_string(), fc::variant(*optexcept, _max_conversion_depth)}, "2.0" ), _max_conversion_depth );
+   }
+   else
+   {
+      auto reply = var.as<fc::rpc::response>(_max_conversion_depth);
+      _rpc_state.handle_reply( reply );
+   }
+   return variant();
+}
 
-               auto reply = fc::json::to_string( variant(response( *call.id, error_object{ 1, optexcept->to_string(), fc::variant(*optexcept, _max_conversion_depth)}, "2.0" ), _max_conversion_depth ),
-                                                 fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
-               if( send_message && _connection )
-                  _connection->send_message( reply );
+variants websocket_api_connection::handle_batch( const variants& messages )
+{
+   // batch entries which are not requests are answered without an id, as JSON-RPC 2.0 requires
+   auto invalid_request = [this]( const fc::exception& e ) -> variant {
+      return mutable_variant_object( "id", variant() )( "jsonrpc", "2.0" )
+                ( "error", variant( error_object{ -32600, e.to_string(), fc::variant( e, _max_conversion_depth ) },
+                                    _max_conversion_depth ) );
+   };
 
-               return reply;
-         }
+   if( messages.empty() )
+      return { invalid_request( FC_EXCEPTION( invalid_arg_exception, "Empty batch" ) ) };
+
+   // one batch at a time, so that at most _max_batch_in_flight calls of this connection run at once
+   fc::scoped_lock<fc::mutex> lock( _batch_mutex );
+   const size_t window = _max_batch_in_flight;
+
+   std::vector<fc::future<variant>> calls;
+   calls.reserve( messages.size() );
+   variants replies;
+   replies.reserve( messages.size() );
+   auto collect = [&]( fc::future<variant>& call ) {
+      try
+      {
+         variant reply = call.wait();
+         if( !reply.is_null() )
+            replies.push_back( std::move( reply ) );
       }
-      else
+      catch ( const fc::exception& e )
       {
-         auto reply = var.as<fc::rpc::response>(_max_conversion_depth);
-         _rpc_state.handle_reply( reply );
+         replies.push_back( invalid_request( e ) );
       }
-   }
-   catch ( const fc::exception& e )
+   };
+
+   for( size_t i = 0; i < messages.size(); ++i )
    {
-      wdump((e.to_detail_string()));
-      return e.to_detail_string();
+      if( i >= window )
+         collect( calls[i - window] );
+      const variant& message = messages[i];
+      calls.push_back( fc::async( [this,&message]() { return handle_message( message ); }, "websocket_api batch call" ) );
    }
-   return string();
+   for( size_t i = calls.size() > window ? calls.size() - window : 0; i < calls.size(); ++i )
+      collect( calls[i] );
+
+   return replies;
 }
 
 } } // namespace fc::rpc
@@ -2,6 +2,7 @@
 #include <fc/thread/thread.hpp>
 #include <boost/context/all.hpp>
 #include <fc/exception/exception.hpp>
+#include "stack_pool_impl.hpp"
 #include <vector>
 
 #include <boost/version.hpp>
@@ -10,32 +11,11 @@
 #define BOOST_COROUTINE_NO_DEPRECATION_WARNING // Boost 1.62
 
 #if BOOST_VERSION >= 106100
-  #include <boost/coroutine/stack_allocator.hpp>
   namespace bc  = boost::context::detail;
-  namespace bco = boost::coroutines;
-  typedef bco::stack_allocator stack_allocator;
-#elif BOOST_VERSION >= 105400
-# include <boost/coroutine/stack_context.hpp>
-  namespace bc  = boost::context;
-  namespace bco = boost::coroutines;
-# if BOOST_VERSION >= 105600 && !defined(NDEBUG)
-#  include <boost/assert.hpp>
-#  include <boost/coroutine/protected_stack_allocator.hpp>
-  typedef bco::protected_stack_allocator stack_allocator;
-# else
-#  include <boost/coroutine/stack_allocator.hpp>
-  typedef bco::stack_allocator stack_allocator;
-# endif
-
-#elif BOOST_VERSION >= 105300
-  #include <boost/coroutine/stack_allocator.hpp>
-  namespace bc  = boost::context;
-  namespace bco = boost::coroutines;
 #elif BOOST_VERSION >= 105200
-  namespace bc = boost::context;
+  namespace bc  = boost::context;
 #else
   namespace bc  = boost::ctx;
-  namespace bco = boost::coroutine;
 #endif
 
 namespace fc {
@@ -51,19 +31,15 @@ namespace fc {
   struct context  {
     typedef fc::context* ptr;
 
-#if BOOST_VERSION >= 105400
-    bco::stack_context stack_ctx;
-#endif
-
 #if BOOST_VERSION >= 106100
     using context_fn = void (*)(bc::transfer_t);
 #else
     using context_fn = void(*)(intptr_t);
 #endif
 
-    context( context_fn sf, stack_allocator& alloc, fc::thread* t )
+    context( context_fn sf, stack_class cls, fc::thread* t )
     : caller_context(0),
-      stack_alloc(&alloc),
+      stack( stack_pool::instance().my->allocate( cls ) ),
       next_blocked(0), 
       next_blocked_mutex(0), 
       next(0), 
@@ -76,22 +52,11 @@ namespace fc {
       cur_task(0),
       context_posted_num(0)
     {
-#if BOOST_VERSION >= 105600
-     size_t stack_size = FC_CONTEXT_STACK_SIZE;
-     alloc.allocate(stack_ctx, stack_size);
-     my_context = bc::make_fcontext( stack_ctx.sp, stack_ctx.size, sf); 
-#elif BOOST_VERSION >= 105400
-     size_t stack_size = FC_CONTEXT_STACK_SIZE;
-     alloc.allocate(stack_ctx, stack_size);
-     my_context = bc::make_fcontext( stack_ctx.sp, stack_ctx.size, sf);
-#elif BOOST_VERSION >= 105300
-     size_t stack_size = FC_CONTEXT_STACK_SIZE;
-     void*  stackptr = alloc.allocate(stack_size);
-     my_context = bc::make_fcontext( stackptr, stack_size, sf);
+#if BOOST_VERSION >= 105300
+     my_context = bc::make_fcontext( stack.top(), stack.size, sf);
 #else
-     size_t stack_size = FC_CONTEXT_STACK_SIZE;
-     my_context.fc_stack.base = alloc.allocate( stack_size );
-     my_context.fc_stack.limit = static_cast<char*>( my_context.fc_stack.base) - stack_size;
+     my_context.fc_stack.base = stack.top();
+     my_context.fc_stack.limit = stack.base;
      make_fcontext( &my_context, sf );
 #endif
     }
@@ -103,7 +68,6 @@ namespace fc {
      my_context(new bc::fcontext_t),
 #endif
      caller_context(0),
-     stack_alloc(0),
      next_blocked(0), 
      next_blocked_mutex(0), 
      next(0), 
@@ -118,25 +82,16 @@ namespace fc {
     {}
 
     ~context() {
-#if BOOST_VERSION >= 105600
-      if(stack_alloc)
-        stack_alloc->deallocate( stack_ctx );
-#elif BOOST_VERSION >= 105400
-      if(stack_alloc)
-        stack_alloc->deallocate( stack_ctx );
-      else
-        delete my_context;
-#elif BOOST_VERSION >= 105300
-      if(stack_alloc)
-        stack_alloc->deallocate( my_context->fc_stack.sp, FC_CONTEXT_STACK_SIZE);
-      else
+#if BOOST_VERSION >= 105300 && BOOST_VERSION < 105600
+      if( !stack.base )
         delete my_context;
-#else
-      if(stack_alloc)
-        stack_alloc->deallocate( my_context.fc_stack.base, FC_CONTEXT_STACK_SIZE );
 #endif
+      stack_pool::instance().my->release( stack );
     }
 
+    /** @return the class of stack this context runs on, the thread's own stack counts as normal */
+    stack_class stack_cls()const { return stack.base ? stack.cls : stack_class::normal; }
+
     void reinitialize()
     {
       canceled = false;
@@ -228,11 +183,12 @@ namespace fc {
     bc::fcontext_t               my_context;
 #endif
     fc::context*                caller_context;
-    stack_allocator*            stack_alloc;
+    detail::pooled_stack         stack;       // empty for the context of the thread's own stack
     priority                     prio;
     //promise_base*              prom; 
     std::vector<blocked_promise> blocking_prom;
     time_point                   resume_time;
+    detail::timer_hook           sleep_timer; // links this context into thread_d::sleep_timers until resume_time
    // time_point                   ready_time; // time that this context was put on ready queue
     fc::context*                next_blocked;
     fc::context*                next_blocked_mutex;
@@ -19,6 +19,7 @@ namespace fc {
    _cancellation_reason(nullptr),
 #endif
    _desc(desc),
+   _value(nullptr),
    _compl(nullptr)
   { }
 
@@ -125,7 +126,14 @@ namespace fc {
     if( blocked_thread ) 
       blocked_thread->notify(ptr(this,true));
   }
-  promise_base::~promise_base() { }
+  promise_base::~promise_base() {
+    while( _compl )
+    {
+      detail::completion_handler* next = _compl->next;
+      delete _compl;
+      _compl = next;
+    }
+  }
   void promise_base::_set_timeout(){
     if( _ready ) 
       return;
@@ -134,21 +142,39 @@ namespace fc {
   void promise_base::_set_value(const void* s){
  //   slog( "%p == %d", &_ready, int(_ready));
 //    BOOST_ASSERT( !_ready );
+    detail::completion_handler* handlers;
     { synchronized(_spin_yield) 
       if (_ready) //don't allow promise to be set more than once
         return;
       _ready = true;
+      _value = s;
+      handlers = _compl;
+      _compl = nullptr;
     }
     _notify();
-    if( nullptr != _compl ) {
-      _compl->on_complete(s,_exceptp);
+    if( handlers ) {
+      ptr keep_alive( this, true ); // a handler may drop the last other reference to us
+      while( handlers ) {
+        detail::completion_handler* next = handlers->next;
+        handlers->on_complete(s,_exceptp);
+        delete handlers;
+        handlers = next;
+      }
     }
   }
   void promise_base::_on_complete( detail::completion_handler* c ) {
     { synchronized(_spin_yield) 
-        delete _compl; 
-        _compl = c;
+      if( !_ready ) {
+        detail::completion_handler** tail = &_compl;
+        while( *tail )
+          tail = &(*tail)->next;
+        *tail = c;
+        return;
+      }
     }
+    // already set, nobody will call it later
+    c->on_complete(_value,_exceptp);
+    delete c;
   }
 }
 
@@ -0,0 +1,266 @@
+#include <fc/thread/stack_pool.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/thread/unique_lock.hpp>
+#include "stack_pool_impl.hpp"
+
+#include <algorithm>
+#include <new>
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+namespace fc {
+  namespace detail {
+
+#if defined(__APPLE__) || defined(__FreeBSD__)
+    typedef char mincore_vec_t;
+#else
+    typedef unsigned char mincore_vec_t;
+#endif
+
+    stack_pool_impl::stack_pool_impl()
+    :max_cached(256), tracking(false)
+    {
+    }
+
+    stack_pool_impl::~stack_pool_impl()
+    {
+      for( size_class& c : classes )
+        for( pooled_stack& s : c.cached )
+          unmap( s );
+    }
+
+    size_t stack_pool_impl::page_size()
+    {
+#ifdef _WIN32
+      static const size_t size = []{ SYSTEM_INFO info; GetSystemInfo( &info ); return size_t(info.dwPageSize); }();
+#else
+      static const size_t size = sysconf( _SC_PAGESIZE );
+#endif
+      return size;
+    }
+
+    pooled_stack stack_pool_impl::allocate( stack_class c )
+    {
+      size_class& sc = classes[unsigned(c)];
+      ++sc.in_use;
+      { synchronized( sc.lock )
+        if( !sc.cached.empty() )
+        {
+          pooled_stack s = sc.cached.back();
+          sc.cached.pop_back();
+          return s;
+        }
+      }
+
+      pooled_stack s;
+      s.size = stack_pool::stack_size( c );
+      s.cls  = c;
+      const size_t guard = page_size();
+#ifdef _WIN32
+      char* mapping = static_cast<char*>( VirtualAlloc( nullptr, s.size + guard, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE ) );
+      if( !mapping )
+      {
+        --sc.in_use;
+        throw std::bad_alloc();
+      }
+      DWORD old_protection;
+      VirtualProtect( mapping, guard, PAGE_NOACCESS, &old_protection );
+#else
+      int flags = MAP_PRIVATE | MAP_ANON;
+# ifdef MAP_NORESERVE
+      flags |= MAP_NORESERVE;
+# endif
+      void* mapped = mmap( nullptr, s.size + guard, PROT_READ | PROT_WRITE, flags, -1, 0 );
+      if( mapped == MAP_FAILED )
+      {
+        --sc.in_use;
+        throw std::bad_alloc();
+      }
+      char* mapping = static_cast<char*>( mapped );
+      mprotect( mapping, guard, PROT_NONE );
+#endif
+      s.base = mapping + guard;
+      return s;
+    }
+
+    void stack_pool_impl::release( pooled_stack& s )
+    {
+      if( !s.base )
+        return;
+      size_class& sc = classes[unsigned(s.cls)];
+      --sc.in_use;
+
+      bool keep = false;
+      { synchronized( sc.lock )
+        keep = sc.cached.size() < max_cached.load( boost::memory_order_relaxed );
+      }
+      if( keep )
+      {
+        // nobody runs on this stack anymore, so all of it can go back to the OS
+        discard( s, s.top() );
+        synchronized( sc.lock )
+        sc.cached.push_back( s );
+      }
+      else
+        unmap( s );
+      s = pooled_stack();
+    }
+
+    void stack_pool_impl::unmap( pooled_stack& s )
+    {
+      const size_t guard = page_size();
+#ifdef _WIN32
+      VirtualFree( s.base - guard, 0, MEM_RELEASE );
+#else
+      munmap( s.base - guard, s.size + guard );
+#endif
+    }
+
+    void stack_pool_impl::discard( const pooled_stack& s, const char* end )
+    {
+      if( end <= s.base )
+        return;
+#ifdef _WIN32
+      VirtualFree( s.base, end - s.base, MEM_DECOMMIT );
+      VirtualAlloc( s.base, end - s.base, MEM_COMMIT, PAGE_READWRITE );
+#else
+      madvise( s.base, end - s.base, MADV_DONTNEED );
+#endif
+    }
+
+    const char* stack_pool_impl::lowest_dirty( const pooled_stack& s, const char* limit )
+    {
+      const char* start = s.base;
+#ifndef _WIN32
+      // pages that were never touched are not resident, skip straight to the first one that is
+      const size_t page = page_size();
+      std::vector<mincore_vec_t> resident( (limit - s.base) / page );
+      if( !resident.empty() && mincore( s.base, limit - s.base, resident.data() ) == 0 )
+      {
+        size_t first = 0;
+        while( first < resident.size() && !(resident[first] & 1) )
+          ++first;
+        start = s.base + first * page;
+      }
+#endif
+      for( const uint64_t* word = reinterpret_cast<const uint64_t*>( start );
+           word < reinterpret_cast<const uint64_t*>( limit ); ++word )
+        if( *word )
+          return reinterpret_cast<const char*>( word );
+      return limit;
+    }
+
+    void stack_pool_impl::record_usage( const pooled_stack& s, const char* desc, const void* frame )
+    {
+      // leave a couple of pages between what we look at and the caller's frame, so that
+      // neither this function nor the system calls it makes have their stack discarded
+      const size_t page = page_size();
+      const char* limit = reinterpret_cast<const char*>( (reinterpret_cast<uintptr_t>(frame) & ~(page - 1)) - 2 * page );
+      if( limit <= s.base || limit > s.top() )
+        return;
+
+      const char* lowest = lowest_dirty( s, limit );
+      if( lowest < limit )
+        discard( s, limit );
+      else
+        lowest = static_cast<const char*>( frame );
+
+      boost::unique_lock<boost::mutex> lock( usage_mutex );
+      const std::string name = desc ? desc : "";
+      stack_pool::task_usage& u = usage[std::make_pair( name, s.cls )];
+      u.desc = name;
+      u.cls  = s.cls;
+      u.high_water = std::max<size_t>( u.high_water, s.top() - lowest );
+      ++u.runs;
+    }
+
+  } // namespace detail
+
+  stack_pool::stack_pool()
+  :my( new detail::stack_pool_impl() )
+  {
+  }
+
+  stack_pool::~stack_pool()
+  {
+  }
+
+  stack_pool& stack_pool::instance()
+  {
+    // never destroyed: contexts owned by static objects may return their stacks at exit
+    static stack_pool* pool = new stack_pool();
+    return *pool;
+  }
+
+  size_t stack_pool::stack_size( stack_class c )
+  {
+    switch( c )
+    {
+      case stack_class::compact: return 64 * 1024;
+      case stack_class::large: return 8 * 1024 * 1024;
+      case stack_class::normal:
+      default:                 return FC_CONTEXT_STACK_SIZE;
+    }
+  }
+
+  stack_pool::class_stats stack_pool::get_stats( stack_class c )const
+  {
+    detail::stack_pool_impl::size_class& sc = my->classes[unsigned(c)];
+    class_stats stats;
+    stats.stack_size = stack_size( c );
+    stats.in_use = sc.in_use.load( boost::memory_order_relaxed );
+    synchronized( sc.lock )
+    stats.cached = sc.cached.size();
+    return stats;
+  }
+
+  void stack_pool::set_max_cached( uint32_t stacks_per_class )
+  {
+    my->max_cached = stacks_per_class;
+    for( detail::stack_pool_impl::size_class& sc : my->classes )
+    {
+      std::vector<detail::pooled_stack> excess;
+      { synchronized( sc.lock )
+        while( sc.cached.size() > stacks_per_class )
+        {
+          excess.push_back( sc.cached.back() );
+          sc.cached.pop_back();
+        }
+      }
+      for( detail::pooled_stack& s : excess )
+        detail::stack_pool_impl::unmap( s );
+    }
+  }
+
+  void stack_pool::set_usage_tracking( bool enabled )
+  {
+    my->tracking = enabled;
+  }
+
+  bool stack_pool::usage_tracking_enabled()const
+  {
+    return my->tracking.load( boost::memory_order_relaxed );
+  }
+
+  std::vector<stack_pool::task_usage> stack_pool::get_usage()const
+  {
+    std::vector<task_usage> result;
+    boost::unique_lock<boost::mutex> lock( my->usage_mutex );
+    result.reserve( my->usage.size() );
+    for( const auto& entry : my->usage )
+      result.push_back( entry.second );
+    return result;
+  }
+
+  void stack_pool::reset_usage()
+  {
+    boost::unique_lock<boost::mutex> lock( my->usage_mutex );
+    my->usage.clear();
+  }
+
+} // namespace fc
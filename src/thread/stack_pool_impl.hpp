@@ -0,0 +1,68 @@
+#pragma once
+#include <fc/thread/stack_pool.hpp>
+#include <fc/thread/spin_lock.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <vector>
+
+namespace fc { namespace detail {
+
+   /** a mapped stack; the guard page lies just below base, the stack grows down from top() */
+   struct pooled_stack
+   {
+      pooled_stack() : base(nullptr), size(0), cls(stack_class::normal) {}
+
+      char*       base;
+      size_t      size;
+      stack_class cls;
+
+      char* top()const { return base + size; }
+   };
+
+   class stack_pool_impl
+   {
+      public:
+         static const unsigned class_count = 3;
+
+         stack_pool_impl();
+         ~stack_pool_impl();
+
+         pooled_stack allocate( stack_class c );
+         void         release( pooled_stack& s );
+
+         /**
+          *  Records how deep @p s was used by the task that just returned on it and gives
+          *  back the pages it dirtied, so the next task is measured on its own.  Must be
+          *  called on the stack being measured; @p frame is the address of a local in the
+          *  caller, everything in use lies above it.
+          */
+         void record_usage( const pooled_stack& s, const char* desc, const void* frame );
+
+         static void unmap( pooled_stack& s );
+
+         struct size_class
+         {
+            size_class() : in_use(0) {}
+
+            fc::spin_lock              lock;
+            std::vector<pooled_stack>  cached;
+            boost::atomic<uint32_t>    in_use;
+         };
+
+         size_class              classes[class_count];
+         boost::atomic<uint32_t> max_cached;
+         boost::atomic<bool>     tracking;
+
+         mutable boost::mutex    usage_mutex;
+         std::map<std::pair<std::string,stack_class>, stack_pool::task_usage> usage;
+
+      private:
+         static size_t page_size();
+         /** @return the lowest address below @p limit that has been written to, or @p limit */
+         static const char* lowest_dirty( const pooled_stack& s, const char* limit );
+         /** returns the pages of @p s in [base, end) to the OS, they read as zero afterwards */
+         static void discard( const pooled_stack& s, const char* end );
+   };
+
+} } // namespace fc::detail
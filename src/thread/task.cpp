@@ -8,8 +8,9 @@
 #include <fc/log/logger.hpp>
 #include <boost/exception/all.hpp>
 
+#include <fc/thread/thread.hpp>
+
 #ifdef _MSC_VER
-# include <fc/thread/thread.hpp>
 # include <Windows.h>
 #endif
 
@@ -18,6 +19,8 @@ namespace fc {
   :
   promise_base("task_base"),
   _posted_num(0),
+  _stack_class(stack_class::normal),
+  _scheduled_thread(nullptr),
   _active_context(nullptr),
   _next(nullptr),
   _task_specific_data(nullptr),
@@ -76,6 +79,12 @@ namespace fc {
 #endif
       _active_context->ctx_thread->notify_task_has_been_canceled();
     }
+    else if (_scheduled_thread && !ready())
+    {
+      // not started yet and waiting for its scheduled time; have the thread resolve it now
+      // rather than when the timer fires
+      _scheduled_thread->notify_scheduled_task_canceled(this);
+    }
   }
 
   task_base::~task_base() {
@@ -0,0 +1,198 @@
+#include <fc/thread/task_allocator.hpp>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+namespace fc { namespace detail {
+
+   namespace {
+      struct thread_cache;
+
+      /** precedes every block; 16 bytes so the payload keeps the alignment of operator new */
+      struct block_header
+      {
+         thread_cache* owner;      // nullptr for blocks from the global heap
+         uint32_t      size_class;
+         uint32_t      reserved;
+      };
+      static_assert( sizeof(block_header) <= 16, "block_header must fit in 16 bytes" );
+      const size_t header_size = 16;
+
+      struct free_block
+      {
+         union
+         {
+            block_header header;
+            char         header_bytes[header_size];
+         };
+         free_block*  next;        // overlaps the payload while the block is free
+      };
+      static_assert( offsetof(free_block, next) == header_size, "the payload must start header_size bytes into a block" );
+
+      const size_t   class_granularity = 64;
+      const uint32_t class_count = (task_allocator::max_block_size + header_size + class_granularity - 1) / class_granularity;
+      const size_t   chunk_size = 16 * 1024;
+
+      struct thread_cache
+      {
+         thread_cache() : remote(nullptr), next_orphan(nullptr)
+         {
+            std::fill( local, local + class_count, nullptr );
+         }
+
+         free_block*               local[class_count];
+         boost::atomic<free_block*> remote;      // blocks of any class freed by other threads
+         task_allocator::stats     stats;
+         thread_cache*             next_orphan;
+      };
+
+#ifdef _MSC_VER
+      static __declspec(thread) thread_cache* tls_cache = nullptr;
+      static __declspec(thread) bool          tls_exited = false;
+#else
+      static __thread thread_cache* tls_cache = nullptr;
+      static __thread bool          tls_exited = false;
+#endif
+
+      // caches of threads that have exited, waiting for a new thread to adopt them
+      boost::mutex& orphans_mutex()
+      {
+         static boost::mutex* m = new boost::mutex();
+         return *m;
+      }
+      thread_cache* orphans = nullptr;
+
+      void orphan_cache( thread_cache* c )
+      {
+         tls_cache = nullptr;
+         tls_exited = true; // blocks freed by this thread from now on take the remote path
+         boost::unique_lock<boost::mutex> lock( orphans_mutex() );
+         c->next_orphan = orphans;
+         orphans = c;
+      }
+
+      boost::thread_specific_ptr<thread_cache>& exit_hook()
+      {
+         static boost::thread_specific_ptr<thread_cache>* hook =
+            new boost::thread_specific_ptr<thread_cache>( &orphan_cache );
+         return *hook;
+      }
+
+      /** @return the calling thread's cache, or nullptr once the thread is exiting */
+      thread_cache* current_cache()
+      {
+         if( tls_cache || tls_exited )
+            return tls_cache;
+
+         thread_cache* c = nullptr;
+         {
+            boost::unique_lock<boost::mutex> lock( orphans_mutex() );
+            if( orphans )
+            {
+               c = orphans;
+               orphans = c->next_orphan;
+               c->next_orphan = nullptr;
+            }
+         }
+         if( !c )
+            c = new thread_cache();
+         exit_hook().reset( c );
+         tls_cache = c;
+         return c;
+      }
+
+      void reclaim_remote( thread_cache* c )
+      {
+         free_block* b = c->remote.exchange( nullptr, boost::memory_order_acquire );
+         while( b )
+         {
+            free_block* next = b->next;
+            b->next = c->local[b->header.size_class];
+            c->local[b->header.size_class] = b;
+            b = next;
+         }
+      }
+
+      void refill( thread_cache* c, uint32_t size_class )
+      {
+         const size_t block_size = (size_class + 1) * class_granularity;
+         const size_t count = std::max<size_t>( 8, chunk_size / block_size );
+         char* chunk = static_cast<char*>( ::operator new( block_size * count ) );
+         ++c->stats.heap_allocations;
+         for( size_t i = count; i > 0; --i )
+         {
+            free_block* b = reinterpret_cast<free_block*>( chunk + (i - 1) * block_size );
+            b->header.owner = c;
+            b->header.size_class = size_class;
+            b->next = c->local[size_class];
+            c->local[size_class] = b;
+         }
+      }
+   } // anonymous namespace
+
+   void* task_allocator::allocate( size_t size )
+   {
+      thread_cache* c = current_cache();
+      if( size > max_block_size || !c )
+      {
+         free_block* b = static_cast<free_block*>( ::operator new( size + header_size ) );
+         b->header.owner = nullptr;
+         b->header.size_class = class_count;
+         if( c )
+            ++c->stats.heap_allocations;
+         return reinterpret_cast<char*>( b ) + header_size;
+      }
+
+      const uint32_t size_class = (size + header_size - 1) / class_granularity;
+      if( !c->local[size_class] )
+      {
+         reclaim_remote( c );
+         if( !c->local[size_class] )
+            refill( c, size_class );
+      }
+      free_block* b = c->local[size_class];
+      c->local[size_class] = b->next;
+      ++c->stats.slab_allocations;
+      return reinterpret_cast<char*>( b ) + header_size;
+   }
+
+   void task_allocator::deallocate( void* p )
+   {
+      if( !p )
+         return;
+      free_block* b = reinterpret_cast<free_block*>( static_cast<char*>( p ) - header_size );
+      thread_cache* owner = b->header.owner;
+      if( !owner )
+      {
+         ::operator delete( b );
+         return;
+      }
+
+      thread_cache* c = tls_cache;
+      if( owner == c )
+      {
+         b->next = c->local[b->header.size_class];
+         c->local[b->header.size_class] = b;
+         return;
+      }
+
+      free_block* head = owner->remote.load( boost::memory_order_relaxed );
+      do {
+         b->next = head;
+      } while( !owner->remote.compare_exchange_weak( head, b, boost::memory_order_release,
+                                                              boost::memory_order_relaxed ) );
+      if( c )
+         ++c->stats.remote_frees;
+   }
+
+   task_allocator::stats task_allocator::get_thread_stats()
+   {
+      return tls_cache ? tls_cache->stats : stats();
+   }
+
+} } // namespace fc::detail
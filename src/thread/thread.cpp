@@ -196,16 +196,15 @@ namespace fc {
       unstarted_task->set_exception(std::make_shared<canceled_exception>(FC_LOG_MESSAGE(error, "cancellation reason: thread quitting")));
     my->task_pqueue.clear();
 
-    for (task_base* scheduled_task : my->task_sch_queue)
-      scheduled_task->set_exception(std::make_shared<canceled_exception>(FC_LOG_MESSAGE(error, "cancellation reason: thread quitting")));
-    my->task_sch_queue.clear();
-
-
+    my->task_timers.clear( []( void* scheduled_task ) {
+      static_cast<task_base*>(scheduled_task)->set_exception(std::make_shared<canceled_exception>(FC_LOG_MESSAGE(error, "cancellation reason: thread quitting")));
+    } );
 
     // move all sleep tasks to ready
-    for( uint32_t i = 0; i < my->sleep_pqueue.size(); ++i )
-      my->add_context_to_ready_list( my->sleep_pqueue[i] );
-    my->sleep_pqueue.clear();
+    thread_d* d = my;
+    my->sleep_timers.clear( [d]( void* sleeping_context ) {
+      d->add_context_to_ready_list( static_cast<fc::context*>(sleeping_context) );
+    } );
 
     // move all idle tasks to ready
     fc::context* cur = my->pt_head;
@@ -226,7 +225,7 @@ namespace fc {
     while (!my->ready_heap.empty())
     {
       my->start_next_fiber(true);
-      my->check_for_timeouts();
+      my->check_for_timeouts( time_point::now() );
     }
     my->clear_free_list();
     my->cleanup_thread_specific_data();
@@ -300,10 +299,7 @@ namespace fc {
        if( timeout != time_point::maximum() )
        {
            my->current->resume_time = timeout;
-           my->sleep_pqueue.push_back(my->current);
-           std::push_heap( my->sleep_pqueue.begin(),
-                           my->sleep_pqueue.end(),
-                           sleep_priority_less()   );
+           my->sleep_timers.insert( &my->current->sleep_timer, my->current, timeout );
        }
 
        my->add_to_blocked( my->current );
@@ -311,6 +307,7 @@ namespace fc {
 
        for( auto i = p.begin(); i != p.end(); ++i )
          my->current->remove_blocking_promise(i->get());
+       my->remove_sleep_timer( my->current );
 
        my->check_fiber_exceptions();
 
@@ -327,26 +324,33 @@ namespace fc {
    }
 
    void thread::poke() {
-     boost::unique_lock<boost::mutex> lock(my->task_ready_mutex);
-     my->task_ready.notify_one();
+     my->wake_if_parked();
+   }
+
+   thread::wakeup_stats thread::get_wakeup_stats()const {
+     wakeup_stats stats;
+     stats.wakeups_sent = my->wakeups_sent.load( boost::memory_order_relaxed );
+     stats.wakeups_avoided = my->wakeups_avoided.load( boost::memory_order_relaxed );
+     return stats;
    }
 
    void thread::async_task( task_base* t, const priority& p, const time_point& tp ) {
       assert(my);
       t->_when = tp;
+      t->_scheduled_thread = tp != time_point::min() ? this : nullptr;
      // slog( "when %lld", t->_when.time_since_epoch().count() );
      // slog( "delay %lld", (tp - fc::time_point::now()).count() );
       task_base* stale_head = my->task_in_queue.load(boost::memory_order_relaxed);
       do { t->_next = stale_head;
-      }while( !my->task_in_queue.compare_exchange_weak( stale_head, t, boost::memory_order_release ) );
-
-      // Because only one thread can post the 'first task', only that thread will attempt
-      // to aquire the lock and therefore there should be no contention on this lock except
-      // when *this thread is about to block on a wait condition.
-      if( this != &current() &&  !stale_head ) {
-          boost::unique_lock<boost::mutex> lock(my->task_ready_mutex);
-          my->task_ready.notify_one();
-      }
+      }while( !my->task_in_queue.compare_exchange_weak( stale_head, t, boost::memory_order_seq_cst,
+                                                                        boost::memory_order_relaxed ) );
+
+      // Only the thread that posts the 'first task' needs to wake the target: anyone posting
+      // behind it will be picked up together with it.  Even that thread only touches
+      // task_ready_mutex if the target is parked, so posting to a busy thread costs a
+      // single CAS.
+      if( this != &current() &&  !stale_head )
+          my->wake_if_parked();
    }
 
    void yield() {
@@ -392,10 +396,7 @@ namespace fc {
          if( timeout != time_point::maximum() )
          {
              my->current->resume_time = timeout;
-             my->sleep_pqueue.push_back(my->current);
-             std::push_heap( my->sleep_pqueue.begin(),
-                             my->sleep_pqueue.end(),
-                             sleep_priority_less() );
+             my->sleep_timers.insert( &my->current->sleep_timer, my->current, timeout );
          }
 
        //  elog( "blocking %1%", my->current );
@@ -408,6 +409,7 @@ namespace fc {
 
          //slog( "                                 %1% unblocking blocking on %2%", my->current, p.get() );
          my->current->remove_blocking_promise(p.get());
+         my->remove_sleep_timer( my->current );
 
          my->check_fiber_exceptions();
     }
@@ -437,17 +439,8 @@ namespace fc {
           // remove it from the blocked list.
 
           // remove this context from the sleep queue...
-          for( uint32_t i = 0; i < my->sleep_pqueue.size(); ++i )
-          {
-            if( my->sleep_pqueue[i] == cur_blocked )
-            {
-              my->sleep_pqueue[i]->blocking_prom.clear();
-              my->sleep_pqueue[i] = my->sleep_pqueue.back();
-              my->sleep_pqueue.pop_back();
-              std::make_heap( my->sleep_pqueue.begin(),my->sleep_pqueue.end(), sleep_priority_less() );
-              break;
-            }
-          }
+          if( my->remove_sleep_timer( cur_blocked ) )
+            cur_blocked->blocking_prom.clear();
           auto cur = cur_blocked;
           if( prev_blocked )
           {
@@ -480,6 +473,13 @@ namespace fc {
       async( [=](){ my->notify_task_has_been_canceled(); }, "notify_task_has_been_canceled", priority::max() );
     }
 
+    void thread::notify_scheduled_task_canceled( task_base* t )
+    {
+      promise_base::ptr keep_alive( t, true );
+      async( [this,t,keep_alive](){ my->cancel_scheduled_task( t ); },
+             "notify_scheduled_task_canceled", priority::max() );
+    }
+
     void thread::unblock(fc::context* c)
     {
       my->unblock(c);
@@ -3,6 +3,8 @@
 #include <fc/time.hpp>
 #include <boost/thread.hpp>
 #include "context.hpp"
+#include "thread_pool_impl.hpp"
+#include "timer_wheel.hpp"
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread.hpp>
 #include <boost/atomic.hpp>
@@ -10,24 +12,25 @@
 //#include <fc/logger.hpp>
 
 namespace fc {
-    struct sleep_priority_less {
-        bool operator()( const context::ptr& a, const context::ptr& b ) {
-            return a->resume_time > b->resume_time;
-        }
-    };
     class thread_d {
 
         public:
           using context_pair = std::pair<thread_d*, fc::context*>;
            thread_d(fc::thread& s)
             :self(s), boost_thread(0),
+             parked(false),
+             wakeups_sent(0),
+             wakeups_avoided(0),
              task_in_queue(0),
              next_posted_num(1),
+             cached_now(time_point::now()),
              done(false),
              current(0),
              pt_head(0),
              blocked(0),
-             next_unused_task_storage_slot(0)
+             next_unused_task_storage_slot(0),
+             pool(nullptr),
+             pool_index(0)
 #ifndef NDEBUG
              ,non_preemptable_scope_count(0)
 #endif
@@ -68,15 +71,18 @@ namespace fc {
 
            fc::thread&             self;
            boost::thread* boost_thread;
-           stack_allocator                  stack_alloc;
            boost::condition_variable        task_ready;
            boost::mutex                     task_ready_mutex;
+           boost::atomic<bool>              parked;          // set before the last check for work ahead of waiting on task_ready
+           boost::atomic<uint64_t>          wakeups_sent;    // notifications sent to a parked thread
+           boost::atomic<uint64_t>          wakeups_avoided; // posts to an empty inbox that found the thread running
 
            boost::atomic<task_base*>       task_in_queue;
            std::vector<task_base*>         task_pqueue;    // heap of tasks that have never started, ordered by proirity & scheduling time
            uint64_t                        next_posted_num; // each task or context gets assigned a number in the order it is ready to execute, tracked here
-           std::vector<task_base*>         task_sch_queue; // heap of tasks that have never started but are scheduled for a time in the future, ordered by the time they should be run
-           std::vector<fc::context*>       sleep_pqueue;   // heap of running tasks that have sleeped, ordered by the time they should resume
+           detail::timer_wheel             task_timers;    // tasks that have never started but are scheduled for a time in the future
+           detail::timer_wheel             sleep_timers;   // running tasks that have sleeped or wait with a timeout, until they should resume
+           time_point                      cached_now;     // time_point::now() as of the start of the current scheduling pass
            std::vector<fc::context*>       free_list;      // list of unused contexts that are ready for deletion
 
            bool                     done;
@@ -97,6 +103,9 @@ namespace fc {
            std::vector<detail::specific_data_info> non_task_specific_data;
            unsigned next_unused_task_storage_slot;
 
+           detail::thread_pool_impl* pool;       // set if this thread is a worker of a thread_pool
+           uint16_t                  pool_index; // index of this thread in pool->workers
+
 #ifndef NDEBUG
            unsigned                 non_preemptable_scope_count;
 #endif
@@ -153,6 +162,39 @@ namespace fc {
               blocked = c;
            }
 
+           /**
+            *  Called after a task was posted to an empty task_in_queue, or work was made
+            *  available some other way.  Only takes task_ready_mutex if the thread is
+            *  parked (or about to park) waiting for work.
+            */
+           void wake_if_parked()
+           {
+              if( parked.load() )
+              {
+                 boost::unique_lock<boost::mutex> lock(task_ready_mutex);
+                 task_ready.notify_one();
+                 wakeups_sent.fetch_add( 1, boost::memory_order_relaxed );
+              }
+              else
+                 wakeups_avoided.fetch_add( 1, boost::memory_order_relaxed );
+           }
+
+           /** takes a cached context that runs on a stack of class @p cls off pt_head */
+           fc::context* pt_pop( stack_class cls )
+           {
+              for( fc::context** iter = &pt_head; *iter; iter = &(*iter)->next )
+              {
+                if( (*iter)->stack_cls() == cls )
+                {
+                  fc::context* c = *iter;
+                  *iter = c->next;
+                  c->next = 0;
+                  return c;
+                }
+              }
+              return nullptr;
+           }
+
            void pt_push_back(fc::context* c) 
            {
               c->next = pt_head;
@@ -212,17 +254,9 @@ namespace fc {
             }
           };
 
-          struct task_when_less 
-          {
-            bool operator()( task_base* a, task_base* b ) 
-            {
-              return a->_when > b->_when;
-            }
-          };
-
            void enqueue( task_base* t ) 
            {
-              time_point now = time_point::now();
+              const time_point& now = cached_now;
               task_base* cur = t;
 
               // the linked list of tasks passed to enqueue is in the reverse order of
@@ -243,11 +277,7 @@ namespace fc {
               while (cur)
               {
                 if (cur->_when > now)
-                {
-                  task_sch_queue.push_back(cur);
-                  std::push_heap(task_sch_queue.begin(),
-                                 task_sch_queue.end(), task_when_less());
-                }
+                  task_timers.insert(&cur->_timer, cur, cur->_when);
                 else
                 {
                   cur->_posted_num = next_posted_num - (++tasks_posted);
@@ -266,7 +296,7 @@ namespace fc {
 
             // first, if there are any new tasks on 'task_in_queue', which is tasks that 
             // have been just been async or scheduled, but we haven't processed them.
-            // move them into the task_sch_queue or task_pqueue, as appropriate
+            // move them into task_timers or task_pqueue, as appropriate
 
             //DLN: changed from memory_order_consume for boost 1.55.
             //This appears to be safest replacement for now, maybe
@@ -275,20 +305,29 @@ namespace fc {
             if (pending_list)
               enqueue(pending_list);
 
-            // second, walk through task_sch_queue and move any scheduled tasks that are now
-            // able to run (because their scheduled time has arrived) to task_pqueue
-
-            while (!task_sch_queue.empty() &&
-                   task_sch_queue.front()->_when <= time_point::now())
+            // second, move any scheduled tasks that are now able to run (because their
+            // scheduled time has arrived) to task_pqueue
+            task_timers.advance(cached_now);
+            while (task_base* ready_task = static_cast<task_base*>(task_timers.pop_due()))
             {
-              task_base* ready_task = task_sch_queue.front();
-              std::pop_heap(task_sch_queue.begin(), task_sch_queue.end(), task_when_less());
-              task_sch_queue.pop_back();
-
               ready_task->_posted_num = next_posted_num++;
               task_pqueue.push_back(ready_task);
               std::push_heap(task_pqueue.begin(), task_pqueue.end(), task_priority_less());
             }
+
+            // third, if this thread is a pool worker with nothing left to start, take one
+            // task from the pool.  Only one is taken at a time so the rest stay available
+            // to idle workers.
+            if (pool && task_pqueue.empty())
+            {
+              task_base* pool_task = pool->pull(pool_index);
+              if (pool_task)
+              {
+                pool_task->_posted_num = next_posted_num++;
+                task_pqueue.push_back(pool_task);
+                std::push_heap(task_pqueue.begin(), task_pqueue.end(), task_priority_less());
+              }
+            }
           }
 
            task_base* dequeue() 
@@ -303,28 +342,17 @@ namespace fc {
                 return p;
            }
 
-           bool process_canceled_tasks()
+           /**
+            *  Completes a canceled task that is still waiting for its scheduled time,
+            *  posted here by task_base::cancel() through thread::notify_scheduled_task_canceled()
+            */
+           void cancel_scheduled_task( task_base* t )
            {
-              bool canceled_task = false;
-              for( auto task_itr = task_sch_queue.begin();
-                   task_itr != task_sch_queue.end();
-                   )
-              {
-                 if( (*task_itr)->canceled() )
-                 {
-                    (*task_itr)->run();
-                    (*task_itr)->release();
-                    task_itr = task_sch_queue.erase(task_itr);
-                    canceled_task = true;
-                    continue;
-                 }
-                 ++task_itr;
-              }
-
-              if( canceled_task )  
-                 std::make_heap( task_sch_queue.begin(), task_sch_queue.end(), task_when_less() );
-
-              return canceled_task;
+              if( !detail::timer_wheel::contains( &t->_timer ) )
+                 return; // already started or canceled
+              task_timers.remove( &t->_timer );
+              t->run();
+              t->release();
            }
            
            /**
@@ -370,7 +398,7 @@ namespace fc {
                * is probably just as likely to cause crashes */
               assert(std::current_exception() == std::exception_ptr());
 
-              check_for_timeouts();
+              check_for_timeouts( time_point::now() );
               if( !current ) 
                 current = new fc::context( &fc::thread::current() );
 
@@ -419,19 +447,19 @@ namespace fc {
                 // that will process posted tasks...
                 fc::context* prev = current;
 
-                fc::context* next = nullptr;
-                if( pt_head ) 
+                // start on a stack that suits the task that is going to run first
+                const stack_class cls = task_pqueue.empty() ? stack_class::normal
+                                                            : task_pqueue.front()->_stack_class;
+                fc::context* next = pt_pop( cls );
+                if( next ) 
                 { 
                   // grab cached context
-                  next = pt_head;
-                  pt_head = pt_head->next;
-                  next->next = 0;
                   next->reinitialize();
                 } 
                 else 
                 { 
                   // create new context.
-                  next = new fc::context( &thread_d::start_process_tasks, stack_alloc,
+                  next = new fc::context( &thread_d::start_process_tasks, cls,
                                           &fc::thread::current() );
                 }
 
@@ -509,7 +537,18 @@ namespace fc {
 
               next->_set_active_context( current );
               current->cur_task = next;
+              // the task may attach this thread to a pool, so remember which counter was bumped
+              detail::thread_pool_worker* worker = pool ? pool->workers[pool_index] : nullptr;
+              if (worker)
+                ++worker->running;
               next->run();
+              if (worker)
+                --worker->running;
+              if (current->stack.base && stack_pool::instance().usage_tracking_enabled())
+              {
+                char frame;
+                stack_pool::instance().my->record_usage(current->stack, next->get_desc(), &frame);
+              }
               current->cur_task = 0;
               next->_set_active_context(0);
               next->release();
@@ -519,8 +558,9 @@ namespace fc {
            bool has_next_task() 
            {
              if( task_pqueue.size() ||
-                 (task_sch_queue.size() && task_sch_queue.front()->_when <= time_point::now()) ||
-                 task_in_queue.load( boost::memory_order_relaxed ) )
+                 task_timers.next_wakeup() <= time_point::now() ||
+                 task_in_queue.load() ||
+                 (pool && pool->has_queued()) )
                return true;
              return false;
            }
@@ -536,11 +576,17 @@ namespace fc {
            {
               while( !done || blocked ) 
               {
+                if( parked.load( boost::memory_order_relaxed ) )
+                  parked.store( false, boost::memory_order_relaxed );
+
+                // read the clock once per pass, everything below uses cached_now
+                cached_now = time_point::now();
+
                 // move all new tasks to the task_pqueue
                 move_newly_scheduled_tasks_to_task_pqueue();
 
                 // move all now-ready sleeping tasks to the ready list
-                check_for_timeouts();
+                check_for_timeouts( cached_now );
 
                 if (!task_pqueue.empty())
                 {
@@ -556,6 +602,15 @@ namespace fc {
                     }
                   }
 
+                  // a task that asked for a different stack size is started by a context
+                  // running on one; this one waits in pt_head until a task fits it again
+                  if (task_pqueue.front()->_stack_class != current->stack_cls())
+                  {
+                    pt_push_back(current);
+                    start_next_fiber(false);
+                    continue;
+                  }
+
                   // if we made it here, either there's no ready context, or the ready context is
                   // scheduled after the ready task, so we should run the task first
                   run_next_task();
@@ -571,16 +626,17 @@ namespace fc {
                    continue;
                 }
 
-                if( process_canceled_tasks() ) 
-                  continue;
-
                 clear_free_list();
 
                 { // lock scope
                   boost::unique_lock<boost::mutex> lock(task_ready_mutex);
+                  // posters read 'parked' after publishing their task and we read the
+                  // queues after publishing 'parked' (both seq_cst), so either they see us
+                  // parked and notify, or we see their task here
+                  parked.store( true );
                   if( has_next_task() ) 
                     continue;
-                  time_point timeout_time = check_for_timeouts();
+                  time_point timeout_time = check_for_timeouts( time_point::now() );
                   
                   if( done ) 
                     return;
@@ -588,10 +644,6 @@ namespace fc {
                     task_ready.wait( lock );
                   else if( timeout_time != time_point::min() ) 
                   {
-                     // there may be tasks that have been canceled we should filter them out now
-                     // rather than waiting... 
-
-
                     /* This bit is kind of sloppy -- this wait was originally implemented as a wait
                      * with respect to boost::chrono::system_clock.  This behaved rather comically
                      * if you were to do a:
@@ -619,32 +671,22 @@ namespace fc {
      *    Retunn system_clock::time_point::max() if there are no scheduled tasks
      *    Return the time the next task needs to be run if there is anything scheduled.
      */
-    time_point check_for_timeouts() 
+    time_point check_for_timeouts( const time_point& now ) 
     {
-        if( !sleep_pqueue.size() && !task_sch_queue.size() ) 
+        if( sleep_timers.empty() && task_timers.empty() ) 
         {
           // ilog( "no timeouts ready" );
           return time_point::maximum();
         }
 
-        time_point next = time_point::maximum();
-        if( !sleep_pqueue.empty() && next > sleep_pqueue.front()->resume_time )
-          next = sleep_pqueue.front()->resume_time;
-        if( !task_sch_queue.empty() && next > task_sch_queue.front()->_when )
-          next = task_sch_queue.front()->_when;
-
-        time_point now = time_point::now();
-        if( now < next )
-          return next;
+        task_timers.advance( now );
+        sleep_timers.advance( now );
+        if( !task_timers.has_due() && !sleep_timers.has_due() )
+          return std::min( task_timers.next_wakeup(), sleep_timers.next_wakeup() );
 
         // move all expired sleeping tasks to the ready queue
-        while( sleep_pqueue.size() && sleep_pqueue.front()->resume_time < now ) 
+        while( fc::context* c = static_cast<fc::context*>( sleep_timers.pop_due() ) ) 
         {
-          fc::context::ptr c = sleep_pqueue.front();
-          std::pop_heap(sleep_pqueue.begin(), sleep_pqueue.end(), sleep_priority_less() );
-          // ilog( "sleep pop back..." );
-          sleep_pqueue.pop_back();
-
           if( c->blocking_prom.size() ) 
           {
             // ilog( "timeout blocking prom" );
@@ -688,24 +730,13 @@ namespace fc {
           current->resume_time = tp;
           current->clear_blocking_promises();
 
-          sleep_pqueue.push_back(current);
-          std::push_heap( sleep_pqueue.begin(),
-                          sleep_pqueue.end(), sleep_priority_less()   );
+          sleep_timers.insert( &current->sleep_timer, current, tp );
           
           start_next_fiber(reschedule);
 
           // clear current context from sleep queue...
-          for( uint32_t i = 0; i < sleep_pqueue.size(); ++i ) 
-          {
-            if( sleep_pqueue[i] == current ) 
-            {
-              sleep_pqueue[i] = sleep_pqueue.back();
-              sleep_pqueue.pop_back();
-              std::make_heap( sleep_pqueue.begin(),
-                              sleep_pqueue.end(), sleep_priority_less() );
-              break;
-            }
-          }
+          if( detail::timer_wheel::contains( &current->sleep_timer ) )
+            sleep_timers.remove( &current->sleep_timer );
 
           current->resume_time = time_point::maximum();
           check_fiber_exceptions();
@@ -731,10 +762,7 @@ namespace fc {
           if( timeout != time_point::maximum() ) 
           {
             current->resume_time = timeout;
-            sleep_pqueue.push_back(current);
-            std::push_heap( sleep_pqueue.begin(),
-                            sleep_pqueue.end(), 
-                            sleep_priority_less()   );
+            sleep_timers.insert( &current->sleep_timer, current, timeout );
           }
 
           // elog( "blocking %1%", current );
@@ -747,6 +775,7 @@ namespace fc {
 
           // slog( "                                 %1% unblocking blocking on %2%", current, p.get() );
           current->remove_blocking_promise(p.get());
+          remove_sleep_timer( current );
 
           check_fiber_exceptions();
         }
@@ -777,23 +806,28 @@ namespace fc {
             iter = &(*iter)->next_blocked;
           }
 
-          bool task_removed_from_sleep_pqueue = false;
-          for (auto sleep_iter = sleep_pqueue.begin(); sleep_iter != sleep_pqueue.end();)
+          std::vector<fc::context*> canceled_sleepers;
+          sleep_timers.for_each( [&canceled_sleepers]( void* owner ) {
+            fc::context* c = static_cast<fc::context*>(owner);
+            if (c->canceled)
+              canceled_sleepers.push_back(c);
+          } );
+          for (fc::context* c : canceled_sleepers)
           {
-            if ((*sleep_iter)->canceled)
-            {
-              bool already_on_ready_list = std::find(ready_heap.begin(), ready_heap.end(), 
-                                                     *sleep_iter) != ready_heap.end();
-              if (!already_on_ready_list)
-                add_context_to_ready_list(*sleep_iter);
-              sleep_iter = sleep_pqueue.erase(sleep_iter);
-              task_removed_from_sleep_pqueue = true;
-            }
-            else
-              ++sleep_iter;
+            sleep_timers.remove(&c->sleep_timer);
+            bool already_on_ready_list = std::find(ready_heap.begin(), ready_heap.end(), c) != ready_heap.end();
+            if (!already_on_ready_list)
+              add_context_to_ready_list(c);
           }
-          if (task_removed_from_sleep_pqueue)
-            std::make_heap(sleep_pqueue.begin(), sleep_pqueue.end(), sleep_priority_less());
+        }
+
+        /** takes @p c off sleep_timers if it is still waiting there, @return true if it was */
+        bool remove_sleep_timer( fc::context* c )
+        {
+          if( !detail::timer_wheel::contains( &c->sleep_timer ) )
+            return false;
+          sleep_timers.remove( &c->sleep_timer );
+          return true;
         }
     };
 } // namespace fc
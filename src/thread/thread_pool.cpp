@@ -0,0 +1,210 @@
+#include <fc/thread/thread_pool.hpp>
+#include <fc/thread/unique_lock.hpp>
+#include <fc/exception/exception.hpp>
+#include "thread_d.hpp"
+
+#include <boost/thread/thread.hpp>
+
+namespace fc {
+  namespace detail {
+
+    uint16_t thread_pool_impl::least_loaded()const
+    {
+      // start the scan at a rotating offset so that ties are spread across workers
+      static boost::atomic<uint32_t> next_start(0);
+      const uint16_t count = workers.size();
+      const uint16_t start = next_start.fetch_add( 1, boost::memory_order_relaxed ) % count;
+
+      uint16_t best = start;
+      uint32_t best_load = load(start);
+      for( uint16_t i = 1; i < count && best_load; ++i )
+      {
+        uint16_t candidate = (start + i) % count;
+        uint32_t candidate_load = load(candidate);
+        if( candidate_load < best_load )
+        {
+          best = candidate;
+          best_load = candidate_load;
+        }
+      }
+      return best;
+    }
+
+    void thread_pool_impl::post( task_base* t )
+    {
+      thread_pool_worker* w = workers[least_loaded()];
+      { synchronized( w->pending_lock )
+        w->pending.push_back(t);
+        ++w->queued;
+      }
+      ++total_queued;
+      // workers publish 'parked' before checking has_queued(), and we incremented
+      // total_queued before poke() reads 'parked', so the wakeup cannot be lost
+      w->thread->poke();
+
+      // if the chosen worker is busy, also wake a parked peer so it can steal the task
+      if( !w->thread->my->parked.load() )
+      {
+        for( thread_pool_worker* peer : workers )
+        {
+          if( peer != w && peer->thread->my->parked.load() )
+          {
+            peer->thread->poke();
+            break;
+          }
+        }
+      }
+    }
+
+    task_base* thread_pool_impl::pull( uint16_t index )
+    {
+      if( quitting.load( boost::memory_order_relaxed ) || !has_queued() )
+        return nullptr;
+
+      thread_pool_worker* own = workers[index];
+      if( own->queued.load( boost::memory_order_relaxed ) )
+      {
+        synchronized( own->pending_lock )
+        if( !own->pending.empty() )
+        {
+          task_base* t = own->pending.front();
+          own->pending.pop_front();
+          --own->queued;
+          --total_queued;
+          return t;
+        }
+      }
+
+      // nothing of our own to do, steal from the peer with the longest queue
+      thread_pool_worker* victim = nullptr;
+      uint32_t victim_queued = 0;
+      for( thread_pool_worker* w : workers )
+      {
+        uint32_t q = w->queued.load( boost::memory_order_relaxed );
+        if( w != own && q > victim_queued )
+        {
+          victim = w;
+          victim_queued = q;
+        }
+      }
+      if( victim )
+      {
+        synchronized( victim->pending_lock )
+        if( !victim->pending.empty() )
+        {
+          task_base* t = victim->pending.back();
+          victim->pending.pop_back();
+          --victim->queued;
+          --total_queued;
+          return t;
+        }
+      }
+      return nullptr;
+    }
+
+    void thread_pool_impl::cancel_queued()
+    {
+      for( thread_pool_worker* w : workers )
+      {
+        std::deque<task_base*> canceled;
+        { synchronized( w->pending_lock )
+          canceled.swap( w->pending );
+          w->queued = 0;
+        }
+        for( task_base* t : canceled )
+        {
+          t->set_exception( std::make_shared<canceled_exception>( FC_LOG_MESSAGE( error, "cancellation reason: thread pool quitting" ) ) );
+          t->release();
+        }
+      }
+      total_queued = 0;
+    }
+
+    void thread_pool_impl::attach_current_thread( uint16_t index )
+    {
+      thread_d* d = thread::current().my;
+      d->pool = this;
+      d->pool_index = index;
+    }
+
+  } // namespace detail
+
+  thread_pool::thread_pool( uint16_t num_threads, const std::string& name_prefix )
+  :my( new detail::thread_pool_impl() )
+  {
+    FC_ASSERT( num_threads > 0, "A thread pool needs at least one thread" );
+    my->workers.reserve( num_threads );
+    for( uint16_t i = 0; i < num_threads; ++i )
+    {
+      detail::thread_pool_worker* w = new detail::thread_pool_worker();
+      w->thread = new fc::thread( name_prefix + "-" + std::to_string(i) );
+      my->workers.push_back( w );
+    }
+    // workers must be attached from their own thread; wait() makes the result visible
+    for( uint16_t i = 0; i < num_threads; ++i )
+    {
+      detail::thread_pool_impl* impl = my.get();
+      my->workers[i]->thread->async( [impl,i](){ impl->attach_current_thread(i); },
+                                     "thread_pool::attach" ).wait();
+    }
+  }
+
+  thread_pool::~thread_pool()
+  {
+    quit();
+  }
+
+  void thread_pool::quit()
+  {
+    if( my->quitting.exchange( true ) )
+      return;
+
+    // a post_task() that saw quitting unset may still be using the workers
+    while( my->posting.load() )
+      boost::this_thread::yield();
+
+    my->cancel_queued();
+    for( detail::thread_pool_worker* w : my->workers )
+    {
+      delete w->thread; // quits the thread and joins it
+      w->thread = nullptr;
+    }
+    for( detail::thread_pool_worker* w : my->workers )
+      delete w;
+    my->workers.clear();
+  }
+
+  uint16_t thread_pool::size()const
+  {
+    return my->workers.size();
+  }
+
+  fc::thread& thread_pool::get_thread( uint16_t index )
+  {
+    FC_ASSERT( index < my->workers.size(), "Invalid thread pool index ${i}", ("i",index) );
+    return *my->workers[index]->thread;
+  }
+
+  fc::thread& thread_pool::least_loaded_thread()
+  {
+    FC_ASSERT( !my->workers.empty(), "Thread pool has quit" );
+    return *my->workers[my->least_loaded()]->thread;
+  }
+
+  void thread_pool::post_task( task_base* t, const priority& p )
+  {
+    t->_prio = p;
+    // announce the post before checking quitting, quit() sets quitting before it checks posting
+    ++my->posting;
+    if( my->quitting.load() )
+    {
+      --my->posting;
+      t->set_exception( std::make_shared<canceled_exception>( FC_LOG_MESSAGE( error, "cancellation reason: thread pool quitting" ) ) );
+      t->release();
+      return;
+    }
+    my->post( t );
+    --my->posting;
+  }
+
+} // namespace fc
@@ -0,0 +1,59 @@
+#pragma once
+#include <fc/thread/thread_pool.hpp>
+#include <fc/thread/spin_lock.hpp>
+#include <boost/atomic.hpp>
+#include <deque>
+#include <vector>
+
+namespace fc { namespace detail {
+
+   struct thread_pool_worker
+   {
+      thread_pool_worker() : thread(nullptr), queued(0), running(0) {}
+
+      fc::thread*              thread;
+      fc::spin_lock            pending_lock;
+      std::deque<task_base*>   pending;   // tasks not started yet: the owner pops the front, thieves pop the back
+      boost::atomic<uint32_t>  queued;    // pending.size(), readable without the lock
+      boost::atomic<uint32_t>  running;   // tasks started on this worker that have not returned yet
+   };
+
+   class thread_pool_impl
+   {
+      public:
+         thread_pool_impl() : total_queued(0), quitting(false), posting(0) {}
+
+         std::vector<thread_pool_worker*> workers;
+         boost::atomic<uint32_t>          total_queued;
+         boost::atomic<bool>              quitting;
+         /** calls of post_task() between their quitting check and the end of post(), quit() waits for them */
+         boost::atomic<uint32_t>          posting;
+
+         uint32_t load( uint16_t index )const
+         {
+            return workers[index]->queued.load( boost::memory_order_relaxed ) +
+                   workers[index]->running.load( boost::memory_order_relaxed );
+         }
+
+         uint16_t least_loaded()const;
+
+         bool has_queued()const { return total_queued.load() != 0; }
+
+         void post( task_base* t );
+
+         /**
+          *  Takes the oldest task queued on worker @p index, or steals the newest task queued
+          *  on the most loaded of its peers.  Only called by the worker's own thread.
+          *
+          *  @return nullptr if there is nothing to run
+          */
+         task_base* pull( uint16_t index );
+
+         /** cancels every queued task, called once the pool is quitting */
+         void cancel_queued();
+
+         /** attaches thread_d of the calling thread to this pool */
+         void attach_current_thread( uint16_t index );
+   };
+
+} } // namespace fc::detail
@@ -0,0 +1,307 @@
+#pragma once
+#include <fc/thread/task.hpp>
+#include <fc/time.hpp>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+namespace fc { namespace detail {
+
+   /**
+    *  Hierarchical timing wheel used by thread_d for scheduled tasks and sleeping contexts.
+    *
+    *  Time is divided into ticks of 2^tick_shift microseconds.  Level L has 64 slots, each
+    *  spanning 64^L ticks.  An entry lives on the lowest level on which its expiry and the
+    *  current tick share all higher digits, so insert and remove are O(1) and an entry is
+    *  moved at most once per level on its way down to level 0.  Entries further away than
+    *  the top level can represent wait on an overflow list.
+    *
+    *  Expiry ticks are rounded up and the current tick is rounded down, so entries never
+    *  come due before their time_point; they can come due up to one tick late.
+    */
+   class timer_wheel
+   {
+      public:
+         static const unsigned tick_shift = 10; // ~1ms
+         static const unsigned slot_bits  = 6;
+         static const unsigned slots      = 1 << slot_bits;
+         static const unsigned levels     = 6;  // 2^(10+36) us, a bit over two years
+
+         explicit timer_wheel( const time_point& now = time_point::now() )
+         :_current_tick( tick_floor(now) ), _size(0), _due(nullptr), _overflow(nullptr)
+         {
+            memset( _slots, 0, sizeof(_slots) );
+            memset( _occupied, 0, sizeof(_occupied) );
+         }
+
+         bool     empty()const { return _size == 0; }
+         uint32_t size()const  { return _size; }
+         bool     has_due()const { return _due != nullptr; }
+
+         static bool contains( const timer_hook* h ) { return h->slot != timer_hook::unlinked; }
+
+         void insert( timer_hook* h, void* owner, const time_point& when )
+         {
+            assert( !contains(h) );
+            h->owner = owner;
+            h->expiry_tick = tick_ceil(when);
+            place(h);
+            ++_size;
+         }
+
+         void remove( timer_hook* h )
+         {
+            assert( contains(h) );
+            unlink(h);
+            --_size;
+         }
+
+         /**
+          *  Moves every entry whose time has come to the due list.
+          */
+         void advance( const time_point& now )
+         {
+            const uint64_t target = tick_floor(now);
+            while( true )
+            {
+               uint64_t next = next_event_tick();
+               if( next > target )
+               {
+                  if( target > _current_tick )
+                     _current_tick = target;
+                  return;
+               }
+               _current_tick = next;
+
+               if( (next & top_mask) == 0 && _overflow )
+                  cascade_overflow();
+               for( unsigned level = levels - 1; level > 0; --level )
+               {
+                  if( (next & ((uint64_t(1) << (level * slot_bits)) - 1)) == 0 )
+                     cascade_slot( level, (next >> (level * slot_bits)) & (slots - 1) );
+               }
+               cascade_slot( 0, next & (slots - 1) );
+            }
+         }
+
+         /** @return the owner of the oldest due entry and removes it, or nullptr */
+         void* pop_due()
+         {
+            if( !_due )
+               return nullptr;
+            timer_hook* h = _due;
+            remove(h);
+            return h->owner;
+         }
+
+         /**
+          *  @return time_point::min() if entries are due, time_point::maximum() if the wheel is
+          *  empty, otherwise the time at which advance() next has something to do.  That may be
+          *  a little before the next expiry when entries have to move down a level first.
+          */
+         time_point next_wakeup()const
+         {
+            if( _due )
+               return time_point::min();
+            uint64_t next = next_event_tick();
+            if( next == UINT64_MAX )
+               return time_point::maximum();
+            return time_point( microseconds( int64_t(next << tick_shift) ) );
+         }
+
+         /** calls f(owner) for every entry, due or not; f must not modify the wheel */
+         template<typename Functor>
+         void for_each( Functor&& f )const
+         {
+            for_each_in( _due, f );
+            for_each_in( _overflow, f );
+            for( unsigned level = 0; level < levels; ++level )
+               for( unsigned slot = 0; slot < slots; ++slot )
+                  for_each_in( _slots[level][slot], f );
+         }
+
+         /** removes every entry, calling f(owner) for each after it has been removed */
+         template<typename Functor>
+         void clear( Functor&& f )
+         {
+            for( uint32_t slot = 0; slot <= overflow_slot; ++slot )
+            {
+               timer_hook*& head = list_for(slot);
+               while( head )
+               {
+                  timer_hook* h = head;
+                  remove(h);
+                  f( h->owner );
+               }
+            }
+         }
+
+      private:
+         static const uint32_t due_slot      = levels * slots;
+         static const uint32_t overflow_slot = levels * slots + 1;
+         static const uint64_t top_mask      = (uint64_t(1) << (levels * slot_bits)) - 1;
+
+         static uint64_t tick_floor( const time_point& t )
+         {
+            int64_t us = t.time_since_epoch().count();
+            return us <= 0 ? 0 : uint64_t(us) >> tick_shift;
+         }
+         static uint64_t tick_ceil( const time_point& t )
+         {
+            int64_t us = t.time_since_epoch().count();
+            if( us <= 0 )
+               return 0;
+            return (uint64_t(us) + (uint64_t(1) << tick_shift) - 1) >> tick_shift;
+         }
+
+         static unsigned lowest_bit( uint64_t v )
+         {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward64( &index, v );
+            return index;
+#else
+            return __builtin_ctzll(v);
+#endif
+         }
+         static unsigned highest_bit( uint64_t v )
+         {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanReverse64( &index, v );
+            return index;
+#else
+            return 63 - __builtin_clzll(v);
+#endif
+         }
+
+         timer_hook*& list_for( uint32_t slot )
+         {
+            if( slot == due_slot )
+               return _due;
+            if( slot == overflow_slot )
+               return _overflow;
+            return _slots[slot / slots][slot % slots];
+         }
+
+         /** appends to the circular list of @p slot, keeping insertion order */
+         void link( timer_hook* h, uint32_t slot )
+         {
+            timer_hook*& head = list_for(slot);
+            if( !head )
+            {
+               h->next = h->prev = h;
+               head = h;
+            }
+            else
+            {
+               h->prev = head->prev;
+               h->next = head;
+               head->prev->next = h;
+               head->prev = h;
+            }
+            h->slot = slot;
+            if( slot < due_slot )
+               _occupied[slot / slots] |= uint64_t(1) << (slot % slots);
+         }
+
+         void unlink( timer_hook* h )
+         {
+            timer_hook*& head = list_for(h->slot);
+            if( h->next == h )
+            {
+               head = nullptr;
+               if( h->slot < due_slot )
+                  _occupied[h->slot / slots] &= ~(uint64_t(1) << (h->slot % slots));
+            }
+            else
+            {
+               h->prev->next = h->next;
+               h->next->prev = h->prev;
+               if( head == h )
+                  head = h->next;
+            }
+            h->next = h->prev = nullptr;
+            h->slot = timer_hook::unlinked;
+         }
+
+         void place( timer_hook* h )
+         {
+            if( h->expiry_tick <= _current_tick )
+               return link( h, due_slot );
+            unsigned level = highest_bit( h->expiry_tick ^ _current_tick ) / slot_bits;
+            if( level >= levels )
+               return link( h, overflow_slot );
+            link( h, level * slots + ((h->expiry_tick >> (level * slot_bits)) & (slots - 1)) );
+         }
+
+         /** re-places everything on the overflow list, some of it may land there again */
+         void cascade_overflow()
+         {
+            timer_hook* head = _overflow;
+            _overflow = nullptr;
+            timer_hook* h = head;
+            do {
+               timer_hook* next = h->next;
+               h->next = h->prev = nullptr;
+               h->slot = timer_hook::unlinked;
+               place(h);
+               h = next;
+            } while( h != head );
+         }
+
+         void cascade_slot( unsigned level, uint64_t slot )
+         {
+            timer_hook*& head = _slots[level][slot];
+            while( head )
+            {
+               timer_hook* h = head;
+               unlink(h);
+               place(h);
+            }
+         }
+
+         /** @return the earliest tick after the current one at which advance() has work */
+         uint64_t next_event_tick()const
+         {
+            for( unsigned level = 0; level < levels; ++level )
+            {
+               const unsigned shift = level * slot_bits;
+               const unsigned current_slot = (_current_tick >> shift) & (slots - 1);
+               if( current_slot == slots - 1 )
+                  continue;
+               uint64_t later = _occupied[level] & (~uint64_t(0) << (current_slot + 1));
+               if( later )
+                  return ((_current_tick >> (shift + slot_bits)) << (shift + slot_bits)) |
+                         (uint64_t(lowest_bit(later)) << shift);
+            }
+            if( _overflow )
+               return ((_current_tick >> (levels * slot_bits)) + 1) << (levels * slot_bits);
+            return UINT64_MAX;
+         }
+
+         template<typename Functor>
+         static void for_each_in( timer_hook* head, Functor& f )
+         {
+            if( !head )
+               return;
+            timer_hook* h = head;
+            do {
+               f( h->owner );
+               h = h->next;
+            } while( h != head );
+         }
+
+         uint64_t     _current_tick;
+         uint32_t     _size;
+         timer_hook*  _slots[levels][slots];
+         uint64_t     _occupied[levels];
+         timer_hook*  _due;
+         timer_hook*  _overflow;
+   };
+
+} } // namespace fc::detail
@@ -10,6 +10,7 @@
 #include <boost/scoped_array.hpp>
 #include <fc/reflect/variant.hpp>
 #include <algorithm>
+#include <atomic>
 
 namespace fc
 {
@@ -22,6 +23,112 @@ void set_variant_type( variant* v, variant::type_id t)
    data[ sizeof(variant) -1 ] = t;
 }
 
+namespace {
+   /**
+    *  Heap storage of long strings, blobs, arrays and objects, shared by the variants
+    *  copied from each other.  Once a mutable reference to the value has been handed out
+    *  it is unshareable, and copies get their own payload.
+    */
+   template<typename T>
+   struct shared_payload
+   {
+      template<typename... Args>
+      explicit shared_payload( Args&&... args ) : refs(1), unshareable(false), value( std::forward<Args>(args)... ) {}
+
+      std::atomic<uint32_t> refs;
+      bool                  unshareable;
+      T                     value;
+   };
+
+   template<typename T>
+   shared_payload<T>*& payload( variant* v ) { return *reinterpret_cast<shared_payload<T>**>(v); }
+   template<typename T>
+   shared_payload<T>* payload( const variant* v ) { return *reinterpret_cast<shared_payload<T>* const*>(v); }
+
+   template<typename T, typename... Args>
+   void set_payload( variant* v, variant::type_id t, Args&&... args )
+   {
+      payload<T>( v ) = new shared_payload<T>( std::forward<Args>(args)... );
+      set_variant_type( v, t );
+   }
+
+   template<typename T>
+   shared_payload<T>* share( shared_payload<T>* p )
+   {
+      if( p->unshareable )
+         return new shared_payload<T>( p->value );
+      p->refs.fetch_add( 1, std::memory_order_relaxed );
+      return p;
+   }
+
+   template<typename T>
+   void release( shared_payload<T>* p )
+   {
+      if( p->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+         delete p;
+   }
+
+   /** @return the value of @p v for modification, copied first if other variants share it */
+   template<typename T>
+   T& unshare( variant* v )
+   {
+      shared_payload<T>*& p = payload<T>( v );
+      if( p->refs.load( std::memory_order_acquire ) != 1 )
+      {
+         shared_payload<T>* copy = new shared_payload<T>( p->value );
+         release( p );
+         p = copy;
+      }
+      p->unshareable = true;
+      return p->value;
+   }
+
+   /**
+    *  Short strings use the bytes before the type, with their length and inline_flag in
+    *  the byte right before it.
+    */
+   const size_t  max_inline_string = sizeof(variant) - 2;
+   const uint8_t inline_flag       = 0x80;
+
+   uint8_t& inline_tag( variant* v ) { return reinterpret_cast<uint8_t*>(v)[ sizeof(variant) - 2 ]; }
+   uint8_t  inline_tag( const variant* v ) { return reinterpret_cast<const uint8_t*>(v)[ sizeof(variant) - 2 ]; }
+
+   void set_string( variant* v, const char* str, size_t len )
+   {
+      if( len <= max_inline_string )
+      {
+         memcpy( reinterpret_cast<char*>( v ), str, len );
+         inline_tag( v ) = inline_flag | len;
+         set_variant_type( v, variant::string_type );
+      }
+      else
+      {
+         set_payload<string>( v, variant::string_type, str, len );
+         inline_tag( v ) = 0;
+      }
+   }
+
+   void set_string( variant* v, string&& str )
+   {
+      if( str.size() <= max_inline_string )
+         set_string( v, str.data(), str.size() );
+      else
+      {
+         set_payload<string>( v, variant::string_type, std::move(str) );
+         inline_tag( v ) = 0;
+      }
+   }
+
+   /** @pre v->get_type() == string_type */
+   boost::string_view string_of( const variant* v )
+   {
+      const uint8_t tag = inline_tag( v );
+      if( tag & inline_flag )
+         return boost::string_view( reinterpret_cast<const char*>(v), tag & ~inline_flag );
+      return payload<string>( v )->value;
+   }
+}
+
 variant::variant()
 {
    set_variant_type( this, null_type );
@@ -100,14 +207,12 @@ variant::variant( bool val, uint32_t max_depth )
 
 variant::variant( char* str, uint32_t max_depth )
 {
-   *reinterpret_cast<string**>(this)  = new string( str );
-   set_variant_type( this, string_type );
+   set_string( this, str, strlen( str ) );
 }
 
 variant::variant( const char* str, uint32_t max_depth )
 {
-   *reinterpret_cast<string**>(this)  = new string( str );
-   set_variant_type( this, string_type );
+   set_string( this, str, strlen( str ) );
 }
 
 // TODO: do a proper conversion to utf8
@@ -117,8 +222,7 @@ variant::variant( wchar_t* str, uint32_t max_depth )
    boost::scoped_array<char> buffer(new char[len]);
    for (unsigned i = 0; i < len; ++i)
       buffer[i] = (char)str[i];
-   *reinterpret_cast<string**>(this)  = new string(buffer.get(), len);
-   set_variant_type( this, string_type );
+   set_string( this, buffer.get(), len );
 }
 
 // TODO: do a proper conversion to utf8
@@ -128,55 +232,48 @@ variant::variant( const wchar_t* str, uint32_t max_depth )
    boost::scoped_array<char> buffer(new char[len]);
    for (unsigned i = 0; i < len; ++i)
       buffer[i] = (char)str[i];
-   *reinterpret_cast<string**>(this)  = new string(buffer.get(), len);
-   set_variant_type( this, string_type );
+   set_string( this, buffer.get(), len );
 }
 
 variant::variant( fc::string val, uint32_t max_depth )
 {
-   *reinterpret_cast<string**>(this)  = new string( fc::move(val) );
-   set_variant_type( this, string_type );
+   set_string( this, fc::move(val) );
 }
 variant::variant( blob val, uint32_t max_depth )
 {
-   *reinterpret_cast<blob**>(this)  = new blob( fc::move(val) );
-   set_variant_type( this, blob_type );
+   set_payload<blob>( this, blob_type, fc::move(val) );
 }
 
 variant::variant( variant_object obj, uint32_t max_depth )
 {
-   *reinterpret_cast<variant_object**>(this) = new variant_object(fc::move(obj));
-   set_variant_type(this,  object_type );
+   set_payload<variant_object>( this, object_type, fc::move(obj) );
 }
 variant::variant( mutable_variant_object obj, uint32_t max_depth )
 {
-   *reinterpret_cast<variant_object**>(this) = new variant_object(fc::move(obj));
-   set_variant_type(this,  object_type );
+   set_payload<variant_object>( this, object_type, fc::move(obj) );
 }
 
 variant::variant( variants arr, uint32_t max_depth )
 {
-   *reinterpret_cast<variants**>(this)  = new variants(fc::move(arr));
-   set_variant_type(this,  array_type );
+   set_payload<variants>( this, array_type, fc::move(arr) );
 }
 
-typedef const variant_object* const_variant_object_ptr; 
-typedef const variants* const_variants_ptr; 
-typedef const blob*   const_blob_ptr; 
-typedef const string* const_string_ptr;
-
 void variant::clear()
 {
    switch( get_type() )
    {
      case object_type:
-        delete *reinterpret_cast<variant_object**>(this);
+        release( payload<variant_object>( this ) );
         break;
      case array_type:
-        delete *reinterpret_cast<variants**>(this);
+        release( payload<variants>( this ) );
+        break;
+     case blob_type:
+        release( payload<blob>( this ) );
         break;
      case string_type:
-        delete *reinterpret_cast<string**>(this);
+        if( !( inline_tag( this ) & inline_flag ) )
+           release( payload<string>( this ) );
         break;
      default:
         break;
@@ -189,26 +286,28 @@ variant::variant( const variant& v, uint32_t max_depth )
    switch( v.get_type() )
    {
        case object_type:
-          *reinterpret_cast<variant_object**>(this)  = 
-             new variant_object(**reinterpret_cast<const const_variant_object_ptr*>(&v));
+          payload<variant_object>( this ) = share( payload<variant_object>( &v ) );
           set_variant_type( this, object_type );
           return;
        case array_type:
-          *reinterpret_cast<variants**>(this)  = 
-             new variants(**reinterpret_cast<const const_variants_ptr*>(&v));
-          set_variant_type( this,  array_type );
+          payload<variants>( this ) = share( payload<variants>( &v ) );
+          set_variant_type( this, array_type );
+          return;
+       case blob_type:
+          payload<blob>( this ) = share( payload<blob>( &v ) );
+          set_variant_type( this, blob_type );
           return;
        case string_type:
-          *reinterpret_cast<string**>(this)  = 
-             new string(**reinterpret_cast<const const_string_ptr*>(&v) );
-          set_variant_type( this, string_type );
+          memcpy( this, &v, sizeof(v) );
+          if( !( inline_tag( this ) & inline_flag ) )
+             payload<string>( this ) = share( payload<string>( &v ) );
           return;
        default:
           memcpy( this, &v, sizeof(v) );
    }
 }
 
-variant::variant( variant&& v, uint32_t max_depth )
+variant::variant( variant&& v, uint32_t max_depth )noexcept
 {
    memcpy( this, &v, sizeof(v) );
    set_variant_type( &v, null_type );
@@ -219,7 +318,7 @@ variant::~variant()
    clear();
 }
 
-variant& variant::operator=( variant&& v )
+variant& variant::operator=( variant&& v )noexcept
 {
    if( this == &v ) return *this;
    clear();
@@ -233,26 +332,8 @@ variant& variant::operator=( const variant& v )
    if( this == &v ) 
       return *this;
 
-   clear();
-   switch( v.get_type() )
-   {
-      case object_type:
-         *reinterpret_cast<variant_object**>(this)  = 
-            new variant_object((**reinterpret_cast<const const_variant_object_ptr*>(&v)));
-         break;
-      case array_type:
-         *reinterpret_cast<variants**>(this)  = 
-            new variants((**reinterpret_cast<const const_variants_ptr*>(&v)));
-         break;
-      case string_type:
-         *reinterpret_cast<string**>(this)  = new string((**reinterpret_cast<const const_string_ptr*>(&v)) );
-         break;
-
-      default:
-         memcpy( this, &v, sizeof(v) );
-   }
-   set_variant_type( this, v.get_type() );
-   return *this;
+   variant tmp( v );
+   return *this = fc::move( tmp );
 }
 
 void  variant::visit( const visitor& v )const
@@ -275,13 +356,13 @@ void  variant::visit( const visitor& v )const
          v.handle( *reinterpret_cast<const bool*>(this) );
          return;
       case string_type:
-         v.handle( **reinterpret_cast<const const_string_ptr*>(this) );
+         v.handle( get_string() );
          return;
       case array_type:
-         v.handle( **reinterpret_cast<const const_variants_ptr*>(this) );
+         v.handle( get_array() );
          return;
       case object_type:
-         v.handle( **reinterpret_cast<const const_variant_object_ptr*>(this) );
+         v.handle( get_object() );
          return;
       default:
          FC_THROW_EXCEPTION( assert_exception, "Invalid Type / Corrupted Memory" );
@@ -366,7 +447,7 @@ int64_t variant::as_int64()const
    switch( get_type() )
    {
       case string_type:
-          return to_int64(**reinterpret_cast<const const_string_ptr*>(this)); 
+          return to_int64(get_string()); 
       case double_type:
           return int64_t(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -387,7 +468,7 @@ uint64_t variant::as_uint64()const
    switch( get_type() )
    {
       case string_type:
-          return to_uint64(**reinterpret_cast<const const_string_ptr*>(this)); 
+          return to_uint64(get_string()); 
       case double_type:
           return static_cast<uint64_t>(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -409,7 +490,7 @@ double  variant::as_double()const
    switch( get_type() )
    {
       case string_type:
-          return to_double(**reinterpret_cast<const const_string_ptr*>(this)); 
+          return to_double(get_string()); 
       case double_type:
           return *reinterpret_cast<const double*>(this);
       case int64_type:
@@ -431,7 +512,7 @@ bool  variant::as_bool()const
    {
       case string_type:
       {
-          const string& s = **reinterpret_cast<const const_string_ptr*>(this);
+          const boost::string_view s = string_of( this );
           if( s == "true" )
              return true;
           if( s == "false" )
@@ -458,7 +539,7 @@ string    variant::as_string()const
    switch( get_type() )
    {
       case string_type:
-          return **reinterpret_cast<const const_string_ptr*>(this); 
+          return get_string();
       case double_type:
           return to_string(*reinterpret_cast<const double*>(this)); 
       case int64_type:
@@ -483,21 +564,21 @@ string    variant::as_string()const
 variants&         variant::get_array()
 {
   if( get_type() == array_type )
-     return **reinterpret_cast<variants**>(this);
+     return unshare<variants>( this );
    
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Array", ("type",get_type()) );
 }
 blob&         variant::get_blob()
 {
   if( get_type() == blob_type )
-     return **reinterpret_cast<blob**>(this);
+     return unshare<blob>( this );
    
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Blob", ("type",get_type()) );
 }
 const blob&         variant::get_blob()const
 {
   if( get_type() == blob_type )
-     return **reinterpret_cast<const const_blob_ptr*>(this);
+     return payload<blob>( this )->value;
    
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Blob", ("type",get_type()) );
 }
@@ -510,7 +591,7 @@ blob variant::as_blob()const
       case blob_type: return get_blob();
       case string_type:
       {
-         const string& str = get_string();
+         const boost::string_view str = get_string_view();
          if( str.size() == 0 ) return blob();
          if( str.back() == '=' )
          {
@@ -532,7 +613,7 @@ blob variant::as_blob()const
 const variants&       variant::get_array()const
 {
   if( get_type() == array_type )
-     return **reinterpret_cast<const const_variants_ptr*>(this);
+     return payload<variants>( this )->value;
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Array", ("type",get_type()) );
 }
 
@@ -541,7 +622,7 @@ const variants&       variant::get_array()const
 variant_object&        variant::get_object()
 {
   if( get_type() == object_type )
-     return **reinterpret_cast<variant_object**>(this);
+     return unshare<variant_object>( this );
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Object", ("type",get_type()) );
 }
 
@@ -559,10 +640,15 @@ size_t            variant::size()const
     return get_array().size();
 }
 
-const string&        variant::get_string()const
+string               variant::get_string()const
+{
+  return get_string_view().to_string();
+}
+
+boost::string_view   variant::get_string_view()const
 {
   if( get_type() == string_type )
-     return **reinterpret_cast<const const_string_ptr*>(this);
+     return string_of( this );
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to Object", ("type",get_type()) );
 }
 
@@ -570,7 +656,7 @@ const string&        variant::get_string()const
 const variant_object&  variant::get_object()const
 {
   if( get_type() == object_type )
-     return **reinterpret_cast<const const_variant_object_ptr*>(this);
+     return payload<variant_object>( this )->value;
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to Object", ("type",get_type()) );
 }
 
@@ -1,6 +1,8 @@
 #include <fc/variant_object.hpp>
 #include <fc/exception/exception.hpp>
 #include <assert.h>
+#include <atomic>
+#include <string.h>
 
 
 namespace fc
@@ -47,18 +49,185 @@ namespace fc
       fc_swap( _value, v );
    }
 
+   // ---------------------------------------------------------------
+   // key index
+
+   namespace detail
+   {
+      typedef variant_object::entry entry;
+
+      /**
+       *  Open addressed hash table from keys to the position of their first entry.  Slots
+       *  keep the hash next to the position, so probing only compares keys on a hash match.
+       */
+      class variant_object_index
+      {
+         public:
+            /** objects with fewer entries are searched linearly */
+            static const size_t min_entries = 8;
+
+            explicit variant_object_index( const std::vector<entry>& entries )
+            :_count(0)
+            {
+               _slots.resize( capacity_for( entries.size() ) );
+               for( size_t pos = 0; pos < entries.size(); ++pos )
+                  add( entries, pos );
+            }
+
+            /** @return the position of the first entry with @p key, or entries.size() */
+            size_t find( const std::vector<entry>& entries, const char* key )const
+            {
+               const size_t len = strlen( key );
+               const uint32_t h = hash( key, len );
+               for( size_t i = h & mask(); _slots[i].position; i = ( i + 1 ) & mask() )
+               {
+                  if( _slots[i].hash != h )
+                     continue;
+                  const string& k = entries[ _slots[i].position - 1 ].key();
+                  if( k.size() == len && memcmp( k.data(), key, len ) == 0 )
+                     return _slots[i].position - 1;
+               }
+               return entries.size();
+            }
+
+            /** indexes entries[pos], unless an earlier entry has the same key */
+            void add( const std::vector<entry>& entries, size_t pos )
+            {
+               FC_ASSERT( pos < UINT32_MAX, "Too many keys in variant_object" );
+               const string& key = entries[pos].key();
+               const uint32_t h = hash( key.data(), key.size() );
+               size_t i = h & mask();
+               for( ; _slots[i].position; i = ( i + 1 ) & mask() )
+               {
+                  if( _slots[i].hash != h )
+                     continue;
+                  const string& k = entries[ _slots[i].position - 1 ].key();
+                  if( k == key )
+                     return;
+               }
+               _slots[i].hash = h;
+               _slots[i].position = uint32_t( pos + 1 );
+               if( ++_count * 2 > _slots.size() )
+                  grow();
+            }
+
+         private:
+            struct slot
+            {
+               uint32_t hash     = 0;
+               uint32_t position = 0; ///< of the entry plus one, 0 for an empty slot
+            };
+
+            static size_t capacity_for( size_t entries )
+            {
+               size_t capacity = 32;
+               while( capacity < entries * 2 + 1 )
+                  capacity *= 2;
+               return capacity;
+            }
+
+            /** FNV-1a */
+            static uint32_t hash( const char* key, size_t len )
+            {
+               uint32_t h = 2166136261u;
+               for( size_t i = 0; i < len; ++i )
+                  h = ( h ^ uint8_t(key[i]) ) * 16777619u;
+               return h;
+            }
+
+            size_t mask()const { return _slots.size() - 1; }
+
+            void grow()
+            {
+               std::vector<slot> old( _slots.size() * 2 );
+               old.swap( _slots );
+               for( const slot& s : old )
+               {
+                  if( !s.position )
+                     continue;
+                  size_t i = s.hash & mask();
+                  while( _slots[i].position )
+                     i = ( i + 1 ) & mask();
+                  _slots[i] = s;
+               }
+            }
+
+            std::vector<slot> _slots;
+            size_t            _count;
+      };
+
+      /**
+       *  The entries of a variant_object or mutable_variant_object.  The index is built by
+       *  the first lookup, possibly concurrently on a shared variant_object, and published
+       *  atomically; only the owner of a mutable_variant_object changes it afterwards.
+       */
+      struct variant_object_data
+      {
+         variant_object_data() : index( nullptr ) {}
+         variant_object_data( const variant_object_data& d ) : entries( d.entries ), index( nullptr ) {}
+         ~variant_object_data() { delete index.load(); }
+
+         variant_object_data& operator=( const variant_object_data& d )
+         {
+            if( this != &d )
+            {
+               entries = d.entries;
+               reset_index();
+            }
+            return *this;
+         }
+
+         /** @return the position of the first entry with @p key, or entries.size() */
+         size_t find( const char* key )const
+         {
+            if( entries.size() < variant_object_index::min_entries )
+            {
+               for( size_t pos = 0; pos < entries.size(); ++pos )
+                  if( entries[pos].key() == key )
+                     return pos;
+               return entries.size();
+            }
+            variant_object_index* i = index.load( std::memory_order_acquire );
+            if( !i )
+            {
+               variant_object_index* built = new variant_object_index( entries );
+               if( index.compare_exchange_strong( i, built, std::memory_order_acq_rel ) )
+                  i = built;
+               else
+                  delete built;
+            }
+            return i->find( entries, key );
+         }
+
+         void append( entry&& e )
+         {
+            entries.push_back( fc::move(e) );
+            if( variant_object_index* i = index.load( std::memory_order_relaxed ) )
+               i->add( entries, entries.size() - 1 );
+         }
+
+         void reset_index()
+         {
+            delete index.exchange( nullptr );
+         }
+
+         std::vector<entry>                          entries;
+         mutable std::atomic<variant_object_index*>  index;
+      };
+   }
+
    // ---------------------------------------------------------------
    // variant_object
 
    variant_object::iterator variant_object::begin() const
    {
       assert( _key_value != nullptr );
-      return _key_value->begin();
+      return _key_value->entries.begin();
    }
 
    variant_object::iterator variant_object::end() const
    {
-      return _key_value->end();
+      return _key_value->entries.end();
    }
 
    variant_object::iterator variant_object::find( const string& key )const
@@ -68,14 +237,7 @@ namespace fc
 
    variant_object::iterator variant_object::find( const char* key )const
    {
-      for( auto itr = begin(); itr != end(); ++itr )
-      {
-         if( itr->key() == key )
-         {
-            return itr;
-         }
-      }
-      return end();
+      return begin() + _key_value->find( key );
    }
 
    const variant& variant_object::operator[]( const string& key )const
@@ -92,18 +254,18 @@ namespace fc
 
    size_t variant_object::size() const
    {
-      return _key_value->size();
+      return _key_value->entries.size();
    }
 
    variant_object::variant_object() 
-      :_key_value(std::make_shared<std::vector<entry>>() )
+      :_key_value(std::make_shared<detail::variant_object_data>() )
    {
    }
 
    variant_object::variant_object( string key, variant val )
-      : _key_value(std::make_shared<std::vector<entry>>())
+      : _key_value(std::make_shared<detail::variant_object_data>())
    {
-       _key_value->emplace_back(entry(fc::move(key), fc::move(val)));
+       _key_value->entries.emplace_back(entry(fc::move(key), fc::move(val)));
    }
 
    variant_object::variant_object( const variant_object& obj )
@@ -115,12 +277,12 @@ namespace fc
    variant_object::variant_object( variant_object&& obj)
    : _key_value( fc::move(obj._key_value) )
    {
-      obj._key_value = std::make_shared<std::vector<entry>>();
+      obj._key_value = std::make_shared<detail::variant_object_data>();
       assert( _key_value != nullptr );
    }
 
    variant_object::variant_object( const mutable_variant_object& obj )
-      : _key_value(std::make_shared<std::vector<entry>>(*obj._key_value))
+      : _key_value(std::make_shared<detail::variant_object_data>(*obj._key_value))
    {
    }
 
@@ -152,13 +314,13 @@ namespace fc
    variant_object& variant_object::operator=( mutable_variant_object&& obj )
    {
       _key_value = fc::move(obj._key_value);
-      obj._key_value.reset( new std::vector<entry>() );
+      obj._key_value.reset( new detail::variant_object_data() );
       return *this;
    }
 
    variant_object& variant_object::operator=( const mutable_variant_object& obj )
    {
-      *_key_value = *obj._key_value;
+      _key_value = std::make_shared<detail::variant_object_data>( *obj._key_value );
       return *this;
    }
 
@@ -177,22 +339,22 @@ namespace fc
 
    mutable_variant_object::iterator mutable_variant_object::begin()
    {
-      return _key_value->begin();
+      return _key_value->entries.begin();
    }
 
    mutable_variant_object::iterator mutable_variant_object::end() 
    {
-      return _key_value->end();
+      return _key_value->entries.end();
    }
 
    mutable_variant_object::iterator mutable_variant_object::begin() const
    {
-      return _key_value->begin();
+      return _key_value->entries.begin();
    }
 
    mutable_variant_object::iterator mutable_variant_object::end() const
    {
-      return _key_value->end();
+      return _key_value->entries.end();
    }
 
    mutable_variant_object::iterator mutable_variant_object::find( const string& key )const
@@ -202,14 +364,7 @@ namespace fc
 
    mutable_variant_object::iterator mutable_variant_object::find( const char* key )const
    {
-      for( auto itr = begin(); itr != end(); ++itr )
-      {
-         if( itr->key() == key )
-         {
-            return itr;
-         }
-      }
-      return end();
+      return begin() + _key_value->find( key );
    }
 
    mutable_variant_object::iterator mutable_variant_object::find( const string& key )
@@ -219,14 +374,7 @@ namespace fc
 
    mutable_variant_object::iterator mutable_variant_object::find( const char* key )
    {
-      for( auto itr = begin(); itr != end(); ++itr )
-      {
-         if( itr->key() == key )
-         {
-            return itr;
-         }
-      }
-      return end();
+      return begin() + _key_value->find( key );
    }
 
    const variant& mutable_variant_object::operator[]( const string& key )const
@@ -249,33 +397,33 @@ namespace fc
    {
       auto itr = find( key );
       if( itr != end() ) return itr->value();
-      _key_value->emplace_back(entry(key, variant()));
-      return _key_value->back().value();
+      _key_value->append(entry(key, variant()));
+      return _key_value->entries.back().value();
    }
 
    size_t mutable_variant_object::size() const
    {
-      return _key_value->size();
+      return _key_value->entries.size();
    }
 
    mutable_variant_object::mutable_variant_object() 
-      :_key_value(new std::vector<entry>)
+      :_key_value(new detail::variant_object_data)
    {
    }
 
    mutable_variant_object::mutable_variant_object( string key, variant val )
-      : _key_value(new std::vector<entry>())
+      : _key_value(new detail::variant_object_data())
    {
-       _key_value->push_back(entry(fc::move(key), fc::move(val)));
+       _key_value->entries.push_back(entry(fc::move(key), fc::move(val)));
    }
 
    mutable_variant_object::mutable_variant_object( const variant_object& obj )
-      : _key_value( new std::vector<entry>(*obj._key_value) )
+      : _key_value( new detail::variant_object_data(*obj._key_value) )
    {
    }
 
    mutable_variant_object::mutable_variant_object( const mutable_variant_object& obj )
-      : _key_value( new std::vector<entry>(*obj._key_value) )
+      : _key_value( new detail::variant_object_data(*obj._key_value) )
    {
    }
 
@@ -284,6 +432,10 @@ namespace fc
    {
    }
 
+   mutable_variant_object::~mutable_variant_object()
+   {
+   }
+
    mutable_variant_object& mutable_variant_object::operator=( const variant_object& obj )
    {
       *_key_value = *obj._key_value;
@@ -310,18 +462,16 @@ namespace fc
 
    void mutable_variant_object::reserve( size_t s )
    {
-      _key_value->reserve(s);
+      _key_value->entries.reserve(s);
    }
 
    void  mutable_variant_object::erase( const string& key )
    {
-      for( auto itr = begin(); itr != end(); ++itr )
+      auto itr = find( key.c_str() );
+      if( itr != end() )
       {
-         if( itr->key() == key )
-         {
-            _key_value->erase(itr);
-            return;
-         }
+         _key_value->entries.erase(itr);
+         _key_value->reset_index();
       }
    }
 
@@ -335,7 +485,7 @@ namespace fc
       }
       else
       {
-         _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+         _key_value->append( entry( fc::move(key), fc::move(var) ) );
       }
       return *this;
    }
@@ -345,7 +495,7 @@ namespace fc
     */
    mutable_variant_object& mutable_variant_object::operator()( string key, variant var, uint32_t max_depth )
    {
-      _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+      _key_value->append( entry( fc::move(key), fc::move(var) ) );
       return *this;
    }
 
@@ -0,0 +1,46 @@
+#include <fc/crypto/base58.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ *  Reports base58 encode and decode throughput for payloads the size of public keys
+ *  with checksums, extended keys and larger blobs.
+ *
+ *  usage: base58_bench [iterations]
+ */
+
+namespace {
+   typedef std::chrono::steady_clock clock_type;
+
+   template<typename Op>
+   double measure( size_t iterations, Op&& op )
+   {
+      const auto start = clock_type::now();
+      for( size_t i = 0; i < iterations; ++i )
+         op();
+      return std::chrono::duration<double,std::nano>( clock_type::now() - start ).count() / iterations;
+   }
+}
+
+int main( int argc, char** argv )
+{
+   const size_t iterations = argc > 1 ? std::stoull( argv[1] ) : 100000;
+   size_t sink = 0;
+   for( size_t size : { 33, 37, 53, 82, 256 } )
+   {
+      std::vector<char> data( size );
+      for( size_t i = 0; i < size; ++i )
+         data[i] = char( i * 131 + 7 );
+      const std::string encoded = fc::to_base58( data );
+      char buffer[256];
+
+      const double encode = measure( iterations, [&](){ sink += fc::to_base58( data.data(), data.size() ).size(); } );
+      const double decode = measure( iterations, [&](){ sink += fc::from_base58( encoded, buffer, sizeof(buffer) ); } );
+      std::cout << size << " bytes: encode " << encode << " ns, decode " << decode << " ns, "
+                << 1e3 / decode << " M decodes/s\n";
+   }
+   return sink == 0;
+}
@@ -0,0 +1,89 @@
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/crypto/sha256.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ *  Compares hash_many with every implementation the cpu supports to hashing the same
+ *  messages one at a time, and a merkle root over the leaves to computing it with
+ *  sha256::hash per node.
+ *
+ *  usage: hash_bench [messages]
+ */
+
+namespace {
+   typedef std::chrono::steady_clock clock_type;
+
+   template<typename Op>
+   double measure( size_t messages, Op&& op )
+   {
+      size_t rounds = 0;
+      const auto start = clock_type::now();
+      do {
+         op();
+         ++rounds;
+      } while( clock_type::now() - start < std::chrono::milliseconds( 200 ) );
+      return std::chrono::duration<double,std::nano>( clock_type::now() - start ).count() / ( rounds * messages );
+   }
+
+   fc::sha256 merkle_root_by_loop( std::vector<fc::sha256> level )
+   {
+      while( level.size() > 1 )
+      {
+         std::vector<fc::sha256> parents;
+         for( size_t i = 0; i < level.size(); i += 2 )
+            parents.push_back( i + 1 < level.size() ? fc::sha256::hash( level[i].data(), 2 * sizeof(fc::sha256) ) : level[i] );
+         level.swap( parents );
+      }
+      return level.front();
+   }
+}
+
+int main( int argc, char** argv )
+{
+   const size_t count = argc > 1 ? std::stoull( argv[1] ) : 10000;
+   size_t sink = 0;
+
+   std::vector<fc::sha256> leaves( count );
+   for( size_t i = 0; i < count; ++i )
+      leaves[i] = fc::sha256::hash( fc::to_string( uint64_t(i) ) );
+
+   for( size_t size : { 32, 64, 200, 1000 } )
+   {
+      std::vector<std::string> messages( count, std::string( size, 'x' ) );
+      const std::vector<fc::digest_input> inputs( messages.begin(), messages.end() );
+      std::vector<fc::sha256> sha( count );
+      std::vector<fc::ripemd160> ripemd( count );
+
+      std::cout << size << " byte messages, ns per message\n";
+      std::cout << "  one at a time: sha256 "
+                << measure( count, [&](){ for( size_t i = 0; i < count; ++i ) sha[i] = fc::sha256::hash( messages[i] ); } )
+                << ", ripemd160 "
+                << measure( count, [&](){ for( size_t i = 0; i < count; ++i ) ripemd[i] = fc::ripemd160::hash( messages[i] ); } )
+                << "\n";
+      for( const auto& impl : fc::digest_batch_implementations() )
+      {
+         fc::set_digest_batch_implementation( impl );
+         std::cout << "  hash_many " << impl << ": sha256 "
+                   << measure( count, [&](){ fc::sha256::hash_many( inputs.data(), count, sha.data() ); } )
+                   << ", ripemd160 "
+                   << measure( count, [&](){ fc::ripemd160::hash_many( inputs.data(), count, ripemd.data() ); } )
+                   << "\n";
+      }
+      fc::set_digest_batch_implementation( "" );
+      sink += sha[0]._hash[0] + ripemd[0]._hash[0];
+   }
+
+   std::cout << "merkle root of " << count << " leaves, ns per leaf\n";
+   std::cout << "  sha256::hash per node: " << measure( count, [&](){ sink += merkle_root_by_loop( leaves )._hash[0]; } ) << "\n";
+   for( const auto& impl : fc::digest_batch_implementations() )
+   {
+      fc::set_digest_batch_implementation( impl );
+      std::cout << "  merkle_root " << impl << ": "
+                << measure( count, [&](){ sink += fc::sha256::merkle_root( leaves )._hash[0]; } ) << "\n";
+   }
+   return sink == 0;
+}
@@ -0,0 +1,110 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/crypto/elliptic.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/thread/thread_pool.hpp>
+
+#include <memory>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(fc_crypto)
+
+BOOST_AUTO_TEST_CASE(recover_batch_test)
+{
+   const fc::ecc::recovery_cache_stats initial = fc::ecc::get_recovery_cache_stats();
+   fc::ecc::set_recovery_cache_size( 0 );
+   fc::ecc::set_recovery_cache_size( 1000 );
+
+   std::vector<fc::ecc::signature_and_digest> sigs;
+   std::vector<fc::ecc::public_key> expected;
+   for( int i = 0; i < 100; ++i )
+   {
+      const fc::ecc::private_key key = fc::ecc::private_key::regenerate( fc::sha256::hash( "key " + std::to_string( i % 7 ) ) );
+      const fc::sha256 digest = fc::sha256::hash( "message " + std::to_string( i ) );
+      sigs.emplace_back( key.sign_compact( digest ), digest );
+      expected.push_back( key.get_public_key() );
+   }
+
+   BOOST_CHECK( fc::ecc::recover_batch( {} ).empty() );
+
+   std::vector<fc::ecc::public_key> keys = fc::ecc::recover_batch( sigs );
+   BOOST_REQUIRE_EQUAL( expected.size(), keys.size() );
+   for( size_t i = 0; i < keys.size(); ++i )
+      BOOST_CHECK( expected[i] == keys[i] );
+   fc::ecc::recovery_cache_stats stats = fc::ecc::get_recovery_cache_stats();
+   BOOST_CHECK_EQUAL( 100u, stats.size );
+
+   // the second time they all come from the cache
+   const uint64_t hits = stats.hits;
+   keys = fc::ecc::recover_batch( sigs );
+   for( size_t i = 0; i < keys.size(); ++i )
+      BOOST_CHECK( expected[i] == keys[i] );
+   BOOST_CHECK_EQUAL( hits + 100, fc::ecc::get_recovery_cache_stats().hits );
+
+   // and the same keys come back when the pool recovers them
+   fc::ecc::set_recovery_cache_size( 0 );
+   fc::ecc::set_recovery_cache_size( 1000 );
+   {
+      fc::thread_pool pool( 3 );
+      keys = fc::ecc::recover_batch( sigs, true, &pool );
+      BOOST_REQUIRE_EQUAL( expected.size(), keys.size() );
+      for( size_t i = 0; i < keys.size(); ++i )
+         BOOST_CHECK( expected[i] == keys[i] );
+
+      // a bad signature fails the batch, wherever it is
+      std::vector<fc::ecc::signature_and_digest> bad = sigs;
+      bad[77].first.begin()[0] = 0;
+      fc::ecc::set_recovery_cache_size( 0 );
+      BOOST_CHECK_THROW( fc::ecc::recover_batch( bad, true, &pool ), fc::exception );
+      BOOST_CHECK_THROW( fc::ecc::recover_batch( bad ), fc::exception );
+   }
+
+   // the cache keeps no more than it is told to
+   fc::ecc::set_recovery_cache_size( 10 );
+   stats = fc::ecc::get_recovery_cache_stats();
+   BOOST_CHECK_EQUAL( 0u, stats.size );
+   BOOST_CHECK_EQUAL( 10u, stats.capacity );
+   fc::ecc::recover_batch( sigs );
+   BOOST_CHECK_EQUAL( 10u, fc::ecc::get_recovery_cache_stats().size );
+
+   fc::ecc::set_recovery_cache_size( initial.capacity );
+}
+
+BOOST_AUTO_TEST_CASE(recover_batch_cancel_test)
+{
+   const fc::ecc::recovery_cache_stats initial = fc::ecc::get_recovery_cache_stats();
+   fc::ecc::set_recovery_cache_size( 0 );
+
+   const fc::ecc::private_key key = fc::ecc::private_key::regenerate( fc::sha256::hash( std::string( "cancel" ) ) );
+   std::vector<fc::ecc::signature_and_digest> sigs;
+   for( int i = 0; i < 2000; ++i )
+   {
+      const fc::sha256 digest = fc::sha256::hash( "message " + std::to_string( i % 50 ) );
+      sigs.emplace_back( key.sign_compact( digest ), digest );
+   }
+
+   {
+      fc::thread_pool pool( 2 );
+      // the caller is cancelled while the pool is still recovering, and its inputs go away
+      {
+         std::unique_ptr< std::vector<fc::ecc::signature_and_digest> > inputs( new std::vector<fc::ecc::signature_and_digest>( sigs ) );
+         fc::future< std::vector<fc::ecc::public_key> > batch = fc::async( [&inputs,&pool]{
+            return fc::ecc::recover_batch( *inputs, true, &pool );
+         }, "recover_batch caller" );
+         fc::usleep( fc::milliseconds(5) );
+         batch.cancel_and_wait( "cancelling recover_batch caller" );
+         inputs.reset();
+      }
+
+      // the pool is still good for the next batch
+      const std::vector<fc::ecc::public_key> keys = fc::ecc::recover_batch( sigs, true, &pool );
+      BOOST_REQUIRE_EQUAL( sigs.size(), keys.size() );
+      for( const fc::ecc::public_key& k : keys )
+         BOOST_CHECK( key.get_public_key() == k );
+   }
+
+   fc::ecc::set_recovery_cache_size( initial.capacity );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -175,4 +175,64 @@ BOOST_AUTO_TEST_CASE(sha512_test)
     test_stream<fc::sha512>();
 }
 
+BOOST_AUTO_TEST_CASE(hash_many_test)
+{
+    // every length up to a few blocks, so that lanes finish at different times
+    std::vector<std::string> messages;
+    for( size_t len = 0; len < 300; ++len )
+    {
+        std::string msg;
+        for( size_t i = 0; i < len; ++i )
+            msg += char( len * 7 + i * 13 );
+        messages.push_back( msg );
+    }
+    messages.push_back( std::string( TEST4 ) );
+    const std::vector<fc::digest_input> inputs( messages.begin(), messages.end() );
+
+    const std::vector<fc::string> implementations = fc::digest_batch_implementations();
+    BOOST_CHECK_EQUAL( "generic", implementations.back() );
+    BOOST_CHECK_THROW( fc::set_digest_batch_implementation( "unknown" ), fc::exception );
+    for( const auto& impl : implementations )
+    {
+        BOOST_TEST_MESSAGE( "hash_many with " + impl );
+        fc::set_digest_batch_implementation( impl );
+
+        const std::vector<fc::sha256> sha = fc::sha256::hash_many( inputs );
+        const std::vector<fc::ripemd160> ripemd = fc::ripemd160::hash_many( inputs );
+        BOOST_REQUIRE_EQUAL( messages.size(), sha.size() );
+        BOOST_REQUIRE_EQUAL( messages.size(), ripemd.size() );
+        for( size_t i = 0; i < messages.size(); ++i )
+        {
+            BOOST_CHECK( fc::sha256::hash( messages[i] ) == sha[i] );
+            BOOST_CHECK( fc::ripemd160::hash( messages[i] ) == ripemd[i] );
+        }
+        BOOST_CHECK_EQUAL( "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1", sha.back().str() );
+
+        // a batch of one, and of fewer messages than lanes
+        fc::sha256 one;
+        fc::sha256::hash_many( inputs.data() + 3, 1, &one );
+        BOOST_CHECK( fc::sha256::hash( messages[3] ) == one );
+        const std::vector<fc::ripemd160> few = fc::ripemd160::hash_many( std::vector<fc::digest_input>( inputs.begin(), inputs.begin() + 3 ) );
+        for( size_t i = 0; i < few.size(); ++i )
+            BOOST_CHECK( fc::ripemd160::hash( messages[i] ) == few[i] );
+
+        for( size_t count : { 0, 1, 2, 3, 7, 8, 9, 1000 } )
+        {
+            std::vector<fc::sha256> leaves;
+            for( size_t i = 0; i < count; ++i )
+                leaves.push_back( fc::sha256::hash( fc::to_string( uint64_t(i) ) ) );
+            std::vector<fc::sha256> level = leaves;
+            while( level.size() > 1 )
+            {
+                std::vector<fc::sha256> parents;
+                for( size_t i = 0; i < level.size(); i += 2 )
+                    parents.push_back( i + 1 < level.size() ? fc::sha256::hash( std::make_pair( level[i], level[i + 1] ) ) : level[i] );
+                level = parents;
+            }
+            BOOST_CHECK( ( level.empty() ? fc::sha256() : level.front() ) == fc::sha256::merkle_root( leaves ) );
+        }
+    }
+    fc::set_digest_batch_implementation( "" );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
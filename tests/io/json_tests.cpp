@@ -8,10 +8,91 @@
 #include <fc/io/fstream.hpp>
 #include <fc/io/iostream.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/json_pack.hpp>
 #include <fc/io/sstream.hpp>
+#include <fc/time.hpp>
 
 #include <fstream>
 
+namespace fc { namespace test {
+   enum class pack_color { red, green };
+
+   struct pack_inner
+   {
+      int16_t                 small = 0;
+      fc::optional<uint64_t>  big;
+   };
+
+   struct pack_outer
+   {
+      int8_t                                      i8 = 0;
+      int32_t                                     i32 = 0;
+      int64_t                                     i64 = 0;
+      uint8_t                                     u8 = 0;
+      uint64_t                                    u64 = 0;
+      double                                      d = 0;
+      bool                                        flag = false;
+      std::string                                 text;
+      pack_color                                  color = pack_color::red;
+      fc::optional<std::string>                   unset;
+      fc::optional<pack_inner>                    set;
+      std::vector<pack_inner>                     inners;
+      std::vector<char>                           bytes;
+      std::map<std::string, int32_t>              counts;
+      fc::flat_set<uint16_t>                      ids;
+      std::pair<std::string, bool>                entry;
+      fc::static_variant<int64_t, pack_inner>     either;
+      fc::safe<int64_t>                           amount;
+      fc::time_point_sec                          when;
+      fc::variant                                 extra;
+   };
+
+   /** reflected, but converted to a variant as a single string */
+   struct pack_named
+   {
+      std::string first;
+      std::string last;
+   };
+
+   /** converted through explicit specializations of the reflection templates */
+   struct pack_special
+   {
+      int32_t value = 0;
+   };
+} } // fc::test
+
+FC_REFLECT_ENUM( fc::test::pack_color, (red)(green) );
+FC_REFLECT( fc::test::pack_inner, (small)(big) );
+FC_REFLECT( fc::test::pack_outer, (i8)(i32)(i64)(u8)(u64)(d)(flag)(text)(color)(unset)(set)(inners)(bytes)(counts)
+                                  (ids)(entry)(either)(amount)(when)(extra) );
+FC_REFLECT( fc::test::pack_named, (first)(last) );
+FC_REFLECT( fc::test::pack_special, (value) );
+
+namespace fc {
+   void to_variant( const fc::test::pack_named& n, variant& v, uint32_t max_depth )
+   {
+      v = n.first + " " + n.last;
+   }
+   void from_variant( const variant& v, fc::test::pack_named& n, uint32_t max_depth )
+   {
+      const std::string s = v.as_string();
+      const size_t space = s.find( ' ' );
+      n.first = s.substr( 0, space );
+      n.last = space == std::string::npos ? std::string() : s.substr( space + 1 );
+   }
+
+   template<>
+   void to_variant( const fc::test::pack_special& s, variant& v, uint32_t max_depth )
+   {
+      v = s.value * 2;
+   }
+   template<>
+   void from_variant( const variant& v, fc::test::pack_special& s, uint32_t max_depth )
+   {
+      s.value = v.as_int64() / 2;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE(json_tests)
 
 static void replace_some( std::string& str )
@@ -121,6 +202,7 @@ BOOST_AUTO_TEST_CASE(imbalanced_test)
       test_fail_string( test );
       test_fail_stream( test );
       test_fail_file( test );
+      BOOST_CHECK_THROW( fc::json::from_string( test, fc::json::simd_parser ), fc::exception );
    }
 }
 
@@ -200,6 +282,12 @@ static void test_recursive( const fc::variant& v )
    BOOST_CHECK( equal( v, fc::json::from_string( pretty + " " ) ) );
    BOOST_CHECK( equal( v, fc::json::from_file( file.path() ) ) );
 
+   BOOST_CHECK( fc::json::is_valid( json, fc::json::simd_parser ) );
+   BOOST_CHECK( fc::json::is_valid( pretty + " ", fc::json::simd_parser ) );
+   BOOST_CHECK( equal( v, fc::json::from_string( json, fc::json::simd_parser ) ) );
+   BOOST_CHECK( equal( v, fc::json::from_string( pretty, fc::json::simd_parser ) ) );
+   BOOST_CHECK( equal( v, fc::json::from_file( file.path(), fc::json::simd_parser ) ) );
+
    if( v.get_type() == fc::variant::type_id::array_type )
       for( const auto& item : v.get_array() )
           test_recursive( item );
@@ -309,6 +397,234 @@ BOOST_AUTO_TEST_CASE(structured_test)
    test_recursive( v_big_array );
 }
 
+static void check_simd_matches_legacy( const std::string& json )
+{ try {
+   fc::variant legacy = fc::json::from_string( json );
+   fc::variant simd = fc::json::from_string( json, fc::json::simd_parser );
+   BOOST_CHECK( equal( legacy, simd ) );
+   BOOST_CHECK_EQUAL( fc::json::to_string( legacy ), fc::json::to_string( simd ) );
+} FC_CAPTURE_LOG_AND_RETHROW( (json) ) }
+
+BOOST_AUTO_TEST_CASE(simd_parser_test)
+{
+   // literals, numbers and escapes decode like in the other parsers
+   check_simd_matches_legacy( "[null,true,false,0,1,-1,18446744073709551615,-9223372036854775808,0.5,-2.25]" );
+   check_simd_matches_legacy( "{\"a\":{\"b\":[[],{}]},\"\":\"\",\"c\" : [ 1 , 2 ]\n}" );
+   check_simd_matches_legacy( "\"tab\\there\\nline \\\\ \\\" \\/ \\u0041\"" );
+   BOOST_CHECK_EQUAL( "{\"k\":1,\"k\":2}", fc::json::to_string( fc::json::from_string( "{\"k\":1,\"k\":2}", fc::json::simd_parser ) ) );
+
+   BOOST_CHECK( fc::json::from_string( "-0", fc::json::simd_parser ).is_uint64() );
+   BOOST_CHECK( fc::json::from_string( "-5", fc::json::simd_parser ).is_int64() );
+   BOOST_CHECK( fc::json::from_string( "5", fc::json::simd_parser ).is_uint64() );
+   BOOST_CHECK_EQUAL( 1500.0, fc::json::from_string( "1.5e3", fc::json::simd_parser ).as_double() );
+   BOOST_CHECK_EQUAL( -0.25, fc::json::from_string( "-25E-2", fc::json::simd_parser ).as_double() );
+   BOOST_CHECK_EQUAL( "a\nb", fc::json::from_string( "\"a\\\nb\"", fc::json::simd_parser ).as_string() );
+
+   // only the first value is parsed, is_valid() also checks what follows it
+   BOOST_CHECK_EQUAL( 1u, fc::json::from_string( "1 x", fc::json::simd_parser ).as_uint64() );
+   BOOST_CHECK( fc::json::is_valid( " [1] \r\n", fc::json::simd_parser ) );
+   BOOST_CHECK( !fc::json::is_valid( "[1] 2", fc::json::simd_parser ) );
+   BOOST_CHECK( !fc::json::is_valid( "[1] \"", fc::json::simd_parser ) );
+
+   const std::vector<std::string> bad
+   {
+      " ", "01", "-", "1.", ".5", "+1", "1e", "1e+", "18446744073709551616", "-9223372036854775809",
+      "nul", "nulls", "True", "[1,]", "[,1]", "[1 2]", "{\"a\" 1}", "{\"a\":1,}", "{a:1}", "{1:1}",
+      "\"abc", "\"a\nb\"", "\"a\rb\"", "\"a\x04\"", "[\"a\"b]", "1x", "'a'"
+   };
+   for( const std::string& json : bad )
+      BOOST_CHECK_THROW( fc::json::from_string( json, fc::json::simd_parser ), fc::exception );
+
+   const std::string ten_levels = "[[[[[[[[[[]]]]]]]]]]";
+   BOOST_CHECK_NO_THROW( fc::json::from_string( ten_levels, fc::json::simd_parser, 10 ) );
+   BOOST_CHECK_THROW( fc::json::from_string( ten_levels, fc::json::simd_parser, 9 ), fc::parse_error_exception );
+
+   // strings, escapes and runs of backslashes straddling the 64 byte blocks of the structural index
+   for( size_t offset = 50; offset < 80; ++offset )
+      for( size_t slashes = 1; slashes <= 4; ++slashes )
+      {
+         std::string json = "[\"" + std::string( offset, 'x' ) + std::string( slashes, '\\' )
+                            + ( slashes % 2 ? "\"" : "" ) + "\",{\"k\":[" + std::to_string( offset ) + ",\"]\"]}]";
+         check_simd_matches_legacy( json );
+      }
+
+   fc::variants big;
+   for( uint32_t i = 0; i < 2000; ++i )
+   {
+      fc::mutable_variant_object item;
+      item( "id", i )( "name", std::string( i % 97, 'a' + i % 26 ) + "\"\\{}[]:," )
+          ( "neg", -int64_t(i + 1) * 1000003 )( "flags", fc::variants{ i % 2 == 0, fc::variant() } );
+      big.push_back( item );
+   }
+   check_simd_matches_legacy( fc::json::to_string( big ) );
+   check_simd_matches_legacy( fc::json::to_pretty_string( big ) );
+
+   fc::temp_file file( fc::temp_directory_path(), true );
+   fc::json::save_to_file( big, file.path(), true );
+   BOOST_CHECK( equal( fc::json::from_file( file.path() ), fc::json::from_file( file.path(), fc::json::simd_parser ) ) );
+   {
+      fc::istream_ptr in( new fc::ifstream( file.path() ) );
+      fc::buffered_istream bin( in );
+      BOOST_CHECK( equal( big, fc::json::from_stream( bin, fc::json::simd_parser ) ) );
+   }
+
+#ifdef WITH_EXOTIC_JSON_PARSERS
+   for( const std::string& json : { "[1,-2,3e2,\"a\\tb\"]", "{\"x\":{\"y\":[true,false,null]}}", "-0" } )
+      BOOST_CHECK_EQUAL( fc::json::to_string( fc::json::from_string( json, fc::json::strict_parser ) ),
+                         fc::json::to_string( fc::json::from_string( json, fc::json::simd_parser ) ) );
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(writer_test)
+{
+   fc::json::writer w;
+   w.write( fc::variants{ int64_t(INT32_MAX), int64_t(INT32_MAX) + 1, int64_t(INT32_MIN), int64_t(INT32_MIN) - 1,
+                          INT64_MIN, uint64_t(0), uint64_t(0xffffffff), uint64_t(0x100000000ULL), UINT64_MAX,
+                          0.5, -2.0, true, false, fc::variant() } );
+   BOOST_CHECK_EQUAL( "[2147483647,\"2147483648\",-2147483648,\"-2147483649\",\"-9223372036854775808\",0,4294967295,"
+                      "\"4294967296\",\"18446744073709551615\",\"0.50000000000000000\",\"-2.00000000000000000\",true,false,null]",
+                      w.str() );
+   BOOST_CHECK_EQUAL( fc::variant( 1.0 / 3 ).as_string(), fc::json::from_string( fc::json::to_string( 1.0 / 3 ) ).as_string() );
+
+   // every character, at every position relative to the 16 byte blocks of the escape scan
+   std::string all;
+   std::string expected;
+   for( int c = 0; c < 256; ++c )
+   {
+      all += char(c);
+      switch( c )
+      {
+         case '\b': expected += "\\b"; break;
+         case '\f': expected += "\\f"; break;
+         case '\n': expected += "\\n"; break;
+         case '\r': expected += "\\r"; break;
+         case '\t': expected += "\\t"; break;
+         case '\\': expected += "\\\\"; break;
+         case '"': expected += "\\\""; break;
+         default:
+            if( c < 0x20 )
+            {
+               char u[7];
+               snprintf( u, sizeof(u), "\\u%04x", c );
+               expected += u;
+            }
+            else
+               expected += char(c);
+      }
+   }
+   for( size_t prefix = 0; prefix < 20; ++prefix )
+   {
+      w.clear();
+      const std::string padding( prefix, 'p' );
+      w.write_string( padding + all + padding );
+      BOOST_CHECK_EQUAL( "\"" + padding + expected + padding + "\"", w.str() );
+   }
+
+   fc::mutable_variant_object obj;
+   obj( "a\"b", fc::variants{ "x", fc::variant_object() } )( "n", -7 );
+   w.clear();
+   w.write( fc::variant_object( obj ) );
+   BOOST_CHECK_EQUAL( "{\"a\\\"b\":[\"x\",{}],\"n\":-7}", w.str() );
+   BOOST_CHECK_EQUAL( w.str(), fc::json::to_string( obj ) );
+   const std::string released = w.release();
+   BOOST_CHECK_EQUAL( 0u, w.size() );
+   BOOST_CHECK_EQUAL( fc::json::to_string( obj ), released );
+
+   fc::json::writer shallow( fc::json::stringify_large_ints_and_doubles, 2 );
+   BOOST_CHECK_NO_THROW( shallow.write( fc::json::from_string( "[[]]" ) ) );
+   BOOST_CHECK_THROW( shallow.write( fc::json::from_string( "[[1]]" ) ), fc::assert_exception );
+
+#ifdef WITH_EXOTIC_JSON_PARSERS
+   fc::json::writer legacy( fc::json::legacy_generator );
+   legacy.write( fc::variants{ int64_t(INT32_MAX) + 1, UINT64_MAX, 0.5 } );
+   BOOST_CHECK_EQUAL( "[2147483648,18446744073709551615,0.50000000000000000]", legacy.str() );
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(pack_test)
+{
+   fc::test::pack_outer out;
+   out.i8 = -8;
+   out.i32 = INT32_MIN;
+   out.i64 = INT64_MIN;
+   out.u8 = 200;
+   out.u64 = UINT64_MAX;
+   out.d = 0.25;
+   out.flag = true;
+   out.text = "tab\there \"quoted\"";
+   out.color = fc::test::pack_color::green;
+   out.set = fc::test::pack_inner();
+   out.set->small = -3;
+   out.inners.resize( 2 );
+   out.inners[1].big = 0x100000000ULL;
+   out.bytes = { 'a', '\0', char(0xff) };
+   out.counts = { { "x", 1 }, { "y", -2 } };
+   out.ids = { 3, 1 };
+   out.entry = std::make_pair( std::string( "k" ), true );
+   out.either = out.inners[1];
+   out.amount = fc::safe<int64_t>( 42 );
+   out.when = fc::time_point_sec( 1500000000 );
+   out.extra = fc::variants{ 1, "two" };
+
+   fc::json::writer w;
+   fc::json::pack( w, out );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( out, 10 ) ), w.str() );
+
+   fc::test::pack_outer in;
+   fc::json::unpack( w.str(), in );
+   BOOST_CHECK_EQUAL( w.str(), fc::json::to_string( fc::variant( in, 10 ) ) );
+   BOOST_CHECK( !in.unset.valid() );
+   BOOST_CHECK( in.set.valid() );
+   BOOST_CHECK_EQUAL( 1, in.either.which() );
+
+   // reordered and unknown keys, missing members keep their value, numbers may be quoted
+   fc::test::pack_inner inner;
+   inner.small = 5;
+   fc::json::unpack( "{\"unknown\":[{\"a\":1}],\"big\":\"18446744073709551615\"}", inner );
+   BOOST_CHECK_EQUAL( 5, inner.small );
+   BOOST_REQUIRE( inner.big.valid() );
+   BOOST_CHECK_EQUAL( UINT64_MAX, *inner.big );
+   fc::json::unpack( "{ \"big\" : null , \"small\" : \"-7\" }", inner );
+   BOOST_CHECK_EQUAL( -7, inner.small );
+   BOOST_CHECK( !inner.big.valid() );
+
+   fc::test::pack_color color;
+   fc::json::unpack( "0", color );
+   BOOST_CHECK( fc::test::pack_color::red == color );
+   fc::json::unpack( "\"green\"", color );
+   BOOST_CHECK( fc::test::pack_color::green == color );
+
+   std::vector<fc::test::pack_inner> many;
+   const std::string array = "[{},{\"small\":1}] ";
+   fc::json::reader r( array.data(), array.size() );
+   fc::json::unpack( r, many );
+   BOOST_CHECK( r.at_end() );
+   BOOST_REQUIRE_EQUAL( 2u, many.size() );
+   BOOST_CHECK_EQUAL( 1, many[1].small );
+
+   BOOST_CHECK_THROW( fc::json::unpack( "{\"small\":1", inner ), fc::exception );
+   BOOST_CHECK_THROW( fc::json::unpack( "[1]", inner ), fc::exception );
+   BOOST_CHECK_THROW( fc::json::pack( w, out, 2 ), fc::assert_exception );
+
+   // a reflected type with conversions of its own is packed through them
+   std::vector<fc::test::pack_named> names( 1 );
+   names[0].first = "Ada";
+   names[0].last = "Lovelace";
+   fc::json::writer named;
+   fc::json::pack( named, names );
+   BOOST_CHECK_EQUAL( "[\"Ada Lovelace\"]", named.str() );
+   std::vector<fc::test::pack_named> names_back;
+   fc::json::unpack( named.str(), names_back );
+   BOOST_REQUIRE_EQUAL( 1u, names_back.size() );
+   BOOST_CHECK_EQUAL( "Lovelace", names_back[0].last );
+
+   // explicit specializations of the reflection templates still take their place
+   fc::test::pack_special special;
+   special.value = 21;
+   BOOST_CHECK_EQUAL( 42, fc::variant( special, 1 ).as_int64() );
+   BOOST_CHECK_EQUAL( 21, fc::variant( 42 ).as<fc::test::pack_special>( 1 ).value );
+}
+
 BOOST_AUTO_TEST_CASE(precision_test)
 {
    BOOST_CHECK_EQUAL( "\"4294967296\"", fc::json::to_string( fc::variant( int64_t(0x100000000LL) ) ) );
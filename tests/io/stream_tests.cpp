@@ -75,6 +75,32 @@ BOOST_AUTO_TEST_CASE(buffered_stringstream_test)
    BOOST_CHECK_EQUAL( "Hello world", out1->str() );
 }
 
+BOOST_AUTO_TEST_CASE(buffered_chain_test)
+{
+   std::shared_ptr<fc::stringstream> out( new fc::stringstream() );
+   fc::buffered_ostream bout( out );
+   const std::shared_ptr<const char> hello( "Hello world", []( const char* ){} );
+   const std::string big( 5000, 'b' );
+   const std::shared_ptr<const char> big_data( big.data(), []( const char* ){} );
+
+   // a small chain is buffered, starting at the offset
+   const fc::const_buffer_chain small{ { hello, 5 }, { hello, 6, 5 } };
+   BOOST_CHECK_EQUAL( 8u, bout.writesome( small, 3 ) );
+   BOOST_CHECK_EQUAL( "", out->str() );
+
+   // a large one is written after what is buffered
+   const fc::const_buffer_chain large{ { big_data, big.size() }, { hello, 5 } };
+   bout.write( large );
+   BOOST_CHECK_EQUAL( "lo world" + big, out->str() );
+   bout.flush();
+   BOOST_CHECK_EQUAL( "lo world" + big + "Hello", out->str() );
+
+   // other streams write one slice at a time
+   fc::stringstream plain;
+   plain.write( small );
+   BOOST_CHECK_EQUAL( "Hello world", plain.str() );
+}
+
 BOOST_AUTO_TEST_CASE(fstream_test)
 {
    fc::temp_file inf1( fc::temp_directory_path(), true );
@@ -0,0 +1,80 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/log/file_appender.hpp>
+#include <fc/log/log_message.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/variant_object.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+   size_t count_lines( const fc::path& file )
+   {
+      std::string contents;
+      fc::read_file_contents( file, contents );
+      return std::count( contents.begin(), contents.end(), '\n' );
+   }
+
+   void log_lines( fc::file_appender& appender, uint32_t count )
+   {
+      for( uint32_t i = 0; i < count; ++i )
+         appender.log( FC_LOG_MESSAGE( info, "line ${i}", ("i",i) ) );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(log_tests)
+
+BOOST_AUTO_TEST_CASE(async_file_appender_test)
+{
+   fc::temp_directory dir;
+
+   // every line of every thread is written, in order per thread
+   {
+      fc::file_appender::config cfg( dir.path() / "block.log" );
+      cfg.async = true;
+      cfg.async_queue_size = 64;
+      cfg.async_flush_interval = fc::milliseconds( 10 );
+      fc::shared_ptr<fc::file_appender> appender( new fc::file_appender( fc::variant( cfg, 10 ) ) );
+
+      std::vector<std::thread> threads;
+      for( int t = 0; t < 4; ++t )
+         threads.emplace_back( [&appender](){ log_lines( *appender, 1000 ); } );
+      log_lines( *appender, 1000 );
+      for( auto& t : threads )
+         t.join();
+      fc::usleep( fc::milliseconds( 100 ) );
+
+      const auto stats = appender->get_async_stats();
+      BOOST_CHECK_EQUAL( 5000u, stats.written );
+      BOOST_CHECK_EQUAL( 0u, stats.dropped );
+      BOOST_CHECK_LT( stats.writes, 5000u );
+      BOOST_CHECK_EQUAL( 5000u, count_lines( dir.path() / "block.log" ) );
+
+      std::string contents;
+      fc::read_file_contents( dir.path() / "block.log", contents );
+      BOOST_CHECK( contents.find( "line 998" ) < contents.find( "line 999" ) );
+   }
+
+   // lines which find the queue full are dropped and counted
+   {
+      fc::file_appender::config cfg( dir.path() / "drop.log" );
+      cfg.async = true;
+      cfg.async_queue_size = 16;
+      cfg.async_flush_interval = fc::seconds( 10 );
+      cfg.async_overflow = fc::file_appender::overflow::drop;
+      {
+         fc::shared_ptr<fc::file_appender> appender( new fc::file_appender( fc::variant( cfg, 10 ) ) );
+         log_lines( *appender, 1000 );
+         BOOST_CHECK_GT( appender->get_async_stats().dropped, 0u );
+      }
+      // the rest is written when the appender is destroyed
+      BOOST_CHECK_GE( count_lines( dir.path() / "drop.log" ), 16u );
+      BOOST_CHECK_LT( count_lines( dir.path() / "drop.log" ), 1000u );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
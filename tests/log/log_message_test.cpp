@@ -0,0 +1,65 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+#include <fc/log/log_message.hpp>
+#include <fc/variant_object.hpp>
+
+BOOST_AUTO_TEST_SUITE(log_tests)
+
+BOOST_AUTO_TEST_CASE(log_message_test)
+{
+   const std::string text( "a string longer than the inline storage of a string" );
+   const char* chars = "chars";
+   const fc::log_message m = FC_LOG_MESSAGE( info, "${i} ${u} ${d} ${b} ${s} ${c} ${o} ${missing} $ ${n}${x} $",
+                                             ("i",int32_t(-5))("u",uint64_t(-1))("d",1.5)("b",true)("s",text)
+                                             ("c",chars)("o",fc::mutable_variant_object("k",1))("n",(const char*)nullptr) );
+   const std::string expected = "-5 18446744073709551615 1.50000000000000000 true " + text + " chars {\"k\":1} ${missing} $ ${x} $";
+   BOOST_CHECK_EQUAL( expected, m.get_message() );
+   BOOST_CHECK_EQUAL( expected, fc::format_string( m.get_format(), m.get_data() ) );
+
+   // the arguments become the variants they always were
+   const fc::variant_object data = m.get_data();
+   BOOST_CHECK_EQUAL( 8u, data.size() );
+   BOOST_CHECK( data["i"].is_int64() );
+   BOOST_CHECK( data["u"].is_uint64() );
+   BOOST_CHECK( data["d"].is_double() );
+   BOOST_CHECK( data["b"].is_bool() );
+   BOOST_CHECK_EQUAL( text, data["s"].as_string() );
+   BOOST_CHECK_EQUAL( "chars", data["c"].as_string() );
+   BOOST_CHECK_EQUAL( 1, data["o"]["k"].as_int64() );
+   BOOST_CHECK( data["n"].is_null() );
+
+   BOOST_CHECK_EQUAL( "log_message_test.cpp", m.get_context().get_file() );
+   BOOST_CHECK_EQUAL( "test_method", m.get_context().get_method() );
+
+   // serialized and restored
+   const fc::log_message restored( fc::json::from_string( fc::json::to_string( fc::variant( m, 10 ) ) ), 10 );
+   BOOST_CHECK_EQUAL( expected, restored.get_message() );
+   BOOST_CHECK_EQUAL( m.get_format(), restored.get_format() );
+   BOOST_CHECK_EQUAL( "log_message_test.cpp", restored.get_context().get_file() );
+
+   // more arguments and strings than fit with the message, the first of duplicates wins
+   fc::log_message many( FC_LOG_CONTEXT( debug ), "${k0} ${k9} ${k19}" );
+   for( int i = 0; i < 20; ++i )
+      many( "k" + std::to_string( i ), text + std::to_string( i ) );
+   many( "k0", "duplicate" );
+   BOOST_CHECK_EQUAL( text + "0 " + text + "9 " + text + "19", many.get_message() );
+   BOOST_CHECK_EQUAL( 21u, many.get_data().size() );
+
+   // messages built from a format string and an object as before
+   const fc::log_message old_style( FC_LOG_CONTEXT( warn ), std::string( "${a}" ), fc::mutable_variant_object( "a", 2 ) );
+   BOOST_CHECK_EQUAL( "2", old_style.get_message() );
+
+   try
+   {
+      FC_ASSERT( false, "asserted ${x}", ("x",42) );
+   }
+   catch( const fc::exception& e )
+   {
+      BOOST_CHECK( e.to_string().find( "asserted 42" ) != std::string::npos );
+      BOOST_CHECK( e.to_detail_string().find( "\"x\":42" ) != std::string::npos );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
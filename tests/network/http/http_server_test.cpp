@@ -0,0 +1,144 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/network/http/connection.hpp>
+#include <fc/network/http/server.hpp>
+#include <fc/network/ip.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/thread/thread.hpp>
+
+BOOST_AUTO_TEST_SUITE(fc_network)
+
+namespace {
+   std::string read_responses( fc::tcp_socket& sock, size_t count )
+   {
+      std::string received;
+      char buffer[1024];
+      size_t found = 0;
+      while( found < count )
+      {
+         received.append( buffer, sock.readsome( buffer, sizeof(buffer) ) );
+         found = 0;
+         for( size_t pos = received.find( "HTTP/1.1" ); pos != std::string::npos; pos = received.find( "HTTP/1.1", pos + 1 ) )
+            ++found;
+      }
+      return received;
+   }
+}
+
+BOOST_AUTO_TEST_CASE(http_keep_alive_test)
+{
+   fc::http::server server;
+   server.set_idle_timeout( fc::milliseconds(200) );
+   server.listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+   server.on_request( []( const fc::http::request& req, const fc::http::server::response& resp ){
+      const std::string body = req.path + ":" + std::string( req.body.begin(), req.body.end() );
+      resp.set_status( fc::http::reply::OK );
+      resp.set_length( body.size() );
+      resp.write( body.data(), body.size() );
+   });
+   const fc::ip::endpoint ep( fc::ip::address( "127.0.0.1" ), server.get_local_endpoint().port() );
+   const std::string url = "http://127.0.0.1:" + fc::to_string( uint64_t( ep.port() ) );
+
+   // several requests over one connection
+   fc::http::connection client;
+   client.connect_to( ep );
+   for( int i = 0; i < 3; ++i )
+   {
+      fc::http::reply rep = client.request( "POST", url + "/call", "body" + fc::to_string( int64_t(i) ) );
+      BOOST_CHECK_EQUAL( 200, rep.status );
+      BOOST_CHECK_EQUAL( "/call:body" + fc::to_string( int64_t(i) ), std::string( rep.body.begin(), rep.body.end() ) );
+      BOOST_CHECK( client.get_socket().is_open() );
+   }
+
+   // pipelined requests are answered in order, the last one asks to close
+   fc::tcp_socket sock;
+   sock.connect_to( ep );
+   const std::string pipelined = "GET /a HTTP/1.1\r\nHost: x\r\n\r\n"
+                                 "POST /b HTTP/1.1\r\nHost: x\r\nContent-Length: 3\r\n\r\nxyz"
+                                 "GET /c HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n";
+   sock.write( pipelined.data(), pipelined.size() );
+   const std::string received = read_responses( sock, 3 );
+   const size_t a = received.find( "/a:" );
+   const size_t b = received.find( "/b:xyz" );
+   const size_t c = received.find( "/c:" );
+   BOOST_CHECK( a != std::string::npos && a < b && b < c && c != std::string::npos );
+   BOOST_CHECK( received.find( "Connection: keep-alive" ) < a );
+   BOOST_CHECK( received.find( "Connection: close" ) < c );
+   char byte;
+   BOOST_CHECK_THROW( sock.readsome( &byte, 1 ), fc::exception );
+
+   // idle connections are closed
+   fc::tcp_socket idle;
+   idle.connect_to( ep );
+   fc::usleep( fc::milliseconds(500) );
+   BOOST_CHECK_THROW( idle.readsome( &byte, 1 ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE(http_max_connections_test)
+{
+   std::unique_ptr<fc::http::server> server( new fc::http::server() );
+   server->set_max_connections( 2 );
+   server->listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+   server->on_request( []( const fc::http::request& req, const fc::http::server::response& resp ){
+      resp.set_status( fc::http::reply::OK );
+      resp.set_length( req.path.size() );
+      resp.write( req.path.data(), req.path.size() );
+   });
+   const fc::ip::endpoint ep( fc::ip::address( "127.0.0.1" ), server->get_local_endpoint().port() );
+   const auto get = []( fc::tcp_socket& sock, const std::string& path ) {
+      const std::string request = "GET " + path + " HTTP/1.1\r\nHost: x\r\n\r\n";
+      sock.write( request.data(), request.size() );
+   };
+
+   fc::tcp_socket first, second, third;
+   first.connect_to( ep );
+   second.connect_to( ep );
+   get( first, "/1" );
+   get( second, "/2" );
+   BOOST_CHECK( read_responses( first, 1 ).find( "/1" ) != std::string::npos );
+   BOOST_CHECK( read_responses( second, 1 ).find( "/2" ) != std::string::npos );
+
+   // a third connection waits in the backlog until one of the others closes
+   third.connect_to( ep );
+   get( third, "/3" );
+   fc::future<std::string> answer = fc::async( [&third]{ return read_responses( third, 1 ); } );
+   fc::usleep( fc::milliseconds(200) );
+   BOOST_CHECK( !answer.ready() );
+   first.close();
+   BOOST_CHECK( answer.wait( fc::seconds(5) ).find( "/3" ) != std::string::npos );
+
+   // the server goes away while it is at its limit, closing the connections it has
+   fc::future<void> destroyed = fc::async( [&server]{ server.reset(); } );
+   BOOST_CHECK_NO_THROW( destroyed.wait( fc::seconds(5) ) );
+   char byte;
+   BOOST_CHECK_THROW( second.readsome( &byte, 1 ), fc::exception );
+   BOOST_CHECK_THROW( third.readsome( &byte, 1 ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE(http_destroy_while_idle_test)
+{
+   std::unique_ptr<fc::http::server> server( new fc::http::server() );
+   server->listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+   server->on_request( []( const fc::http::request& req, const fc::http::server::response& resp ){
+      resp.set_status( fc::http::reply::OK );
+      resp.set_length( req.path.size() );
+      resp.write( req.path.data(), req.path.size() );
+   });
+   const fc::ip::endpoint ep( fc::ip::address( "127.0.0.1" ), server->get_local_endpoint().port() );
+
+   // after its first request the connection is kept, waiting for the next one
+   fc::tcp_socket sock;
+   sock.connect_to( ep );
+   const std::string request = "GET /1 HTTP/1.1\r\nHost: x\r\n\r\n";
+   sock.write( request.data(), request.size() );
+   BOOST_CHECK( read_responses( sock, 1 ).find( "Connection: keep-alive" ) != std::string::npos );
+   fc::usleep( fc::milliseconds(50) );
+
+   // the server closes it long before the idle timeout, and does not wait for that timeout to go away
+   fc::future<void> destroyed = fc::async( [&server]{ server.reset(); } );
+   BOOST_CHECK_NO_THROW( destroyed.wait( fc::seconds(5) ) );
+   char byte;
+   BOOST_CHECK_THROW( sock.readsome( &byte, 1 ), fc::exception );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,7 @@
 
 #include <fc/network/http/websocket.hpp>
 
+#include <atomic>
 #include <iostream>
 
 BOOST_AUTO_TEST_SUITE(fc_network)
@@ -54,5 +55,46 @@ BOOST_AUTO_TEST_CASE(websocket_test)
     BOOST_CHECK_THROW(client.connect( "ws://localhost:" + fc::to_string(port) ), fc::exception);
 }
 
+BOOST_AUTO_TEST_CASE(websocket_thread_pool_test)
+{
+    fc::http::websocket_client client;
+    std::vector<fc::http::websocket_connection_ptr> c_conns;
+    std::vector<std::vector<std::string>> received( 4 );
+    std::atomic<uint32_t> closed( 0 );
+    {
+        fc::http::websocket_server server( 2 );
+        server.on_connection([&]( const fc::http::websocket_connection_ptr& c ){
+                c->on_message_handler([c](const std::string& s){
+                    c->send_message( s );
+                });
+                c->closed.connect( [&closed](){ ++closed; } );
+            });
+
+        server.listen( 0 );
+        const int port = server.get_listening_port();
+        server.start_accept();
+
+        for( size_t i = 0; i < received.size(); ++i )
+        {
+            c_conns.push_back( client.connect( "ws://localhost:" + fc::to_string(port) ) );
+            c_conns.back()->on_message_handler([&received,i](const std::string& s){
+                    received[i].push_back( s );
+                });
+        }
+        for( int n = 0; n < 50; ++n )
+            for( auto& c : c_conns )
+                c->send_message( fc::to_string( n ) );
+        fc::usleep( fc::milliseconds(500) );
+
+        // every connection gets its own messages back, in order
+        for( const auto& r : received )
+        {
+            BOOST_REQUIRE_EQUAL( 50u, r.size() );
+            for( int n = 0; n < 50; ++n )
+                BOOST_CHECK_EQUAL( fc::to_string( n ), r[n] );
+        }
+    }
+    BOOST_CHECK_EQUAL( received.size(), closed.load() );
+}
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,153 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/network/ip.hpp>
+#include <fc/network/rate_limiting.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/network/tcp_socket_io_hooks.hpp>
+#include <fc/asio.hpp>
+#include <fc/thread/thread.hpp>
+
+namespace {
+   std::shared_ptr<const char> shared_copy( const std::string& s )
+   {
+      std::shared_ptr<char> data( new char[s.size()], []( char* p ){ delete[] p; } );
+      std::copy( s.begin(), s.end(), data.get() );
+      return data;
+   }
+
+   /** hooks written before gather writes, which leave the chain to the default */
+   class counting_hooks : public fc::tcp_socket_io_hooks
+   {
+   public:
+      size_t writes = 0;
+
+      virtual size_t readsome( boost::asio::ip::tcp::socket& socket, char* buffer, size_t length ) override
+      {
+         return fc::asio::read_some( socket, buffer, length ).wait();
+      }
+      virtual size_t readsome( boost::asio::ip::tcp::socket& socket, const std::shared_ptr<char>& buffer, size_t length, size_t offset ) override
+      {
+         return fc::asio::read_some( socket, buffer, length, offset ).wait();
+      }
+      virtual size_t writesome( boost::asio::ip::tcp::socket& socket, const char* buffer, size_t length ) override
+      {
+         ++writes;
+         return fc::asio::write_some( socket, buffer, length ).wait();
+      }
+      virtual size_t writesome( boost::asio::ip::tcp::socket& socket, const std::shared_ptr<const char>& buffer, size_t length, size_t offset ) override
+      {
+         ++writes;
+         return fc::asio::write_some( socket, buffer, length, offset ).wait();
+      }
+      using fc::tcp_socket_io_hooks::writesome;
+   };
+}
+
+BOOST_AUTO_TEST_SUITE(fc_network)
+
+BOOST_AUTO_TEST_CASE(tcp_speculative_io_test)
+{
+   fc::tcp_server server;
+   server.listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+   const fc::ip::endpoint ep( fc::ip::address( "127.0.0.1" ), server.get_port() );
+
+   fc::tcp_socket client;
+   client.set_speculative_io();
+   auto accepted = fc::async( [&server](){
+      auto sock = std::make_shared<fc::tcp_socket>();
+      server.accept( *sock );
+      return sock;
+   });
+   client.connect_to( ep );
+   std::shared_ptr<fc::tcp_socket> peer = accepted.wait();
+   peer->set_speculative_io();
+
+   // more than the socket buffers hold, so that some writes have to wait
+   std::vector<char> sent( 8 * 1024 * 1024 );
+   for( size_t i = 0; i < sent.size(); ++i )
+      sent[i] = char( i * 7 );
+   auto writer = fc::async( [&](){ client.write( sent.data(), sent.size() ); } );
+   std::vector<char> received( sent.size() );
+   peer->read( received.data(), received.size() );
+   writer.wait();
+   BOOST_CHECK( sent == received );
+
+   fc::tcp_socket::io_stats stats = client.get_io_stats();
+   BOOST_CHECK_GT( stats.writes, stats.immediate_writes );
+   BOOST_CHECK_GT( stats.immediate_writes, 0u );
+
+   // data which is already there is read without waiting
+   client.write( "ping", 4 );
+   fc::usleep( fc::milliseconds( 20 ) );
+   const uint64_t immediate_before = peer->get_io_stats().immediate_reads;
+   char buffer[4];
+   peer->read( buffer, 4 );
+   BOOST_CHECK_EQUAL( "ping", std::string( buffer, 4 ) );
+   BOOST_CHECK_EQUAL( immediate_before + 1, peer->get_io_stats().immediate_reads );
+
+   // errors are reported as without it
+   client.close();
+   BOOST_CHECK_THROW( peer->readsome( buffer, 4 ), fc::eof_exception );
+
+   // nothing changes for a socket which does not ask for it
+   fc::tcp_socket plain;
+   plain.connect_to( ep );
+   plain.write( "x", 1 );
+   BOOST_CHECK_EQUAL( 1u, plain.get_io_stats().writes );
+   BOOST_CHECK_EQUAL( 0u, plain.get_io_stats().immediate_writes );
+}
+
+BOOST_AUTO_TEST_CASE(tcp_gather_write_test)
+{
+   fc::tcp_server server;
+   server.listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+   const fc::ip::endpoint ep( fc::ip::address( "127.0.0.1" ), server.get_port() );
+
+   const std::string payload( 300000, 'p' );
+   const auto header = shared_copy( "[header]" );
+   const auto body = shared_copy( "xx" + payload + "xx" );
+   const auto trailer = shared_copy( "[trailer]" );
+   const fc::const_buffer_chain chain{ { header, 8 }, { body, payload.size(), 2 }, { trailer, 9 } };
+   const std::string expected = "[header]" + payload + "[trailer]";
+   BOOST_CHECK_EQUAL( expected.size(), fc::total_size( chain ) );
+
+   // plain, without waiting first, through the hooks of a rate limiting group and through hooks
+   // which only know how to write one buffer
+   fc::rate_limiting_group limited( 1000000, 0 );
+   counting_hooks counting;
+   for( int mode = 0; mode < 4; ++mode )
+   {
+      fc::tcp_socket client;
+      auto accepted = fc::async( [&server](){
+         auto sock = std::make_shared<fc::tcp_socket>();
+         server.accept( *sock );
+         return sock;
+      });
+      client.connect_to( ep );
+      std::shared_ptr<fc::tcp_socket> peer = accepted.wait();
+      if( mode == 1 )
+         client.set_speculative_io();
+      else if( mode == 2 )
+         limited.add_tcp_socket( &client );
+      else if( mode == 3 )
+         client.set_io_hooks( &counting );
+
+      auto writer = fc::async( [&](){ client.write( chain ); client.write( chain ); } );
+      std::vector<char> received( 2 * expected.size() );
+      peer->read( received.data(), received.size() );
+      writer.wait();
+      BOOST_CHECK_EQUAL( expected + expected, std::string( received.begin(), received.end() ) );
+      if( mode == 2 )
+      {
+         BOOST_CHECK_GT( limited.get_actual_upload_rate(), 0u );
+         limited.remove_tcp_socket( &client );
+      }
+      if( mode == 3 )
+      {
+         BOOST_CHECK_GT( counting.writes, 0u );
+         client.set_io_hooks( nullptr );
+      }
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
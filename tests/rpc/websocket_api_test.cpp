@@ -0,0 +1,169 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/api.hpp>
+#include <fc/rpc/websocket_api.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <algorithm>
+
+namespace fc { namespace test {
+   class slow_api
+   {
+      public:
+         int64_t twice( int64_t value )
+         {
+            peak = std::max( peak, ++running );
+            // long enough to be a real sleep rather than a yield
+            fc::usleep( fc::milliseconds( 20 ) );
+            --running;
+            return 2 * value;
+         }
+         void fail() { FC_THROW( "failed on purpose" ); }
+
+         uint32_t running = 0;
+         uint32_t peak = 0;
+   };
+
+   class fake_connection : public fc::http::websocket_connection
+   {
+      public:
+         virtual void send_message( const std::string& message ) override { sent.push_back( message ); }
+         virtual std::string get_request_header( const std::string& key ) override { return std::string(); }
+
+         std::vector<std::string> sent;
+   };
+
+   class remote_api
+   {
+      public:
+         int64_t add( int64_t a, int64_t b ) { return a + b; }
+         fc::variant echo( const fc::variant& v ) { return v; }
+         void fail() { FC_THROW( "failed on purpose" ); }
+         void on_result( const std::function<void(int64_t)>& cb, int64_t value ) { cb( value ); }
+   };
+
+   /** delivers what it sends to its peer, as a websocket would */
+   class loopback_connection : public fc::http::websocket_connection
+   {
+      public:
+         explicit loopback_connection( const std::string& subprotocol ) : subprotocol( subprotocol ) {}
+
+         virtual void send_message( const std::string& message ) override { deliver( message ); }
+         virtual void send_binary_message( const std::string& message ) override
+         {
+            ++binary_frames;
+            deliver( message );
+         }
+         virtual std::string get_request_header( const std::string& key ) override { return std::string(); }
+         virtual std::string get_subprotocol()const override { return subprotocol; }
+
+         void deliver( const std::string& message )
+         {
+            auto p = peer.lock();
+            fc::async( [p,message](){ p->on_message( message ); } );
+         }
+
+         std::string                               subprotocol;
+         std::weak_ptr<fc::http::websocket_connection>  peer;
+         uint32_t                                  binary_frames = 0;
+   };
+
+   class test_api_connection : public fc::rpc::websocket_api_connection
+   {
+      public:
+         using websocket_api_connection::websocket_api_connection;
+         using websocket_api_connection::on_message;
+   };
+} } // fc::test
+
+FC_API( fc::test::slow_api, (twice)(fail) )
+FC_API( fc::test::remote_api, (add)(echo)(fail)(on_result) )
+
+BOOST_AUTO_TEST_SUITE(rpc_tests)
+
+BOOST_AUTO_TEST_CASE(websocket_api_batch_test)
+{
+   auto impl = std::make_shared<fc::test::slow_api>();
+   auto con = std::make_shared<fc::test::fake_connection>();
+   auto api_con = std::make_shared<fc::test::test_api_connection>( con, 10 );
+   api_con->register_api( fc::api<fc::test::slow_api>( impl ) );
+
+   // a single request is answered as before
+   api_con->on_message( R"({"id":1,"method":"call","params":[0,"twice",[21]]})" );
+   BOOST_REQUIRE_EQUAL( 1u, con->sent.size() );
+   BOOST_CHECK_EQUAL( 42, fc::json::from_string( con->sent[0] )["result"].as_int64() );
+
+   // the replies of a batch come in one frame in request order, without notices
+   std::string batch = "[";
+   for( int i = 0; i < 10; ++i )
+      batch += R"({"id":)" + fc::to_string( int64_t(10 + i) ) + R"(,"method":"call","params":[0,"twice",[)" + fc::to_string( int64_t(i) ) + "]]},";
+   batch += R"({"method":"call","params":[0,"twice",[0]]},{"id":30,"method":"call","params":[0,"fail",[]]},42])";
+   con->sent.clear();
+   api_con->on_message( batch );
+   BOOST_REQUIRE_EQUAL( 1u, con->sent.size() );
+   const fc::variant replies = fc::json::from_string( con->sent[0] );
+   BOOST_REQUIRE( replies.is_array() );
+   BOOST_REQUIRE_EQUAL( 12u, replies.size() );
+   for( int i = 0; i < 10; ++i )
+   {
+      BOOST_CHECK_EQUAL( 10 + i, replies[i]["id"].as_int64() );
+      BOOST_CHECK_EQUAL( 2 * i, replies[i]["result"].as_int64() );
+   }
+   BOOST_CHECK_EQUAL( 30, replies[10]["id"].as_int64() );
+   BOOST_CHECK_EQUAL( 1, replies[10]["error"]["code"].as_int64() );
+   BOOST_CHECK( replies[11]["id"].is_null() );
+   BOOST_CHECK_EQUAL( -32600, replies[11]["error"]["code"].as_int64() );
+
+   // the calls ran concurrently, but not more of them than allowed
+   BOOST_CHECK_GT( impl->peak, 1u );
+   BOOST_CHECK_LE( impl->peak, 16u );
+   impl->peak = 0;
+   api_con->set_max_batch_in_flight( 3 );
+   con->sent.clear();
+   api_con->on_message( batch );
+   BOOST_CHECK_EQUAL( 3u, impl->peak );
+   BOOST_REQUIRE_EQUAL( 1u, con->sent.size() );
+   BOOST_CHECK_EQUAL( 12u, fc::json::from_string( con->sent[0] ).size() );
+
+   // only notices, nothing to send
+   con->sent.clear();
+   api_con->on_message( R"([{"method":"call","params":[0,"twice",[1]]}])" );
+   BOOST_CHECK( con->sent.empty() );
+
+   // an empty batch is an invalid request
+   const fc::variant empty = fc::json::from_string( api_con->on_message( "[]" ) );
+   BOOST_REQUIRE_EQUAL( 1u, empty.size() );
+   BOOST_CHECK_EQUAL( -32600, empty[size_t(0)]["error"]["code"].as_int64() );
+}
+
+BOOST_AUTO_TEST_CASE(websocket_api_binary_test)
+{
+   for( const std::string& subprotocol : { std::string(), std::string( fc::rpc::websocket_binary_subprotocol ) } )
+   {
+      auto server_con = std::make_shared<fc::test::loopback_connection>( subprotocol );
+      auto client_con = std::make_shared<fc::test::loopback_connection>( subprotocol );
+      server_con->peer = client_con;
+      client_con->peer = server_con;
+      auto server = std::make_shared<fc::rpc::websocket_api_connection>( server_con, 10 );
+      auto client = std::make_shared<fc::rpc::websocket_api_connection>( client_con, 10 );
+      server->register_api( fc::api<fc::test::remote_api>( std::make_shared<fc::test::remote_api>() ) );
+
+      auto remote = client->get_remote_api<fc::test::remote_api>();
+      BOOST_CHECK_EQUAL( 5, remote->add( 2, 3 ) );
+      const fc::variant value = fc::mutable_variant_object( "name", "a name" )( "list", fc::variants{ 1, "two", 3.5 } )( "big", uint64_t(-1) );
+      BOOST_CHECK_EQUAL( fc::json::to_string( value ), fc::json::to_string( remote->echo( value ) ) );
+      BOOST_CHECK_THROW( remote->fail(), fc::exception );
+
+      int64_t result = 0;
+      remote->on_result( [&result]( int64_t r ){ result = r; }, 42 );
+      fc::usleep( fc::milliseconds( 20 ) );
+      BOOST_CHECK_EQUAL( 42, result );
+
+      // four calls and their replies plus the notice, all binary frames or all text
+      const bool binary = !subprotocol.empty();
+      BOOST_CHECK_EQUAL( binary ? 4u : 0u, client_con->binary_frames );
+      BOOST_CHECK_EQUAL( binary ? 5u : 0u, server_con->binary_frames );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+#include <fc/api.hpp>
+#include <fc/rpc/websocket_api.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <string>
+
+/**
+ *  Calls an api through websocket_api_connection with JSON and with the binary
+ *  subprotocol, and reports wall time and CPU time per call for a small call and for
+ *  one returning a list of objects.  Client and server run in this process, connected
+ *  in memory or, with "ws", through a websocket on localhost.
+ *
+ *  usage: rpc_bench [calls] [ws]
+ */
+
+namespace {
+   class bench_api
+   {
+      public:
+         int64_t add( int64_t a, int64_t b ) { return a + b; }
+
+         fc::variants get_objects( const std::vector<std::string>& ids )
+         {
+            fc::variants result;
+            result.reserve( ids.size() );
+            for( const auto& id : ids )
+               result.emplace_back( fc::mutable_variant_object( "id", id )
+                                       ( "owner", "1.2.1234" )
+                                       ( "asset_type", "1.3.0" )
+                                       ( "balance", uint64_t(123456789) )
+                                       ( "memo", "a memo text which is long enough not to fit" ) );
+            return result;
+         }
+   };
+}
+
+FC_API( bench_api, (add)(get_objects) )
+
+namespace {
+   /** delivers what it sends to its peer in another task, as a websocket would */
+   class memory_connection : public fc::http::websocket_connection
+   {
+      public:
+         explicit memory_connection( const std::string& subprotocol ) : subprotocol( subprotocol ) {}
+
+         virtual void send_message( const std::string& message ) override
+         {
+            *bytes += message.size();
+            auto p = peer.lock();
+            fc::async( [p,message](){ p->on_message( message ); } );
+         }
+         virtual void send_binary_message( const std::string& message ) override { send_message( message ); }
+         virtual std::string get_request_header( const std::string& key ) override { return std::string(); }
+         virtual std::string get_subprotocol()const override { return subprotocol; }
+
+         std::string                                     subprotocol;
+         std::weak_ptr<fc::http::websocket_connection>   peer;
+         uint64_t*                                       bytes = nullptr;
+   };
+
+   typedef std::chrono::steady_clock clock_type;
+
+   template<typename Call>
+   void measure( const char* what, size_t calls, Call&& call, const uint64_t* bytes )
+   {
+      const uint64_t bytes_before = bytes ? *bytes : 0;
+      const auto start = clock_type::now();
+      const std::clock_t cpu_start = std::clock();
+      for( size_t i = 0; i < calls; ++i )
+         call();
+      const double cpu = double( std::clock() - cpu_start ) / CLOCKS_PER_SEC;
+      const double wall = std::chrono::duration<double>( clock_type::now() - start ).count();
+      std::cout << "  " << what << ": " << calls / wall << " calls/s, "
+                << wall * 1e6 / calls << " us/call, " << cpu * 1e6 / calls << " us CPU/call";
+      if( bytes )
+         std::cout << ", " << ( *bytes - bytes_before ) / calls << " bytes/call";
+      std::cout << "\n";
+   }
+
+   void run( const fc::api<bench_api>& remote, size_t calls, const uint64_t* bytes )
+   {
+      std::vector<std::string> ids;
+      for( int i = 0; i < 50; ++i )
+         ids.push_back( "2.5." + std::to_string( i ) );
+
+      measure( "add", calls, [&](){ remote->add( 1, 2 ); }, bytes );
+      measure( "get_objects(50)", calls / 10, [&](){ remote->get_objects( ids ); }, bytes );
+   }
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      const size_t calls = argc > 1 ? std::stoull( argv[1] ) : 20000;
+      const bool use_websocket = argc > 2 && std::string( argv[2] ) == "ws";
+      const fc::api<bench_api> impl( std::make_shared<bench_api>() );
+
+      for( const std::string& subprotocol : { std::string(), std::string( fc::rpc::websocket_binary_subprotocol ) } )
+      {
+         std::cout << ( subprotocol.empty() ? "json" : "binary" ) << ( use_websocket ? " over websocket\n" : " in memory\n" );
+         if( use_websocket )
+         {
+            std::shared_ptr<fc::rpc::websocket_api_connection> server_api;
+            fc::http::websocket_server server;
+            server.add_subprotocol( fc::rpc::websocket_binary_subprotocol );
+            server.on_connection( [&]( const fc::http::websocket_connection_ptr& c ){
+               server_api = std::make_shared<fc::rpc::websocket_api_connection>( c, 20 );
+               server_api->register_api( impl );
+            });
+            server.listen( 0 );
+            server.start_accept();
+
+            fc::http::websocket_client client;
+            std::vector<std::string> offered;
+            if( !subprotocol.empty() )
+               offered.push_back( subprotocol );
+            auto con = client.connect( "ws://localhost:" + fc::to_string( server.get_listening_port() ), offered );
+            auto client_api = std::make_shared<fc::rpc::websocket_api_connection>( con, 20 );
+            run( client_api->get_remote_api<bench_api>(), calls, nullptr );
+         }
+         else
+         {
+            auto server_con = std::make_shared<memory_connection>( subprotocol );
+            auto client_con = std::make_shared<memory_connection>( subprotocol );
+            server_con->peer = client_con;
+            client_con->peer = server_con;
+            auto server_api = std::make_shared<fc::rpc::websocket_api_connection>( server_con, 20 );
+            auto client_api = std::make_shared<fc::rpc::websocket_api_connection>( client_con, 20 );
+            server_api->register_api( impl );
+
+            uint64_t bytes = 0;
+            server_con->bytes = client_con->bytes = &bytes;
+            run( client_api->get_remote_api<bench_api>(), calls, &bytes );
+         }
+      }
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+      return 1;
+   }
+   return 0;
+}
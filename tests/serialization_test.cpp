@@ -3,6 +3,7 @@
 
 #include <fc/container/flat.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/crypto/sha256.hpp>
 
 namespace fc { namespace test {
 
@@ -39,10 +40,56 @@ namespace fc { namespace test {
    inline bool operator < ( const item_wrapper& a, const item_wrapper& b )
    { return ( std::tie( a.v ) < std::tie( b.v ) ); }
 
+   struct message
+   {
+      std::string       memo;
+      std::vector<char> payload;
+      uint32_t          id;
+   };
+
+   struct message_view
+   {
+      fc::raw::string_view memo;
+      fc::raw::blob_view   payload;
+      uint32_t             id;
+   };
+
+   struct fixed_header
+   {
+      uint32_t            num;
+      fc::time_point_sec  time;
+      fc::sha256          digest;
+      uint8_t             flag;
+   };
+
+   struct extended_header : fixed_header
+   {
+      uint64_t            extra;
+   };
+
+   struct padded
+   {
+      uint8_t  a;
+      uint32_t b;
+   };
+
+   struct reordered
+   {
+      uint32_t a;
+      uint16_t b;
+      uint16_t c;
+   };
+
 } }
 
 FC_REFLECT( fc::test::item_wrapper, (v) );
 FC_REFLECT( fc::test::item, (level)(w) );
+FC_REFLECT( fc::test::message, (memo)(payload)(id) );
+FC_REFLECT( fc::test::message_view, (memo)(payload)(id) );
+FC_REFLECT( fc::test::fixed_header, (num)(time)(digest)(flag) );
+FC_REFLECT_DERIVED( fc::test::extended_header, (fc::test::fixed_header), (extra) );
+FC_REFLECT( fc::test::padded, (a)(b) );
+FC_REFLECT( fc::test::reordered, (c)(a)(b) );
 
 BOOST_AUTO_TEST_SUITE(fc_serialization)
 
@@ -105,4 +152,136 @@ BOOST_AUTO_TEST_CASE( nested_objects_test )
 
 } FC_CAPTURE_LOG_AND_RETHROW ( (0) ) }
 
+BOOST_AUTO_TEST_CASE( varint_test )
+{
+   const uint32_t values[] = { 0, 1, 0x7f, 0x80, 0x3fff, 0x4000, 0x1fffff, 0x200000,
+                               0xfffffff, 0x10000000, 0x7fffffff, 0xffffffff };
+   for( uint32_t v : values )
+   {
+      std::vector<char> packed = fc::raw::pack( fc::unsigned_int( v ) );
+      // decoded from a buffer with room to spare and from one that ends right after it
+      std::vector<char> padded( packed );
+      padded.resize( packed.size() + 8 );
+      BOOST_CHECK_EQUAL( v, fc::raw::unpack<fc::unsigned_int>( padded ).value );
+      BOOST_CHECK_EQUAL( v, fc::raw::unpack<fc::unsigned_int>( packed ).value );
+   }
+
+   const int32_t signed_values[] = { 0, 1, -1, 63, -64, 64, -65, 8191, -8192, 1 << 20, -(1 << 20),
+                                     1 << 27, -(1 << 27), 1 << 29, -(1 << 29) };
+   for( int32_t v : signed_values )
+   {
+      std::vector<char> packed = fc::raw::pack( fc::signed_int( v ) );
+      std::vector<char> padded( packed );
+      padded.resize( packed.size() + 8 );
+      BOOST_CHECK_EQUAL( v, fc::raw::unpack<fc::signed_int>( padded ).value );
+      BOOST_CHECK_EQUAL( v, fc::raw::unpack<fc::signed_int>( packed ).value );
+   }
+
+   // a varint spanning the fast path's 5 bytes still decodes like before
+   std::vector<char> in_a_row{ char(0x81), char(0x01), char(0x02), 0, 0, 0, 0 };
+   fc::datastream<const char*> ds( in_a_row.data(), in_a_row.size() );
+   fc::unsigned_int a, b;
+   fc::raw::unpack( ds, a );
+   fc::raw::unpack( ds, b );
+   BOOST_CHECK_EQUAL( 0x81u, a.value );
+   BOOST_CHECK_EQUAL( 2u, b.value );
+   BOOST_CHECK_EQUAL( 3u, ds.tellp() );
+}
+
+BOOST_AUTO_TEST_CASE( unpack_views_test )
+{ try {
+   fc::test::message msg;
+   msg.memo = "a memo that is not copied";
+   msg.payload = std::vector<char>( 1000, 'x' );
+   msg.id = 42;
+   const std::vector<char> packed = fc::raw::pack( msg );
+
+   // views point into the packed buffer
+   fc::test::message_view view;
+   fc::datastream<const char*> ds( packed.data(), packed.size() );
+   fc::raw::unpack( ds, view );
+   BOOST_CHECK_EQUAL( msg.memo, view.memo.to_string() );
+   BOOST_CHECK( fc::raw::blob_view( msg.payload ) == view.payload );
+   BOOST_CHECK_EQUAL( 42u, view.id );
+   BOOST_CHECK( view.memo.data() > packed.data() && view.memo.data() < packed.data() + packed.size() );
+   BOOST_CHECK( view.payload.data() > packed.data() && view.payload.end() <= packed.data() + packed.size() );
+
+   // and pack back into exactly the same bytes
+   BOOST_CHECK( packed == fc::raw::pack( view ) );
+   BOOST_CHECK( msg.payload == fc::raw::unpack<fc::test::message>( fc::raw::pack( view ) ).payload );
+
+   // a length prefix past the end of the buffer fails before allocating for it
+   std::vector<char> truncated( packed.begin(), packed.begin() + 10 );
+   BOOST_CHECK_THROW( fc::raw::unpack<fc::test::message>( truncated ), fc::exception );
+   fc::datastream<const char*> truncated_ds( truncated.data(), truncated.size() );
+   BOOST_CHECK_THROW( fc::raw::unpack( truncated_ds, view ), fc::exception );
+   std::vector<char> huge = fc::raw::pack( fc::unsigned_int( MAX_ARRAY_ALLOC_SIZE - 1 ) );
+   BOOST_CHECK_THROW( fc::raw::unpack<std::vector<char>>( huge ), fc::exception );
+} FC_CAPTURE_LOG_AND_RETHROW ( (0) ) }
+
+namespace {
+   /** packs each member on its own, the way packing visited them before */
+   template<typename... Members>
+   std::vector<char> pack_members( const Members&... members )
+   {
+      fc::datastream<std::vector<char>> ds;
+      int unused[] = { ( fc::raw::pack( ds, members ), 0 )... };
+      (void)unused;
+      return ds.release();
+   }
+}
+
+BOOST_AUTO_TEST_CASE( fixed_size_pack_test )
+{ try {
+   static_assert( fc::raw::fixed_pack_size<fc::test::fixed_header>::is_fixed, "all members have a fixed size" );
+   static_assert( fc::raw::fixed_pack_size<fc::test::fixed_header>::size == 4 + 4 + 32 + 1, "packed size of the members" );
+   static_assert( fc::raw::fixed_pack_size<fc::test::extended_header>::size == 41 + 8, "includes the base" );
+   static_assert( !fc::raw::fixed_pack_size<fc::test::message>::is_fixed, "strings vary in size" );
+
+   fc::test::fixed_header h;
+   h.num = 0x01020304;
+   h.time = fc::time_point_sec( 1500000000 );
+   h.digest = fc::sha256::hash( "fixed" );
+   h.flag = 7;
+   // packed with a single copy of the struct's bytes, still matching a member by member pack
+   BOOST_CHECK( fc::raw::detail::packs_as_copy( h ) );
+   const std::vector<char> packed = fc::raw::pack( h );
+   BOOST_CHECK( packed == pack_members( h.num, h.time, h.digest, h.flag ) );
+   BOOST_CHECK_EQUAL( packed.size(), fc::raw::pack_size( h ) );
+   fc::test::fixed_header back = fc::raw::unpack<fc::test::fixed_header>( packed );
+   BOOST_CHECK( back.digest == h.digest && back.time == h.time && back.num == h.num && back.flag == h.flag );
+
+   // layouts that differ from the packed form take the member by member path
+   fc::test::extended_header e;
+   static_cast<fc::test::fixed_header&>( e ) = h;
+   e.extra = 99;
+   BOOST_CHECK( !fc::raw::detail::packs_as_copy( e ) );
+   BOOST_CHECK( fc::raw::pack( e ) == pack_members( h.num, h.time, h.digest, h.flag, e.extra ) );
+
+   fc::test::padded p;
+   p.a = 1;
+   p.b = 2;
+   BOOST_CHECK( !fc::raw::detail::packs_as_copy( p ) );
+   BOOST_CHECK( fc::raw::pack( p ) == pack_members( p.a, p.b ) );
+   BOOST_CHECK_EQUAL( 5u, fc::raw::pack_size( p ) );
+
+   fc::test::reordered r;
+   r.a = 1;
+   r.b = 2;
+   r.c = 3;
+   BOOST_CHECK( !fc::raw::detail::packs_as_copy( r ) );
+   BOOST_CHECK( fc::raw::pack( r ) == pack_members( r.c, r.a, r.b ) );
+
+   // variable size values are packed in one pass into a growing buffer
+   fc::test::message msg;
+   msg.memo = std::string( 1000, 'm' );
+   msg.payload = std::vector<char>( 5000, 'p' );
+   msg.id = 1;
+   const std::vector<char> grown = fc::raw::pack( msg );
+   std::vector<char> sized( fc::raw::pack_size( msg ) );
+   fc::datastream<char*> ds( sized.data(), sized.size() );
+   fc::raw::pack( ds, msg );
+   BOOST_CHECK( grown == sized );
+} FC_CAPTURE_LOG_AND_RETHROW ( (0) ) }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,56 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/thread/coroutine.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <vector>
+
+// built on its own with -std=c++20, see tests/CMakeLists.txt
+#ifndef FC_HAS_COROUTINES
+#error coroutine_tests.cpp needs a compiler with C++20 coroutines
+#endif
+
+BOOST_AUTO_TEST_SUITE(coroutine_tests)
+
+namespace {
+    fc::task_co<int> add_remote(fc::thread& worker, int a)
+    {
+        int b = co_await worker.async([]{ return 2; });
+        co_return a + b;
+    }
+
+    fc::task_co<void> fail_after(fc::thread& worker)
+    {
+        co_await worker.async([]{});
+        FC_THROW("boom");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(awaits_futures_from_coroutines)
+{
+    fc::thread worker("worker");
+    BOOST_CHECK_EQUAL(42, add_remote(worker, 40).wait());
+    BOOST_CHECK_THROW(fail_after(worker).wait(), fc::exception);
+
+    // many suspended coroutines only hold their frames
+    fc::promise<int>::ptr go(new fc::promise<int>("go"));
+    std::vector<fc::future<int>> waiting;
+    for (int i = 0; i < 1000; ++i)
+        waiting.push_back([](fc::future<int> f, int i) -> fc::task_co<int> { co_return co_await f + i; }
+                          (fc::future<int>(go), i));
+    go->set_value(1);
+    std::vector<int> all = fc::when_all(waiting).wait();
+    int sum = 0;
+    for (int v : all)
+        sum += v;
+    BOOST_CHECK_EQUAL(1000 + 999 * 1000 / 2, sum);
+
+    fc::thread* ran_on = nullptr;
+    fc::co_async(worker, [&ran_on]() -> fc::task_co<void> {
+        ran_on = &fc::thread::current();
+        co_await fc::resume_on(fc::thread::current());
+    }).wait();
+    BOOST_CHECK(ran_on == &worker);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+#include <fc/thread/thread.hpp>
+#include <fc/thread/task_allocator.hpp>
+
+#include <boost/atomic.hpp>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+/**
+ *  Compares fc::detail::task_allocator with the global heap it replaced for promise and
+ *  task objects, and measures the end to end cost of posting small tasks.
+ *
+ *  usage: task_alloc_bench [iterations]
+ */
+
+namespace {
+   typedef std::chrono::steady_clock clock_type;
+
+   double ns_per_op( clock_type::time_point start, uint64_t ops )
+   {
+      return std::chrono::duration<double, std::nano>( clock_type::now() - start ).count() / ops;
+   }
+
+   template<typename Alloc, typename Free>
+   double same_thread( uint64_t iterations, size_t size, Alloc&& alloc, Free&& release )
+   {
+      std::vector<void*> live( 64 );
+      auto start = clock_type::now();
+      for( uint64_t i = 0; i < iterations; i += live.size() )
+      {
+         for( void*& p : live )
+            p = alloc( size );
+         for( void* p : live )
+            release( p );
+      }
+      return ns_per_op( start, iterations );
+   }
+
+   /** allocates on this thread and frees on another one, like a task completed by its target */
+   template<typename Alloc, typename Free>
+   double cross_thread( fc::thread& other, uint64_t iterations, size_t size, Alloc&& alloc, Free&& release )
+   {
+      const size_t batch = 256;
+      std::vector<void*> live( batch );
+      auto start = clock_type::now();
+      for( uint64_t i = 0; i < iterations; i += batch )
+      {
+         for( void*& p : live )
+            p = alloc( size );
+         other.async( [&live,&release]{ for( void* p : live ) release( p ); } ).wait();
+      }
+      return ns_per_op( start, iterations );
+   }
+}
+
+int main( int argc, char** argv )
+{
+   const uint64_t iterations = argc > 1 ? std::stoull( argv[1] ) : 2000000;
+   fc::thread other( "bench" );
+
+   auto heap_alloc = []( size_t size ) { return ::operator new( size ); };
+   auto heap_free  = []( void* p ) { ::operator delete( p ); };
+   auto slab_alloc = []( size_t size ) { return fc::detail::task_allocator::allocate( size ); };
+   auto slab_free  = []( void* p ) { fc::detail::task_allocator::deallocate( p ); };
+
+   std::cout << "allocate + free, ns per block\n";
+   for( size_t size : { 128, 256, 512 } )
+   {
+      std::cout << "  " << size << " bytes, same thread:  heap " << same_thread( iterations, size, heap_alloc, heap_free )
+                << "  slab " << same_thread( iterations, size, slab_alloc, slab_free ) << "\n";
+      std::cout << "  " << size << " bytes, cross thread: heap " << cross_thread( other, iterations, size, heap_alloc, heap_free )
+                << "  slab " << cross_thread( other, iterations, size, slab_alloc, slab_free ) << "\n";
+   }
+
+   // end to end: post a tiny continuation and wait for it
+   const uint64_t posts = iterations / 20;
+   const fc::detail::task_allocator::stats before = fc::detail::task_allocator::get_thread_stats();
+   boost::atomic<uint64_t> sum( 0 );
+   auto start = clock_type::now();
+   for( uint64_t i = 0; i < posts; ++i )
+      other.async( [&sum,i]{ sum += i; }, "bench" ).wait();
+   const double post_ns = ns_per_op( start, posts );
+   const fc::detail::task_allocator::stats after = fc::detail::task_allocator::get_thread_stats();
+
+   std::cout << "async + wait: " << post_ns << " ns per task, "
+             << (after.heap_allocations - before.heap_allocations) << " heap allocations for "
+             << (after.slab_allocations - before.slab_allocations) << " objects\n";
+   return 0;
+}
@@ -1,6 +1,11 @@
 #include <boost/test/unit_test.hpp>
 
 #include <fc/thread/thread.hpp>
+#include <fc/thread/thread_pool.hpp>
+#include <fc/thread/stack_pool.hpp>
+#include <fc/thread/task_allocator.hpp>
+
+#include <boost/atomic.hpp>
 
 using namespace fc;
 
@@ -91,5 +96,332 @@ BOOST_AUTO_TEST_CASE(reschedules_yielded_task)
     BOOST_CHECK_EQUAL(10, reschedule_count);
 }
 
+BOOST_AUTO_TEST_CASE(wakes_only_parked_thread)
+{
+    fc::thread thread("my");
+    thread.async([]{}).wait();
+
+    // give the thread time to park, posting to it now requires a wakeup
+    fc::usleep(fc::milliseconds(50));
+    fc::thread::wakeup_stats before = thread.get_wakeup_stats();
+    thread.async([]{}).wait();
+    fc::thread::wakeup_stats after_parked = thread.get_wakeup_stats();
+    BOOST_CHECK_EQUAL(before.wakeups_sent + 1, after_parked.wakeups_sent);
+
+    // while the thread is busy, posting to it must not touch its mutex
+    boost::atomic<bool> release(false);
+    boost::atomic<bool> busy(false);
+    auto hog = thread.async([&release,&busy]{
+        busy = true;
+        while (!release.load())
+            ;
+    });
+    while (!busy.load())
+        fc::usleep(fc::milliseconds(1));
+    fc::thread::wakeup_stats while_busy = thread.get_wakeup_stats();
+    auto queued = thread.async([]{});
+    fc::thread::wakeup_stats after_busy = thread.get_wakeup_stats();
+    BOOST_CHECK_EQUAL(while_busy.wakeups_sent, after_busy.wakeups_sent);
+    BOOST_CHECK_EQUAL(while_busy.wakeups_avoided + 1, after_busy.wakeups_avoided);
+
+    release = true;
+    hog.wait();
+    queued.wait();
+}
+
+BOOST_AUTO_TEST_CASE(runs_scheduled_tasks_in_time_order)
+{
+    fc::thread thread("my");
+    std::vector<int> order;
+    std::vector<fc::future<void>> scheduled;
+    const fc::time_point start = fc::time_point::now();
+
+    // post in reverse so the order they run in can only come from their scheduled times
+    for (int i = 19; i >= 0; --i)
+        scheduled.push_back(thread.schedule([&order,i]{ order.push_back(i); },
+                                            start + fc::milliseconds(20 + 5 * i)));
+    // and some far in the future that get canceled before they are due
+    std::vector<fc::future<void>> canceled;
+    for (int i = 0; i < 100; ++i)
+        canceled.push_back(thread.schedule([&order]{ order.push_back(-1); },
+                                           start + fc::seconds(60 + i)));
+    for (auto& f : canceled)
+        f.cancel();
+
+    for (auto& f : scheduled)
+        f.wait();
+    BOOST_CHECK(fc::time_point::now() >= start + fc::milliseconds(115));
+    BOOST_REQUIRE_EQUAL(20u, order.size());
+    for (int i = 0; i < 20; ++i)
+        BOOST_CHECK_EQUAL(i, order[i]);
+
+    // canceling resolves the futures right away instead of when their time comes
+    for (auto& f : canceled)
+        BOOST_CHECK_THROW(f.wait(fc::seconds(5)), fc::canceled_exception);
+}
+
+BOOST_AUTO_TEST_CASE(runs_tasks_on_requested_stack_size)
+{
+    fc::thread thread("my");
+    fc::stack_pool& pool = fc::stack_pool::instance();
+
+    auto stack_depth_available = []() -> size_t {
+        // the guard page below the stack means writing this deep must not crash
+        volatile char buffer[32 * 1024];
+        buffer[0] = 1;
+        return sizeof(buffer);
+    };
+    BOOST_CHECK_EQUAL(32u * 1024, thread.async(stack_depth_available, "small task", fc::priority(),
+                                               fc::stack_class::compact).wait());
+    BOOST_CHECK_EQUAL(32u * 1024, thread.async(stack_depth_available, "large task", fc::priority(),
+                                               fc::stack_class::large).wait());
+    BOOST_CHECK(pool.get_stats(fc::stack_class::compact).in_use >= 1);
+    BOOST_CHECK(pool.get_stats(fc::stack_class::large).in_use >= 1);
+
+    // many blocked small tasks only take small stacks
+    fc::promise<void>::ptr go(new fc::promise<void>("go"));
+    std::vector<fc::future<void>> waiting;
+    const uint32_t small_in_use = pool.get_stats(fc::stack_class::compact).in_use;
+    for (int i = 0; i < 50; ++i)
+        waiting.push_back(thread.async([go]{ fc::future<void>(go).wait(); }, "waiter", fc::priority(),
+                                       fc::stack_class::compact));
+    thread.async([]{}).wait();
+    BOOST_CHECK(pool.get_stats(fc::stack_class::compact).in_use >= small_in_use + 49);
+    go->set_value();
+    for (auto& f : waiting)
+        f.wait();
+
+    // only pooled stacks are measured, a thread's own stack is not
+    pool.set_usage_tracking(true);
+    thread.async([]{
+        volatile char buffer[100 * 1024];
+        for (size_t i = 0; i < sizeof(buffer); i += 512)
+            buffer[i] = 1;
+    }, "deep task", fc::priority(), fc::stack_class::large).wait();
+    thread.async([]{}, "shallow task", fc::priority(), fc::stack_class::large).wait();
+    // usage is recorded after a task's future is set, let the thread get past that
+    thread.async([]{}).wait();
+    pool.set_usage_tracking(false);
+
+    size_t deep = 0, shallow = 0;
+    for (const fc::stack_pool::task_usage& u : pool.get_usage())
+    {
+        if (u.desc == "deep task")
+            deep = u.high_water;
+        else if (u.desc == "shallow task")
+            shallow = u.high_water;
+    }
+    BOOST_CHECK(deep >= 100 * 1024);
+    BOOST_CHECK(shallow > 0);
+    BOOST_CHECK(shallow < 100 * 1024);
+    pool.reset_usage();
+}
+
+BOOST_AUTO_TEST_CASE(posts_tasks_without_heap_allocations)
+{
+    fc::thread thread("my");
+    for (int i = 0; i < 100; ++i)
+        thread.async([i]{ return i; }).wait();
+
+    // once the caches are warm, posting a small task never reaches the global heap
+    const fc::detail::task_allocator::stats before = fc::detail::task_allocator::get_thread_stats();
+    int sum = 0;
+    for (int i = 0; i < 1000; ++i)
+        sum += thread.async([i]{ return i; }).wait();
+    const fc::detail::task_allocator::stats after = fc::detail::task_allocator::get_thread_stats();
+    BOOST_CHECK_EQUAL(999 * 1000 / 2, sum);
+    BOOST_CHECK_EQUAL(before.heap_allocations, after.heap_allocations);
+    BOOST_CHECK(after.slab_allocations >= before.slab_allocations + 1000);
+
+    // blocks freed by another thread find their way back to the thread that allocated them
+    std::vector<void*> blocks;
+    for (int i = 0; i < 200; ++i)
+        blocks.push_back(fc::detail::task_allocator::allocate(100));
+    thread.async([&blocks]{
+        for (void* b : blocks)
+            fc::detail::task_allocator::deallocate(b);
+    }).wait();
+    const fc::detail::task_allocator::stats before_reuse = fc::detail::task_allocator::get_thread_stats();
+    for (int i = 0; i < 200; ++i)
+        blocks[i] = fc::detail::task_allocator::allocate(100);
+    BOOST_CHECK_EQUAL(before_reuse.heap_allocations, fc::detail::task_allocator::get_thread_stats().heap_allocations);
+    for (void* b : blocks)
+        fc::detail::task_allocator::deallocate(b);
+}
+
+BOOST_AUTO_TEST_CASE(calls_completion_handler_of_ready_future)
+{
+    fc::thread thread("my");
+    fc::future<int> f = thread.async([]{ return 7; });
+    f.wait();
+
+    int first = 0, second = 0;
+    f.on_complete([&first](const int& v, const fc::exception_ptr&){ first = v; });
+    f.on_complete([&second](const int& v, const fc::exception_ptr&){ second = v; });
+    BOOST_CHECK_EQUAL(7, first);
+    BOOST_CHECK_EQUAL(7, second);
+}
+
+BOOST_AUTO_TEST_CASE(chains_continuations_across_threads)
+{
+    fc::thread worker("worker");
+    fc::thread::current(); // continuations are posted back here
+
+    fc::future<std::string> f = worker.async([]{ return 20; })
+        .then([](const int& v){ return v + 1; })
+        .then([&worker](const int& v){
+            BOOST_CHECK(&fc::thread::current() != &worker);
+            return std::to_string(v * 2);
+        });
+    BOOST_CHECK_EQUAL("42", f.wait());
+
+    bool ran = false;
+    worker.async([]{}).then([&ran]{ ran = true; }).wait();
+    BOOST_CHECK(ran);
+
+    // an exception skips the rest of the chain
+    bool skipped = true;
+    fc::future<int> failed = worker.async([]() -> int { FC_THROW("boom"); })
+        .then([&skipped](const int& v){ skipped = false; return v; });
+    BOOST_CHECK_THROW(failed.wait(), fc::exception);
+    BOOST_CHECK(skipped);
+
+    fc::future<void> thrown = worker.async([]{}).then([]{ FC_THROW("from continuation"); });
+    BOOST_CHECK_THROW(thrown.wait(), fc::exception);
+}
+
+BOOST_AUTO_TEST_CASE(combines_futures)
+{
+    fc::thread_pool pool(4, "test");
+    std::vector<fc::future<int>> results;
+    for (int i = 0; i < 100; ++i)
+        results.push_back(pool.async([i]{ fc::usleep(fc::microseconds((i % 7) * 100)); return i; }));
+    std::vector<int> all = fc::when_all(results).wait();
+    BOOST_REQUIRE_EQUAL(100u, all.size());
+    for (int i = 0; i < 100; ++i)
+        BOOST_CHECK_EQUAL(i, all[i]);
+
+    BOOST_CHECK(fc::when_all(std::vector<fc::future<int>>()).wait().empty());
+
+    std::vector<fc::future<void>> steps;
+    boost::atomic<int> done(0);
+    for (int i = 0; i < 10; ++i)
+        steps.push_back(pool.async([&done]{ ++done; }));
+    fc::when_all(steps).wait();
+    BOOST_CHECK_EQUAL(10, done.load());
+
+    fc::promise<int>::ptr never(new fc::promise<int>("never"));
+    fc::promise<int>::ptr fails(new fc::promise<int>("fails"));
+    std::vector<fc::future<int>> mixed{ fc::future<int>(never), fc::future<int>(fails) };
+    fc::future<std::vector<int>> all_mixed = fc::when_all(mixed);
+    fc::future<size_t> first = fc::when_any(mixed);
+    BOOST_CHECK(!first.ready());
+    fails->set_exception(std::make_shared<fc::exception>());
+    BOOST_CHECK_THROW(all_mixed.wait(), fc::exception);
+    BOOST_CHECK_EQUAL(1u, first.wait());
+    never->set_value(0);
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_returns_values)
+{
+    fc::thread_pool pool(4, "test");
+    std::vector<fc::future<int>> results;
+    for (int i = 0; i < 100; ++i)
+        results.push_back(pool.async([i]{ return i * 2; }));
+    for (int i = 0; i < 100; ++i)
+        BOOST_CHECK_EQUAL(i * 2, results[i].wait());
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_runs_tasks_in_parallel)
+{
+    fc::thread_pool pool(2, "test");
+    boost::atomic<int> started(0);
+
+    // each task spins without yielding until both have started, which only
+    // happens if they run on different OS threads
+    auto rendezvous = [&started]{
+        ++started;
+        fc::time_point give_up = fc::time_point::now() + fc::seconds(5);
+        while (started.load() < 2 && fc::time_point::now() < give_up)
+            ;
+        return started.load() == 2;
+    };
+    auto f1 = pool.async(rendezvous);
+    auto f2 = pool.async(rendezvous);
+    BOOST_CHECK(f1.wait());
+    BOOST_CHECK(f2.wait());
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_runs_around_hogged_worker)
+{
+    fc::thread_pool pool(2, "test");
+    boost::atomic<bool> release(false);
+
+    // hog one worker without yielding, everything else has to run on the other one
+    boost::atomic<fc::thread*> busy_thread(nullptr);
+    auto hog = pool.async([&release,&busy_thread]{
+        busy_thread = &fc::thread::current();
+        while (!release.load())
+            ;
+    });
+    while (!busy_thread.load())
+        fc::usleep(fc::milliseconds(1));
+
+    std::vector<fc::future<fc::thread*>> results;
+    for (int i = 0; i < 20; ++i)
+        results.push_back(pool.async([]{ return &fc::thread::current(); }));
+    for (auto& f : results)
+        BOOST_CHECK(f.wait() != busy_thread.load());
+
+    release = true;
+    hog.wait();
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_cancels_queued_tasks_on_quit)
+{
+    fc::future<void> never_started;
+    {
+        fc::thread_pool pool(1, "test");
+        fc::promise<void>::ptr gate(new fc::promise<void>("gate"));
+        auto blocker = pool.async([gate]{ gate->wait(); });
+        fc::usleep(fc::milliseconds(10));
+        never_started = pool.async([]{});
+        pool.quit();
+        BOOST_CHECK_THROW(blocker.wait(), fc::canceled_exception);
+    }
+    BOOST_CHECK_THROW(never_started.wait(), fc::canceled_exception);
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_quits_while_others_post)
+{
+    for (int round = 0; round < 20; ++round)
+    {
+        fc::thread_pool pool(2, "test");
+        std::vector<std::unique_ptr<fc::thread>> posters;
+        std::vector<fc::future<std::vector<fc::future<void>>>> posted;
+        for (int i = 0; i < 3; ++i)
+        {
+            posters.emplace_back(new fc::thread("poster"));
+            posted.push_back(posters.back()->async([&pool]{
+                std::vector<fc::future<void>> tasks;
+                for (int j = 0; j < 200; ++j)
+                    tasks.push_back(pool.async([]{}));
+                return tasks;
+            }));
+        }
+        pool.quit();
+        // every task posted runs or is canceled, none is lost in a quit pool
+        for (auto& p : posted)
+        {
+            std::vector<fc::future<void>> tasks = p.wait();
+            for (auto& t : tasks)
+            {
+                try { t.wait(fc::seconds(5)); }
+                catch (const fc::canceled_exception&) {}
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,108 @@
+#include <fc/variant.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/io/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+/**
+ *  Builds, copies and serializes variant trees shaped like API responses (arrays of
+ *  objects with short keys, symbols, names and hex ids) and reports time, heap
+ *  allocations and heap bytes for each step.
+ *
+ *  usage: variant_bench [objects]
+ */
+
+namespace {
+   std::atomic<uint64_t> allocations( 0 );
+   std::atomic<uint64_t> allocated_bytes( 0 );
+}
+
+void* operator new( size_t size )
+{
+   allocations.fetch_add( 1, std::memory_order_relaxed );
+   allocated_bytes.fetch_add( size, std::memory_order_relaxed );
+   if( void* p = std::malloc( size ) )
+      return p;
+   throw std::bad_alloc();
+}
+
+void operator delete( void* p )noexcept { std::free( p ); }
+void operator delete( void* p, size_t )noexcept { std::free( p ); }
+
+namespace {
+   typedef std::chrono::steady_clock clock_type;
+
+   struct measurement
+   {
+      measurement() : start( clock_type::now() ), allocs( allocations ), bytes( allocated_bytes ) {}
+
+      void report( const char* what )const
+      {
+         std::cout << "  " << what << ": "
+                   << std::chrono::duration<double, std::milli>( clock_type::now() - start ).count() << " ms, "
+                   << ( allocations - allocs ) << " allocations, "
+                   << ( allocated_bytes - bytes ) / 1024 << " KiB\n";
+      }
+
+      clock_type::time_point start;
+      uint64_t               allocs;
+      uint64_t               bytes;
+   };
+
+   fc::variant make_response( size_t objects )
+   {
+      static const char* const symbols[] = { "BTC", "PPY", "USD", "BTF" };
+      fc::variants result;
+      result.reserve( objects );
+      for( size_t i = 0; i < objects; ++i )
+      {
+         fc::mutable_variant_object balance;
+         balance( "id", "2.5." + std::to_string( i ) )
+                ( "owner", "1.2." + std::to_string( i % 1000 ) )
+                ( "asset_type", symbols[i % 4] )
+                ( "balance", uint64_t( i * 1000 ) )
+                ( "name", "account-" + std::to_string( i % 1000 ) )
+                ( "memo", "a memo text which is long enough not to fit" );
+         result.emplace_back( fc::move( balance ) );
+      }
+      return fc::variant( fc::move( result ) );
+   }
+}
+
+int main( int argc, char** argv )
+{
+   const size_t objects = argc > 1 ? std::stoull( argv[1] ) : 200000;
+   std::cout << objects << " objects, sizeof(variant) " << sizeof(fc::variant) << "\n";
+
+   measurement m;
+   fc::variant response = make_response( objects );
+   m.report( "build" );
+
+   m = measurement();
+   fc::variant copy = response;
+   m.report( "copy" );
+
+   m = measurement();
+   fc::variants copies( 16, response );
+   m.report( "16 more copies" );
+
+   m = measurement();
+   const std::string json = fc::json::to_string( copy );
+   m.report( "to_string" );
+
+   m = measurement();
+   fc::variant parsed = fc::json::from_string( json, fc::json::simd_parser );
+   m.report( "from_string" );
+
+   m = measurement();
+   fc::variant modified = parsed;
+   modified.get_array()[0] = fc::variant( "changed" );
+   m.report( "copy and modify one element" );
+
+   return parsed.size() == objects ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/variant.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <type_traits>
+
+BOOST_AUTO_TEST_SUITE(variant_tests)
+
+BOOST_AUTO_TEST_CASE(string_storage_test)
+{
+   BOOST_CHECK( std::is_nothrow_move_constructible<fc::variant>::value );
+   BOOST_CHECK( std::is_nothrow_move_assignable<fc::variant>::value );
+
+   // around the inline capacity, with embedded zeros
+   for( size_t len = 0; len < 40; ++len )
+   {
+      std::string str;
+      for( size_t i = 0; i < len; ++i )
+         str += char( i % 3 == 1 ? 0 : 'a' + i );
+      fc::variant v( str );
+      BOOST_CHECK( v.is_string() );
+      BOOST_CHECK_EQUAL( str, v.get_string() );
+      BOOST_CHECK_EQUAL( len, v.get_string_view().size() );
+
+      fc::variant copy( v );
+      fc::variant assigned;
+      assigned = copy;
+      fc::variant moved( std::move( v ) );
+      BOOST_CHECK( v.is_null() );
+      BOOST_CHECK_EQUAL( str, copy.as_string() );
+      BOOST_CHECK_EQUAL( str, assigned.get_string() );
+      BOOST_CHECK_EQUAL( str, moved.get_string() );
+      copy.clear();
+      BOOST_CHECK_EQUAL( str, assigned.get_string() );
+   }
+
+   BOOST_CHECK_EQUAL( 12345, fc::variant( "12345" ).as_int64() );
+   BOOST_CHECK( fc::variant( "true" ).as_bool() );
+   BOOST_CHECK_EQUAL( "abc", fc::variant( L"abc" ).get_string() );
+   BOOST_CHECK_THROW( fc::variant( 1 ).get_string_view(), fc::bad_cast_exception );
+}
+
+BOOST_AUTO_TEST_CASE(copy_on_write_test)
+{
+   fc::variant original( fc::variants{ fc::variant( 1 ), fc::variant( "a string too long to be stored inline" ) } );
+   fc::variant copy( original );
+
+   // copies share the array until one of them is modified
+   const fc::variant& shared = copy;
+   BOOST_CHECK_EQUAL( 2u, shared.size() );
+   copy.get_array().push_back( fc::variant( 3 ) );
+   BOOST_CHECK_EQUAL( 2u, original.size() );
+   BOOST_CHECK_EQUAL( 3u, copy.size() );
+
+   // a mutable reference handed out before copying must not affect the copy
+   fc::variants& arr = original.get_array();
+   fc::variant later( original );
+   arr.push_back( fc::variant( 4 ) );
+   BOOST_CHECK_EQUAL( 3u, original.size() );
+   BOOST_CHECK_EQUAL( 2u, later.size() );
+
+   fc::mutable_variant_object mvo;
+   mvo( "a", 1 );
+   fc::variant obj( mvo );
+   fc::variant obj_copy( obj );
+   obj.get_object() = fc::variant_object( "b", 2 );
+   BOOST_CHECK( obj_copy.get_object().contains( "a" ) );
+   BOOST_CHECK( obj.get_object().contains( "b" ) );
+
+   fc::variant blob( fc::blob{ { 'x', 'y' } } );
+   fc::variant blob_copy = blob;
+   blob.get_blob().data.push_back( 'z' );
+   BOOST_CHECK_EQUAL( 2u, blob_copy.get_blob().data.size() );
+   BOOST_CHECK_EQUAL( 3u, blob.get_blob().data.size() );
+}
+
+BOOST_AUTO_TEST_CASE(key_index_test)
+{
+   // small and large objects, both searched linearly and through the index
+   for( size_t count : { 3, 7, 8, 9, 100, 1000 } )
+   {
+      fc::mutable_variant_object mvo;
+      for( size_t i = 0; i < count; ++i )
+         mvo( "key" + std::to_string( i ), int64_t( i ) );
+      mvo( "key0", "duplicate" );
+      BOOST_CHECK_EQUAL( 0, mvo["key0"].as_int64() );
+      BOOST_CHECK( mvo.find( "key" ) == mvo.end() );
+
+      mvo["added"] = 7;
+      mvo.set( "key1", "replaced" );
+      BOOST_CHECK_EQUAL( count + 2, mvo.size() );
+      BOOST_CHECK_EQUAL( 7, mvo["added"].as_int64() );
+      BOOST_CHECK_EQUAL( "replaced", mvo["key1"].as_string() );
+
+      // erasing the first key0 makes the duplicate the first one
+      mvo.erase( "key0" );
+      BOOST_CHECK_EQUAL( "duplicate", mvo["key0"].as_string() );
+
+      const fc::variant_object obj( mvo );
+      for( size_t i = 2; i < count; ++i )
+      {
+         auto itr = obj.find( "key" + std::to_string( i ) );
+         BOOST_REQUIRE( itr != obj.end() );
+         BOOST_CHECK_EQUAL( int64_t( i ), itr->value().as_int64() );
+         BOOST_CHECK_EQUAL( i - 1, size_t( itr - obj.begin() ) );
+      }
+      BOOST_CHECK( !obj.contains( "missing" ) );
+      BOOST_CHECK_THROW( obj["missing"], fc::key_not_found_exception );
+
+      fc::mutable_variant_object copy( obj );
+      copy = fc::variant_object( "only", 1 );
+      BOOST_CHECK_EQUAL( 1u, copy.size() );
+      BOOST_CHECK( copy.find( "key2" ) == copy.end() );
+      BOOST_CHECK( obj.contains( "key2" ) );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()